@@ -36,6 +36,15 @@ cdef extern from "cynestkernel.h":
         Datum* PyObject_as_Datum(object)
         bint check_engine()
         void register_cython_model(string)
+        void set_copy_vectors(bint)
+        bint get_copy_vectors()
+        bint connect_arrays(object, object, object, object, string, bint) except *
+        bint simulate(double) except *
+        object create(string, long)
+        bint set_status(object, object) except *
+        object get_status(object, string)
+        bint connect(object, object, object, object, string) except *
+        bint data_connect(object, string) except *
 
 
 cdef extern from "object_manager.h":
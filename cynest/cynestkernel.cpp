@@ -74,6 +74,7 @@ extern "C"
 #include "psignal.h"
 
 #include <algorithm>
+#include <cstring>
 
 #include "spikecounter.h"
 
@@ -115,6 +116,131 @@ void init_numpy_()
 #endif
 }
 
+/**
+ * Copy a one-dimensional numeric buffer, e.g. a numpy array or an
+ * array.array, into v, converting the element type on the way.
+ * Returns false, without setting a Python error, if pObj does not
+ * export such a buffer.
+ */
+template <typename T>
+static bool buffer_to_vector(PyObject *pObj, std::vector<T> &v)
+{
+  if (not PyObject_CheckBuffer(pObj) or PyByteArray_Check(pObj))
+    return false;
+
+  Py_buffer view;
+  if (PyObject_GetBuffer(pObj, &view, PyBUF_FORMAT | PyBUF_STRIDES) != 0)
+  {
+    PyErr_Clear();
+    return false;
+  }
+
+  // only native byte order is handled here
+  const char *fmt = view.format != NULL ? view.format : "B";
+  if (*fmt == '@' or *fmt == '=')
+    ++fmt;
+
+  bool ok = view.ndim == 1 and fmt[0] != '\0' and fmt[1] == '\0';
+  const Py_ssize_t n = ok ? view.shape[0] : 0;
+  const Py_ssize_t stride = ok ? view.strides[0] : 0;
+  const char *data = static_cast<const char*>(view.buf);
+
+  if (ok)
+  {
+    v.resize(n);
+    switch (*fmt)
+    {
+#define COPY_BUFFER_(code, ctype)                                        \
+      case code:                                                         \
+        for (Py_ssize_t i = 0; i < n; ++i)                               \
+          v[i] = static_cast<T>(*reinterpret_cast<const ctype*>(data + i*stride)); \
+        break;
+      COPY_BUFFER_('b', signed char)
+      COPY_BUFFER_('B', unsigned char)
+      COPY_BUFFER_('h', short)
+      COPY_BUFFER_('H', unsigned short)
+      COPY_BUFFER_('i', int)
+      COPY_BUFFER_('I', unsigned int)
+      COPY_BUFFER_('l', long)
+      COPY_BUFFER_('L', unsigned long)
+      COPY_BUFFER_('q', long long)
+      COPY_BUFFER_('Q', unsigned long long)
+      COPY_BUFFER_('f', float)
+      COPY_BUFFER_('d', double)
+#undef COPY_BUFFER_
+      default:
+        ok = false;
+    }
+  }
+
+  PyBuffer_Release(&view);
+  return ok;
+}
+
+/**
+ * Return true if the buffer exported by pObj holds floating point numbers.
+ */
+static bool buffer_is_float(PyObject *pObj)
+{
+  Py_buffer view;
+  if (PyObject_GetBuffer(pObj, &view, PyBUF_FORMAT | PyBUF_STRIDES) != 0)
+  {
+    PyErr_Clear();
+    return false;
+  }
+
+  const char *fmt = view.format != NULL ? view.format : "B";
+  const bool result = std::strpbrk(fmt, "fd") != NULL;
+  PyBuffer_Release(&view);
+  return result;
+}
+
+/**
+ * Fill v from a buffer, a sequence of numbers, or a single number.
+ * None gives an empty vector. Sets a Python error and returns false
+ * if pObj cannot be converted.
+ */
+template <typename T>
+static bool as_vector(PyObject *pObj, std::vector<T> &v)
+{
+  v.clear();
+  if (pObj == Py_None or buffer_to_vector(pObj, v))
+    return true;
+
+  if (PyNumber_Check(pObj) and not PySequence_Check(pObj))
+  {
+    PyObject *f = PyNumber_Float(pObj);
+    if (f == NULL)
+      return false;
+    v.push_back(static_cast<T>(PyFloat_AsDouble(f)));
+    Py_DECREF(f);
+    return true;
+  }
+
+  PyObject *seq = PySequence_Fast(pObj, "expected a number, a sequence of numbers, or an array");
+  if (seq == NULL)
+    return false;
+
+  const Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+  v.resize(n);
+  for (Py_ssize_t i = 0; i < n; ++i)
+  {
+    PyObject *item = PySequence_Fast_GET_ITEM(seq, i);
+    v[i] = static_cast<T>(PyFloat_Check(item) ? PyFloat_AsDouble(item) : PyInt_AsLong(item));
+  }
+  Py_DECREF(seq);
+
+  return not PyErr_Occurred();
+}
+
+/**
+ * Format a NEST error the way the interpreter reports it to Python.
+ */
+static std::string error_message(SLIException &e, const char *cmd)
+{
+  return String::compose("%1 in %2: %3", e.what(), cmd, e.message());
+}
+
 NESTEngine::NESTEngine()
     : initialized_(false),
       NESTError_(0), //!< Python error object. We are responsible.
@@ -518,11 +644,367 @@ Token* NESTEngine::pop_token()
     return t;
 }
 
+void NESTEngine::set_copy_vectors(bool copy)
+{
+    DatumToPythonConverter::set_copy_vectors(copy);
+}
+
+bool NESTEngine::get_copy_vectors()
+{
+    return DatumToPythonConverter::get_copy_vectors();
+}
+
 void NESTEngine::register_cython_model(std::string model)
 {
 	nest::register_cython_model(pNet_, model);
 }
 
+bool NESTEngine::connect_arrays(PyObject *pre, PyObject *post, PyObject *weight, PyObject *delay,
+                                std::string model, bool convergent)
+{
+    if(not check_engine())
+	return false;
+
+    std::vector<long> sources, targets;
+    std::vector<double> weights, delays;
+
+    if (not as_vector(pre, sources) or not as_vector(post, targets)
+        or not as_vector(weight, weights) or not as_vector(delay, delays))
+	return false;
+
+    const Token synmodel = pNet_->get_synapsedict().lookup(Name(model));
+    if (synmodel.empty())
+    {
+	std::string error = String::compose("Unknown synapse type '%1'.", model);
+	PyErr_SetString(NESTError_, error.c_str());
+	return false;
+    }
+    const nest::index syn = static_cast<nest::index>(synmodel);
+
+    // a single weight or delay applies to all connections of a node
+    const size_t n = convergent ? sources.size() : targets.size();
+    if (weights.size() == 1)
+	weights.assign(n, weights[0]);
+    if (delays.size() == 1)
+	delays.assign(n, delays[0]);
+
+    const TokenArray w(weights);
+    const TokenArray d(delays);
+    std::string error;
+
+    Py_BEGIN_ALLOW_THREADS
+    try
+    {
+	if (convergent)
+	{
+	    const TokenArray s(sources);
+	    for (size_t i = 0; i < targets.size(); ++i)
+		pNet_->convergent_connect(s, targets[i], w, d, syn);
+	}
+	else
+	{
+	    const TokenArray t(targets);
+	    for (size_t i = 0; i < sources.size(); ++i)
+		pNet_->divergent_connect(sources[i], t, w, d, syn);
+	}
+    }
+    catch (SLIException &e)
+    {
+	error = error_message(e, convergent ? "ConvergentConnect" : "DivergentConnect");
+    }
+    Py_END_ALLOW_THREADS
+
+    if (not error.empty())
+    {
+	PyErr_SetString(NESTError_, error.c_str());
+	return false;
+    }
+
+    return true;
+}
+
+bool NESTEngine::simulate(double ms)
+{
+    if(not check_engine())
+	return false;
+
+    std::ostringstream os;
+    os << "Simulating " << ms << " ms.";
+    pEngine_->message(SLIInterpreter::M_INFO, "Simulate", os.str().c_str());
+
+    std::string error;
+
+    Py_BEGIN_ALLOW_THREADS
+    Sigfunc *py_signal_handler= posix_signal(SIGINT, (Sigfunc *)SIG_IGN);
+    posix_signal(SIGINT,(Sigfunc *)SLISignalHandler);
+    try
+    {
+	pNet_->simulate(nest::Time::ms(ms));
+    }
+    catch (SLIException &e)
+    {
+	error = error_message(e, "Simulate");
+    }
+    posix_signal(SIGINT,(Sigfunc *)py_signal_handler);
+    Py_END_ALLOW_THREADS
+
+    if (not error.empty())
+    {
+	PyErr_SetString(NESTError_, error.c_str());
+	return false;
+    }
+
+    return true;
+}
+
+PyObject* NESTEngine::create(std::string model, long n)
+{
+    if(not check_engine())
+	return NULL;
+
+    try
+    {
+	if (n <= 0)
+	    throw RangeCheck();
+
+	const Token m = pNet_->get_modeldict().lookup(Name(model));
+	if (m.empty())
+	    throw nest::UnknownModelName(model);
+
+	return PyInt_FromLong(pNet_->add_node(static_cast<nest::index>(m), n));
+    }
+    catch (SLIException &e)
+    {
+	PyErr_SetString(NESTError_, error_message(e, "Create").c_str());
+    }
+
+    return NULL;
+}
+
+Datum* NESTEngine::dictionary_as_Datum_(PyObject *pObj)
+{
+    if (not PyDict_Check(pObj))
+    {
+	PyErr_SetString(NESTError_, "Expected a dictionary.");
+	return 0;
+    }
+
+    return PyObject_as_Datum(pObj);
+}
+
+bool NESTEngine::set_status(PyObject *nodes, PyObject *params)
+{
+    if(not check_engine())
+	return false;
+
+    std::vector<long> gids;
+    if (not as_vector(nodes, gids))
+	return false;
+
+    if (not PySequence_Check(params) or PySequence_Size(params) != (Py_ssize_t) gids.size())
+    {
+	PyErr_SetString(NESTError_, "SetStatus needs one dictionary per node.");
+	return false;
+    }
+
+    // The dictionaries may hold Python objects and the nodes may call
+    // back into Python, so the GIL is kept.
+    for (size_t i = 0; i < gids.size(); ++i)
+    {
+	PyObject *item = PySequence_GetItem(params, i);
+	Datum *datum = item != NULL ? dictionary_as_Datum_(item) : 0;
+	Py_XDECREF(item);
+	if (datum == 0)
+	    return false;
+	DictionaryDatum d = getValue<DictionaryDatum>(Token(datum));
+
+	try
+	{
+	    pNet_->set_status(gids[i], d);
+	}
+	catch (SLIException &e)
+	{
+	    PyErr_SetString(NESTError_, error_message(e, "SetStatus").c_str());
+	    return false;
+	}
+    }
+
+    return true;
+}
+
+PyObject* NESTEngine::get_status(PyObject *nodes, std::string key)
+{
+    if(not check_engine())
+	return NULL;
+
+    std::vector<long> gids;
+    if (not as_vector(nodes, gids))
+	return NULL;
+
+    PyObject *result = PyList_New(gids.size());
+    if (result == NULL)
+	return NULL;
+
+    const Name k(key);
+    DatumToPythonConverter converter;
+
+    for (size_t i = 0; i < gids.size(); ++i)
+    {
+	PyObject *item = NULL;
+	try
+	{
+	    DictionaryDatum d = pNet_->get_status(gids[i]);
+	    if (key.empty())
+		item = converter.convert(d);
+	    else
+	    {
+		const Token &t = d->lookup2(k);
+		item = converter.convert(*t.datum());
+	    }
+	}
+	catch (SLIException &e)
+	{
+	    PyErr_SetString(NESTError_, error_message(e, "GetStatus").c_str());
+	}
+
+	if (item == NULL)
+	{
+	    Py_DECREF(result);
+	    return NULL;
+	}
+	PyList_SET_ITEM(result, i, item);
+    }
+
+    return result;
+}
+
+bool NESTEngine::connect(PyObject *pre, PyObject *post, PyObject *params, PyObject *delay,
+                         std::string model)
+{
+    if(not check_engine())
+	return false;
+
+    std::vector<long> sources, targets;
+    std::vector<double> weights, delays;
+    std::vector<DictionaryDatum> dicts;
+
+    if (not as_vector(pre, sources) or not as_vector(post, targets))
+	return false;
+
+    if (params != Py_None and delay == Py_None)
+    {
+	// one dictionary per connection
+	if (not PySequence_Check(params))
+	{
+	    PyErr_SetString(NESTError_, "params must be a list of dictionaries.");
+	    return false;
+	}
+	const Py_ssize_t n = PySequence_Size(params);
+	for (Py_ssize_t i = 0; i < n; ++i)
+	{
+	    PyObject *item = PySequence_GetItem(params, i);
+	    Datum *datum = item != NULL ? dictionary_as_Datum_(item) : 0;
+	    Py_XDECREF(item);
+	    if (datum == 0)
+		return false;
+	    dicts.push_back(getValue<DictionaryDatum>(Token(datum)));
+	}
+    }
+    else if (not as_vector(params, weights) or not as_vector(delay, delays))
+	return false;
+
+    if (targets.size() != sources.size()
+        or (not dicts.empty() and dicts.size() != sources.size())
+        or weights.size() != delays.size()
+        or (not weights.empty() and weights.size() != sources.size()))
+    {
+	PyErr_SetString(NESTError_, "Connect needs the same number of sources, targets and parameters.");
+	return false;
+    }
+
+    std::string error;
+
+    Py_BEGIN_ALLOW_THREADS
+    try
+    {
+	const Token synmodel = pNet_->get_synapsedict().lookup(Name(model));
+	if (synmodel.empty())
+	    throw nest::UnknownSynapseType(model);
+	const nest::index syn = static_cast<nest::index>(synmodel);
+
+	for (size_t i = 0; i < sources.size(); ++i)
+	{
+	    if (not dicts.empty())
+	    {
+		dicts[i]->clear_access_flags();
+		std::string missed;
+		if (pNet_->connect(sources[i], targets[i], dicts[i], syn)
+		    and not dicts[i]->all_accessed(missed))
+		{
+		    if (pNet_->dict_miss_is_error())
+			throw UnaccessedDictionaryEntry(missed);
+		    else
+			pNet_->message(SLIInterpreter::M_WARNING, "Connect",
+			               ("Unread dictionary entries: " + missed).c_str());
+		}
+	    }
+	    else if (not weights.empty())
+		pNet_->connect(sources[i], targets[i], weights[i], delays[i], syn);
+	    else
+		pNet_->connect(sources[i], targets[i], syn);
+	}
+    }
+    catch (SLIException &e)
+    {
+	error = error_message(e, "Connect");
+    }
+    Py_END_ALLOW_THREADS
+
+    if (not error.empty())
+    {
+	PyErr_SetString(NESTError_, error.c_str());
+	return false;
+    }
+
+    return true;
+}
+
+bool NESTEngine::data_connect(PyObject *columns, std::string model)
+{
+    if(not check_engine())
+	return false;
+
+    Datum *datum = dictionary_as_Datum_(columns);
+    if (datum == 0)
+	return false;
+    DictionaryDatum d = getValue<DictionaryDatum>(Token(datum));
+
+    std::string error;
+
+    Py_BEGIN_ALLOW_THREADS
+    try
+    {
+	const Token synmodel = pNet_->get_synapsedict().lookup(Name(model));
+	if (synmodel.empty())
+	    throw nest::UnknownSynapseType(model);
+
+	pNet_->data_connect(d, static_cast<nest::index>(synmodel));
+    }
+    catch (SLIException &e)
+    {
+	error = error_message(e, "DataConnect");
+    }
+    Py_END_ALLOW_THREADS
+
+    if (not error.empty())
+    {
+	PyErr_SetString(NESTError_, error.c_str());
+	return false;
+    }
+
+    return true;
+}
+
 Datum* NESTEngine::PyObject_as_Datum(PyObject *pObj)
 {
   if (PyInt_Check(pObj)) { // object is integer or bool
@@ -583,6 +1065,23 @@ Datum* NESTEngine::PyObject_as_Datum(PyObject *pObj)
   }
 #endif
 
+  // one-dimensional numeric buffers, including numpy arrays, are
+  // copied into vector datums in one pass without Python objects
+  if (PyObject_CheckBuffer(pObj) and not PyByteArray_Check(pObj)) {
+    if (buffer_is_float(pObj)) {
+      std::vector<double> *datavec = new std::vector<double>;
+      if (buffer_to_vector(pObj, *datavec))
+        return new DoubleVectorDatum(datavec);
+      delete datavec;
+    }
+    else {
+      std::vector<long> *datavec = new std::vector<long>;
+      if (buffer_to_vector(pObj, *datavec))
+        return new IntVectorDatum(datavec);
+      delete datavec;
+    }
+  }
+
 #ifdef HAVE_NUMPY
   if (PyArray_CheckScalar(pObj)) { // handle numpy array scalars
 
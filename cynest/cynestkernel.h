@@ -54,8 +54,70 @@ class NESTEngine
 
   void register_cython_model(std::string model);
 
+  /**
+   * Select whether pop() copies vector results or returns numpy arrays
+   * sharing their storage, see DatumToPythonConverter::set_copy_vectors.
+   */
+  void set_copy_vectors(bool copy);
+  bool get_copy_vectors();
+
+  /**
+   * Connect the nodes in pre and post directly through the network,
+   * without going through the interpreter. pre, post, weight and delay
+   * may be numpy arrays or other buffers, sequences, or numbers;
+   * weight and delay may be None. If convergent is true, all of pre is
+   * connected to each node in post, otherwise each node in pre is
+   * connected to all of post.
+   */
+  bool connect_arrays(PyObject *pre, PyObject *post, PyObject *weight, PyObject *delay,
+                      std::string model, bool convergent);
+
+  // Direct entry points for the most frequently called functions of
+  // the high-level API. They call the network without parsing and
+  // executing SLI code, and set a NESTError on failure.
+
+  /**
+   * Simulate for the given time in ms. The GIL is released.
+   */
+  bool simulate(double ms);
+
+  /**
+   * Create n nodes of the given model and return the GID of the last one.
+   */
+  PyObject* create(std::string model, long n);
+
+  /**
+   * Set the status of each node in nodes to the matching dictionary
+   * in params.
+   */
+  bool set_status(PyObject *nodes, PyObject *params);
+
+  /**
+   * Return a list with the status dictionaries of the given nodes or,
+   * if key is not empty, with the value of key in each of them.
+   */
+  PyObject* get_status(PyObject *nodes, std::string key);
+
+  /**
+   * Connect pre[i] to post[i] for all i. params is None, a sequence
+   * of dictionaries, or a sequence of weights, in which case delay
+   * holds the delays. The GIL is released while connecting.
+   */
+  bool connect(PyObject *pre, PyObject *post, PyObject *params, PyObject *delay,
+               std::string model);
+
+  /**
+   * Create one connection per entry of the arrays in the dictionary
+   * columns, see Network::data_connect. The arrays may be numpy arrays
+   * or sequences. The GIL is released while connecting.
+   */
+  bool data_connect(PyObject *columns, std::string model);
+
  private:
 
+  //! Like PyObject_as_Datum, but fails unless pObj is a dictionary.
+  Datum* dictionary_as_Datum_(PyObject *pObj);
+
   /**
    * Helper function to initialize numpy.
    * This is a wrapper around a numpy macro which apparently contains a return statement.
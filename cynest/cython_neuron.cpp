@@ -30,9 +30,11 @@
 #include "doubledatum.h"
 #include "universal_data_logger_impl.h"
 #include "dictstack.h"
+#include "compose.hpp"
 
 #include <string>
 #include <limits>
+#include <algorithm>
 
 #include <stdio.h>
 /* ----------------------------------------------------------------
@@ -65,6 +67,9 @@ nest::cython_neuron::Buffers_::Buffers_(const Buffers_ &, cython_neuron &n)
  * ---------------------------------------------------------------- */
 nest::cython_neuron::cython_neuron()
   : Archiving_Node(),
+    nogil(false),
+    population_(0),
+    population_index_(-1),
     state_(new Dictionary()),
     B_(*this)
 {
@@ -74,6 +79,9 @@ nest::cython_neuron::cython_neuron()
 
 nest::cython_neuron::cython_neuron(const cython_neuron& n)
   : Archiving_Node(n),
+    nogil(false),
+    population_(0),
+    population_index_(-1),
     state_(new Dictionary(*n.state_)),
     B_(n.B_, *this)
 {
@@ -83,6 +91,8 @@ nest::cython_neuron::cython_neuron(const cython_neuron& n)
 
 nest::cython_neuron::~cython_neuron()
 {
+   if(population_ != 0)
+     population_->remove_member(population_index_);
    delete pyObj;
 }
 
@@ -112,13 +122,19 @@ void nest::cython_neuron::calibrate()
 {
   B_.logger_.init();
 
-  if(pyObj != NULL) {	  
+  if(population_ != 0) {
+	// the population calls calibrate() once for all its members
+	population_->calibrate_member(population_index_, not is_frozen());
+  }
+  else if(pyObj != NULL) {	  
 	// Pointers to Standard Parameters passing
 	pyObj->putStdParams(&currents, &in_spikes, &ex_spikes, &t_lag, &spike, &current_value);
 	*spike = 0;
 	*current_value = 0.0;
 	pyObj->call_method("calibrate");
 
+	nogil = pyObj->has_update_nogil();
+
 	if(state_->known(Name("optimized")) && (*state_)[Name("optimized")]) {
 		optimized = true;
 	}
@@ -133,6 +149,20 @@ void nest::cython_neuron::calibrate()
  */
 void nest::cython_neuron::update(Time const & origin, const long_t from, const long_t to)
 {
+  if(population_ != 0)
+  {
+    for ( long_t lag = from ; lag < to ; ++lag )
+      population_->set_input(population_index_, lag,
+                             B_.currents_.get_value(lag),
+                             B_.in_spikes_.get_value(lag),
+                             B_.ex_spikes_.get_value(lag));
+
+    // the last member to arrive updates the whole population
+    if(population_->arrive())
+      population_->update_block(origin, from, to);
+    return;
+  }
+
   for ( long_t lag = from ; lag < to ; ++lag )
   {
 	*currents = B_.currents_.get_value(lag);
@@ -141,30 +171,38 @@ void nest::cython_neuron::update(Time const & origin, const long_t from, const l
     *t_lag = lag;
 
 
-    if(this->optimized) {
+    if(this->nogil) {
+		pyObj->call_update_nogil();
+    }
+    else if(this->optimized) {
 		pyObj->call_update_optimized();
     }
     else {
 		pyObj->call_update();
     }
 
-    // threshold crossing
-    if (*spike)
-    {
-      set_spiketime(Time::step(origin.get_steps()+lag+1));
-      SpikeEvent se;
-      network()->send(*this, se, lag);
-    }
+    emit_(origin, lag, *spike, *current_value);
+  }
+}
 
-    if(*current_value != 0.0)
-    {
-        CurrentEvent ce;
-		ce.set_current(*current_value);
-		network()->send(*this, ce, lag);
-    }
+void nest::cython_neuron::emit_(Time const & origin, const long_t lag, bool spike, double_t current)
+{
+  // threshold crossing
+  if (spike)
+  {
+    set_spiketime(Time::step(origin.get_steps()+lag+1));
+    SpikeEvent se;
+    network()->send(*this, se, lag);
+  }
 
-    B_.logger_.record_data(origin.get_steps()+lag);
+  if(current != 0.0)
+  {
+    CurrentEvent ce;
+    ce.set_current(current);
+    network()->send(*this, ce, lag);
   }
+
+  B_.logger_.record_data(origin.get_steps()+lag);
 }
 
 
@@ -197,27 +235,281 @@ void nest::cython_neuron::handle(DataLoggingRequest& e)
   B_.logger_.handle(e);
 }
 
-void nest::cython_neuron::setStatusCython()
+void nest::cython_neuron::setStatusCython(const DictionaryDatum& d)
 {
 	// The first setStatus iteration will remove the pyobject from the dictionary and put it in a different object
+	// and passes the whole state, later ones only the changed values in d
 	static Name pyObjectName = Name("pyobject");
+	static Name populationIndexName = Name("population_index");
     if(pyObj == NULL && state_->known(pyObjectName) ) {
-       ((PyObjectDatum*)(&(*(*state_)[pyObjectName])))->call_status_method(SET_STATUS_METHOD, &state_);
-       pyObj = ((PyObjectDatum*)(&(*(*state_)[pyObjectName])))->clone();
+       PyObjectDatum* pd = (PyObjectDatum*)(&(*(*state_)[pyObjectName]));
+
+       // members of a NeuronPopulation are addressed by their slot
+       if(state_->known(populationIndexName)) {
+          population_index_ = getValue<long>(state_, populationIndexName);
+          pd->set_member(population_index_);
+       }
+
+       if(not pd->set_status(state_))
+          throw PythonError("setStatus");
+       pyObj = pd->clone();
        state_->remove(pyObjectName);
+
+       if(population_index_ >= 0) {
+          population_ = CythonPopulation::get(pyObj->get_pyobject());
+          population_->add_member(population_index_, this);
+       }
     }
     else if(pyObj != NULL) {
-       pyObj->call_status_method(SET_STATUS_METHOD, &state_);
+       if(not pyObj->set_status(d))
+          throw PythonError("setStatus");
     }
 }
 
 void nest::cython_neuron::getStatusCython() const
 {
     if(pyObj != NULL) {
-		pyObj->call_status_method(GET_STATUS_METHOD, &state_);
+		pyObj->get_status(state_);
+    }
+}
+
+
+/* ----------------------------------------------------------------
+ * NeuronPopulation support
+ * ---------------------------------------------------------------- */
+
+nest::PythonError::PythonError(const std::string& method)
+  : KernelException("PythonError"),
+    msg_("Python method " + method + " failed.")
+{
+  PyGILState_STATE s = PyGILState_Ensure();
+
+  PyObject* type;
+  PyObject* value;
+  PyObject* traceback;
+  PyErr_Fetch(&type, &value, &traceback);
+
+  // the value may be missing for exceptions raised without arguments
+  PyObject* str = PyObject_Str(value != NULL ? value : type);
+  if(str != NULL && PyUnicode_Check(str))
+  {
+    PyObject* bytes = PyUnicode_AsUTF8String(str);
+    Py_DECREF(str);
+    str = bytes;
+  }
+  if(str != NULL && PyString_Check(str))
+    msg_ += std::string(" ") + PyString_AsString(str);
+
+  Py_XDECREF(str);
+  Py_XDECREF(type);
+  Py_XDECREF(value);
+  Py_XDECREF(traceback);
+  PyErr_Clear();
+
+  PyGILState_Release(s);
+}
+
+std::string nest::PythonError::message()
+{
+  return msg_;
+}
+
+namespace
+{
+  /**
+   * Release the result of a call into a Python object, or release the
+   * GIL and throw a PythonError if the call raised.
+   */
+  void check_result_(PyObject* result, const char* method, PyGILState_STATE s)
+  {
+    if(result != NULL && not PyErr_Occurred())
+    {
+      Py_DECREF(result);
+      return;
     }
+
+    Py_XDECREF(result);
+    nest::PythonError e(method);
+    PyGILState_Release(s);
+    throw e;
+  }
+
+  /**
+   * Return the address reported by a getP* method of a NeuronPopulation.
+   * The GIL must be held; it is released if a PythonError is thrown.
+   */
+  template <typename T>
+  T* get_address_(PyObject* pop, const char* method, PyGILState_STATE s)
+  {
+    PyObject* a = PyObject_CallMethod(pop, method, NULL);
+    const long addr = a != NULL ? PyInt_AsLong(a) : 0;
+    check_result_(a, method, s);
+    return reinterpret_cast<T*>(addr);
+  }
+}
+
+std::map<PyObject*, nest::CythonPopulation*> nest::CythonPopulation::registry_;
+
+nest::CythonPopulation* nest::CythonPopulation::get(PyObject* pop)
+{
+  std::map<PyObject*, CythonPopulation*>::iterator it = registry_.find(pop);
+  if(it != registry_.end())
+    return it->second;
+
+  CythonPopulation* p = new CythonPopulation(pop);
+  registry_[pop] = p;
+  return p;
+}
+
+nest::CythonPopulation::CythonPopulation(PyObject* pop)
+  : pop_(pop),
+    members_(),
+    active_(),
+    n_members_(0),
+    n_active_(0),
+    n_calibrated_(0),
+    n_arrived_(0),
+    n_lags_(0),
+    update_block_nogil_(0),
+    currents_(0),
+    in_spikes_(0),
+    ex_spikes_(0),
+    spike_(0),
+    current_value_(0)
+{
+  PyGILState_STATE s = PyGILState_Ensure();
+  Py_XINCREF(pop_);
+  PyGILState_Release(s);
+}
+
+nest::CythonPopulation::~CythonPopulation()
+{
+  registry_.erase(pop_);
+
+  PyGILState_STATE s = PyGILState_Ensure();
+  Py_XDECREF(pop_);
+  PyGILState_Release(s);
+}
+
+void nest::CythonPopulation::add_member(index slot, cython_neuron* n)
+{
+  if(slot >= members_.size())
+  {
+    members_.resize(slot + 1, 0);
+    active_.resize(slot + 1, false);
+  }
+
+  if(members_[slot] != 0)
+    throw BadProperty(String::compose("Slot %1 of the population is already taken.", slot));
+
+  members_[slot] = n;
+  ++n_members_;
+}
+
+void nest::CythonPopulation::remove_member(index slot)
+{
+  assert(slot < members_.size());
+
+  if(active_[slot])
+    --n_active_;
+  active_[slot] = false;
+  members_[slot] = 0;
+
+  if(--n_members_ == 0)
+    delete this;
+}
+
+void nest::CythonPopulation::allocate_()
+{
+  n_lags_ = Scheduler::get_min_delay();
+
+  PyGILState_STATE s = PyGILState_Ensure();
+
+  // the block holds one row per slot, including those of removed members
+  check_result_(PyObject_CallMethod(pop_, "allocate_block", "ll",
+                                    static_cast<long>(members_.size()), static_cast<long>(n_lags_)),
+                "allocate_block", s);
+
+  // numeric conversion in order to create a pointer from the address of the block arrays
+  currents_ = get_address_<double_t>(pop_, "getPCurrents", s);
+  in_spikes_ = get_address_<double_t>(pop_, "getPIn_Spikes", s);
+  ex_spikes_ = get_address_<double_t>(pop_, "getPEx_Spikes", s);
+  spike_ = get_address_<long>(pop_, "getPSpike", s);
+  current_value_ = get_address_<double_t>(pop_, "getPCurrent_Value", s);
+
+  // GIL-free update_block, if the model provides one
+  PyObject* fct = PyObject_CallMethod(pop_, "getPUpdate_Block_Nogil", NULL);
+  if(fct != NULL)
+  {
+    update_block_nogil_ = reinterpret_cast<UpdateBlockNogilFct>(PyInt_AsLong(fct));
+    check_result_(fct, "getPUpdate_Block_Nogil", s);
+  }
+  else
+  {
+    PyErr_Clear();
+    update_block_nogil_ = 0;
+  }
+
+  check_result_(PyObject_CallMethod(pop_, "calibrate", NULL), "calibrate", s);
+
+  PyGILState_Release(s);
+}
+
+void nest::CythonPopulation::calibrate_member(index slot, bool active)
+{
+  assert(slot < members_.size() && members_[slot] != 0);
+
+  if(n_calibrated_ == 0)
+  {
+    allocate_();
+    n_arrived_ = 0;
+  }
+
+  if(active != active_[slot])
+  {
+    active_[slot] = active;
+    if(active)
+      ++n_active_;
+    else
+      --n_active_;
+  }
+
+  // all members are calibrated in every round, frozen ones included
+  if(++n_calibrated_ == n_members_)
+    n_calibrated_ = 0;
 }
 
+void nest::CythonPopulation::update_block(Time const& origin, const long_t from, const long_t to)
+{
+  assert(to - from <= n_lags_);
+
+  const size_t n = members_.size() * n_lags_;
+  std::fill(spike_, spike_ + n, 0L);
+  std::fill(current_value_, current_value_ + n, 0.0);
+
+  if(update_block_nogil_ != 0)
+    update_block_nogil_(pop_, from, to);
+  else
+  {
+    PyGILState_STATE s = PyGILState_Ensure();
+    check_result_(PyObject_CallMethod(pop_, "update_block", "ll",
+                                      static_cast<long>(from), static_cast<long>(to)),
+                  "update_block", s);
+    PyGILState_Release(s);
+  }
+
+  for(index slot = 0; slot < members_.size(); ++slot)
+  {
+    if(not active_[slot])
+      continue;
+
+    for(long_t lag = from; lag < to; ++lag)
+    {
+      const size_t k = offset_(slot, lag);
+      members_[slot]->emit_(origin, lag, spike_[k] != 0, current_value_[k]);
+    }
+  }
+}
 
 void nest::register_cython_model(nest::Network *net, std::string model)
 {
@@ -33,6 +33,7 @@
 #include "genericmodel.h"
 
 #include "pyobjectdatum.h"
+#include "cython_population.h"
 
 namespace nest{
 
@@ -79,8 +80,28 @@ Errors are handled by the SLI standard errorhandler. In addition, the
 contents of the error dictionary is copied into the node's status
 dictionary, to allow debugging of the node.
 
-Parameters:
+Population mode.
+If the model class derives from NeuronPopulation instead of Neuron,
+all neurons of the model on one thread share a single Python object.
+Their inputs are collected into contiguous [member x lag] arrays and
+update_block(lag_from, lag_to) is called once per thread and time
+slice instead of update() once per neuron and time step. The node's
+row in the population is given by /population_index.
+State variables listed in the class's state_variables are kept in a
+[variable x member] arena of aligned arrays; GetStatus reads them
+from there and GetPopulationState returns them as numpy views.
+
+GIL-free update.
+Models that override the nogil method Neuron.update_nogil (or
+NeuronPopulation.update_block_nogil) are detected by RegisterNeuron
+and updated through a C function pointer without acquiring the GIL,
+so that they run in parallel on all threads. Other models are updated
+with the GIL held, unless /optimized is set, which skips the GIL
+without any check.
 
+Parameters:
+population_index  integer - Slot of the node in its NeuronPopulation,
+                            -1 for individually updated neurons.
 
 Sends: SpikeEvent
 
@@ -117,6 +138,13 @@ SeeAlso: iaf_psc_delta, iaf_psc_exp, iaf_cond_exp, testsuite::test_cython_neuron
     using Node::connect_sender;
     using Node::handle;
 
+    /**
+     * Members of a population must be updated by the thread of the
+     * population, see CythonPopulation, and the update of plain
+     * models may use Python state shared across nodes.
+     */
+    bool supports_stealing() const {return false;}
+
     port check_connection(Connection&, port);
 
     void handle(SpikeEvent &);
@@ -144,6 +172,11 @@ SeeAlso: iaf_psc_delta, iaf_psc_exp, iaf_cond_exp, testsuite::test_cython_neuron
     
     PyObjectDatum* pyObj;
     bool optimized;
+    bool nogil;  //!< Model provides update_nogil, see Neuron.pyx
+
+    //! Shared population if the model is a NeuronPopulation, else 0.
+    CythonPopulation* population_;
+    long_t population_index_;  //!< Slot of this node in population_
 
     void init_state_(const Node& proto);
     void init_buffers_();
@@ -151,7 +184,13 @@ SeeAlso: iaf_psc_delta, iaf_psc_exp, iaf_cond_exp, testsuite::test_cython_neuron
 
     void update(Time const &, const long_t, const long_t);
 
-    void setStatusCython();
+    /**
+     * Send the spike and current produced in the given lag and record
+     * analog data. Used by update() and CythonPopulation::update_block().
+     */
+    void emit_(Time const &, const long_t lag, bool spike, double_t current);
+
+    void setStatusCython(const DictionaryDatum&);
     void getStatusCython() const;
 
     void get(DictionaryDatum&) const;  //!< Store current values in dictionary
@@ -160,6 +199,7 @@ SeeAlso: iaf_psc_delta, iaf_psc_exp, iaf_cond_exp, testsuite::test_cython_neuron
     // The next two classes need to be friends to access the State_ class/member
     friend class RecordablesMap<cython_neuron>;
     friend class UniversalDataLogger<cython_neuron>;
+    friend class CythonPopulation;
 
     // ----------------------------------------------------------------
 
@@ -276,7 +316,7 @@ void cython_neuron::set_status(const DictionaryDatum &d)
     it->second.set_access_flag();
   }
 
-  setStatusCython();
+  setStatusCython(d);
 }
 
 void register_cython_model(Network* net, std::string model);
@@ -0,0 +1,188 @@
+/*
+ *  cython_population.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CYTHON_POPULATION_H
+#define CYTHON_POPULATION_H
+
+#include <Python.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "nest.h"
+#include "nest_time.h"
+#include "exceptions.h"
+
+namespace nest
+{
+  class cython_neuron;
+
+  /**
+   * Exception to be thrown if a call into a Cython model raised a
+   * Python exception. The message holds the Python error, which is
+   * cleared when the exception is created.
+   * @ingroup KernelExceptions
+   */
+  class PythonError: public KernelException
+  {
+    std::string msg_;
+  public:
+    //! @param method name of the Python method that failed
+    PythonError(const std::string& method);
+
+    ~PythonError() throw () {}
+
+    std::string message();
+  };
+
+  /**
+   * C++ side of a Cython NeuronPopulation.
+   *
+   * All cython_neuron instances of one model that live on the same
+   * thread share one Python NeuronPopulation object. Each member owns
+   * one row (its slot) in the population's block arrays. During
+   * update, every member copies its ring-buffer input for the slice
+   * into its row; the last active member to arrive triggers a single
+   * call to NeuronPopulation.update_block(from, to) and then emits the
+   * spikes and currents of all members.
+   *
+   * One CythonPopulation exists per Python population object. It is
+   * created when the first member is attached (SetStatus, serial
+   * context) and deleted when the last member is destroyed. A
+   * population is only ever touched by the thread its members live on
+   * during calibrate() and update(). This is why cython_neuron does not
+   * support the work-stealing update, and why the arrival count needs
+   * no synchronization.
+   */
+  class CythonPopulation
+  {
+  public:
+
+    /**
+     * Return the population for the given Python object, creating it
+     * if necessary. Must only be called from serial code.
+     */
+    static CythonPopulation* get(PyObject*);
+
+    /**
+     * Attach a node to the given slot of the population.
+     */
+    void add_member(index slot, cython_neuron*);
+
+    /**
+     * Detach the node in the given slot. The population deletes
+     * itself when its last member is removed.
+     */
+    void remove_member(index slot);
+
+    /**
+     * Called from cython_neuron::calibrate() for every member. The
+     * first call of a calibration round allocates the block arrays
+     * and calls NeuronPopulation.calibrate(). Frozen members are
+     * marked inactive and are not waited for during update.
+     */
+    void calibrate_member(index slot, bool active);
+
+    /**
+     * Store the input of a member for one lag of the current slice.
+     */
+    void set_input(index slot, long_t lag, double_t currents,
+                   double_t in_spikes, double_t ex_spikes);
+
+    /**
+     * Mark one active member as ready. Returns true for the last
+     * member of the current update step, which must then call
+     * update_block().
+     */
+    bool arrive();
+
+    /**
+     * Run NeuronPopulation.update_block() once for all members and
+     * emit the resulting spikes and currents. Models that provide
+     * update_block_nogil are called through it, without the GIL.
+     */
+    void update_block(Time const&, const long_t, const long_t);
+
+  private:
+    explicit CythonPopulation(PyObject*);
+    ~CythonPopulation();
+
+    //! Allocate the block arrays and fetch their addresses.
+    void allocate_();
+
+    size_t offset_(index slot, long_t lag) const;
+
+    PyObject* pop_;                        //!< The Python NeuronPopulation
+    std::vector<cython_neuron*> members_;  //!< Members by slot, 0 if gone
+    std::vector<bool> active_;             //!< Members that are updated
+
+    size_t n_members_;     //!< Number of attached members
+    size_t n_active_;      //!< Number of unfrozen members
+    size_t n_calibrated_;  //!< Members calibrated in this round
+    size_t n_arrived_;     //!< Members that delivered input in this step
+
+    long_t n_lags_;        //!< Row length of the block arrays
+
+    //! GIL-free NeuronPopulation.update_block_nogil, 0 if not provided
+    typedef void (*UpdateBlockNogilFct)(PyObject*, long, long);
+    UpdateBlockNogilFct update_block_nogil_;
+
+    // Addresses of the block arrays, owned by the Python object.
+    double_t* currents_;
+    double_t* in_spikes_;
+    double_t* ex_spikes_;
+    long*     spike_;
+    double_t* current_value_;
+
+    static std::map<PyObject*, CythonPopulation*> registry_;
+  };
+
+  inline
+  size_t CythonPopulation::offset_(index slot, long_t lag) const
+  {
+    return slot * n_lags_ + lag;
+  }
+
+  inline
+  void CythonPopulation::set_input(index slot, long_t lag, double_t c,
+                                   double_t in, double_t ex)
+  {
+    const size_t k = offset_(slot, lag);
+    currents_[k] = c;
+    in_spikes_[k] = in;
+    ex_spikes_[k] = ex;
+  }
+
+  inline
+  bool CythonPopulation::arrive()
+  {
+    if ( ++n_arrived_ < n_active_ )
+      return false;
+
+    n_arrived_ = 0;
+    return true;
+  }
+
+} // namespace
+
+#endif /* #ifndef CYTHON_POPULATION_H */
@@ -4,12 +4,20 @@ cdef bytes invalid_cmd = "<+*-_Invalid Command_-*+>".encode('UTF-8')
 cdef bytes composed_protected_cmd = "<+*-_Composed Protected Command_-*+>".encode('UTF-8')
 cdef bytes composed_unprotected_cmd = "<+*-_Composed Unprotected Command_-*+>".encode('UTF-8')
 
+cdef protected_re = re.compile('^{ (.+?) } runprotected$'.encode("UTF-8"))
+cdef word_re = re.compile('^[^ /]+$'.encode("UTF-8"))
+
+# bound on the number of distinct command strings remembered by run()
+cdef int max_cached_runs = 1024
+
 cdef class SLIDataContainer:
     cdef classes.NESTEngine *nest_engine
-    cdef commands
+    cdef dict commands
+    cdef dict runs
 
     def __cinit__(self):
         self.commands = {}
+        self.runs = {}
 
     cdef initialize(self, classes.NESTEngine *nest):
         self.nest_engine = nest
@@ -39,11 +47,7 @@ cdef class SLIDataContainer:
         
 
     cdef bint is_command(self, string cmd):
-        for key in self.commands.keys():
-            if cmd.compare(key) == 0:
-                return True
-
-        return False
+        return <bytes>cmd in self.commands
 
     cdef bint add_command(self, string cmd):
         cdef PyToken token
@@ -66,26 +70,48 @@ cdef class SLIDataContainer:
         else:
             return None
 
-    cdef run(self, string cmd):
+    cdef classify(self, bytes cmd):
+        """
+        Return the token that executes cmd if it is a single command,
+        possibly wrapped in runprotected, and the matching composed or
+        invalid marker otherwise.
+        """
         cdef bytes command
-        cdef PyToken t
         cdef composed_cmd
 
-        m = re.search('^{ (.+?) } runprotected$'.encode("UTF-8"), cmd)
-        if hasattr(m, 'group'):
+        m = protected_re.match(cmd)
+        if m is not None:
             command = m.group(1)
             composed_cmd = composed_protected_cmd
         else:
             command = cmd
             composed_cmd = composed_unprotected_cmd
 
-        if re.match('^[^ /]+$'.encode("UTF-8"), command):
+        if word_re.match(command):
             if self.add_command(command):
-                t = self.commands[command]
-                return self.nest_engine.run_token(t.thisptr[0])
+                return self.commands[command]
             else:
                 return invalid_cmd
         else:
             return composed_cmd
 
+    cdef run(self, string cmd):
+        cdef bytes key = cmd
+        cdef PyToken t
 
+        # The analysis of a command string is remembered, so the
+        # regular expressions and the lookup only run the first time.
+        entry = self.runs.get(key)
+        if entry is None:
+            entry = self.classify(key)
+            if entry is invalid_cmd:
+                return entry # may become valid later, e.g. after Install
+            if len(self.runs) >= max_cached_runs:
+                self.runs.clear()
+            self.runs[key] = entry
+
+        if isinstance(entry, PyToken):
+            t = entry
+            return self.nest_engine.run_token(t.thisptr[0])
+
+        return entry
@@ -107,27 +107,80 @@ void DatumToPythonConverter::convert_me(LiteralDatum &ld)
 #endif
 }
 
-void DatumToPythonConverter::convert_me(DoubleVectorDatum &dvd)
+#ifdef HAVE_NUMPY
+namespace
 {
-  int dims = dvd->size();
+  const char vector_capsule_name[] = "nest.vector";
+
+  /**
+   * Capsule destructor. Drops the reference to the vector which the
+   * capsule held on behalf of a numpy array.
+   */
+  template <class T>
+  void release_vector(PyObject *capsule)
+  {
+    delete static_cast<lockPTR<std::vector<T> >*>(PyCapsule_GetPointer(capsule, vector_capsule_name));
+  }
 
-#ifdef HAVE_NUMPY
-  PyArrayObject *array;
+  /**
+   * Return a one-dimensional numpy array of the given type with the
+   * contents of v. If copy is false and v is not empty, the array uses
+   * the storage of v and keeps it alive through a capsule which holds
+   * a reference to v. Such an array is only writeable if nobody else
+   * refers to v, so Python can never modify vectors that NEST still
+   * uses.
+   */
+  template <class T>
+  PyObject* vector_to_array(lockPTR<std::vector<T> > &v, int type, bool copy)
+  {
+    npy_intp n = v->size();
+
+    if ( copy || n == 0 )
+    {
+      PyObject *array = PyArray_SimpleNew(1, &n, type);
+      if ( array != 0 )
+        std::copy(v->begin(), v->end(), static_cast<T*>(PyArray_DATA((PyArrayObject*)array)));
+      return array;
+    }
 
-// PyArray_SimpleNew is a drop-in replacement for PyArray_FromDims
-#if (NPY_VERSION >= 0x01000009)
-// PyArray_SimpleNew takes ``npy_intp*`` dims instead of ``int*`` dims
-// which matters on 64-bit systems and it does not initialize the
-// memory to zero.
-  npy_intp npydims = dims;
-  array = (PyArrayObject*)(PyArray_SimpleNew(1, &npydims, PyArray_DOUBLE));
+    const bool shared = v.references() > 1;
+
+    PyObject *array = PyArray_SimpleNewFromData(1, &n, type, &(*v)[0]);
+    if ( array == 0 )
+      return 0;
+
+    PyObject *capsule = PyCapsule_New(new lockPTR<std::vector<T> >(v), vector_capsule_name,
+                                      release_vector<T>);
+    if ( capsule == 0 )
+    {
+      Py_DECREF(array);
+      return 0;
+    }
+
+#if NPY_API_VERSION >= 0x00000007
+    // steals the reference to capsule
+    PyArray_SetBaseObject((PyArrayObject*)array, capsule);
+    if ( shared )
+      PyArray_CLEARFLAGS((PyArrayObject*)array, NPY_ARRAY_WRITEABLE);
 #else
-  array = (PyArrayObject*)(PyArray_FromDims(1, &dims, PyArray_DOUBLE));  
-#endif 
+    ((PyArrayObject*)array)->base = capsule;
+    if ( shared )
+      ((PyArrayObject*)array)->flags &= ~NPY_WRITEABLE;
+#endif
 
-  std::copy( dvd->begin(), dvd->end(), reinterpret_cast<double*>(array->data) );  
-  py_object_ = (PyObject*) array;
+    return array;
+  }
+}
+#endif //HAVE_NUMPY
+
+bool DatumToPythonConverter::copy_vectors_ = false;
+
+void DatumToPythonConverter::convert_me(DoubleVectorDatum &dvd)
+{
+#ifdef HAVE_NUMPY
+  py_object_ = vector_to_array<double>(dvd, NPY_DOUBLE, copy_vectors_);
 #else
+  int dims = dvd->size();
   py_object_ = PyList_New(dims);
   for(int i=0; i<dims; i++)
     PyList_SetItem(py_object_, i, PyFloat_FromDouble(dvd->at(i)));
@@ -136,30 +189,14 @@ void DatumToPythonConverter::convert_me(DoubleVectorDatum &dvd)
 
 void DatumToPythonConverter::convert_me(IntVectorDatum &ivd)
 {
-  int dims = ivd->size();
-
 #ifdef HAVE_NUMPY
-  PyArrayObject *array;
-
-// PyArray_SimpleNew is a drop-in replacement for PyArray_FromDims
-#if (NPY_VERSION >= 0x01000009)
-// PyArray_SimpleNew takes ``npy_intp*`` dims instead of ``int*`` dims
-// which matters on 64-bit systems and it does not initialize the
-// memory to zero.
-  npy_intp npydims = dims;
-  array = (PyArrayObject*)PyArray_SimpleNew(1, &npydims, PyArray_INT);
-#else
-  array = (PyArrayObject*)PyArray_FromDims(1, &dims, PyArray_INT);
-#endif
-
-  std::copy( ivd->begin(), ivd->end(), reinterpret_cast<int*>(array->data) );
-  py_object_ = (PyObject*) array;
+  py_object_ = vector_to_array<long>(ivd, NPY_LONG, copy_vectors_);
 #else
+  int dims = ivd->size();
   py_object_ = PyList_New(dims);
   for(int i=0; i<dims; i++)
     PyList_SetItem(py_object_, i, PyInt_FromLong(ivd->at(i)));
 #endif //HAVE_NUMPY
-    
 }
 
 void DatumToPythonConverter::convert_me(ConnectionDatum &cd)
@@ -175,7 +212,7 @@ void DatumToPythonConverter::convert_me(ConnectionDatum &cd)
 // memory to zero.
 npy_intp npydims = dims;
 
-  array = (PyArrayObject*)PyArray_SimpleNew(1, &npydims, PyArray_LONG);
+  array = (PyArrayObject*)PyArray_SimpleNew(1, &npydims, NPY_LONG);
 #else
   array = (PyArrayObject*)PyArray_FromDims(1, &dims, PyArray_LONG);
 #endif
@@ -103,9 +103,29 @@ class DatumToPythonConverter : public DatumConverter
     return py_object_;
   }
 
+  /**
+   * Select how DoubleVectorDatum and IntVectorDatum are converted.
+   * By default, the resulting numpy array shares the storage of the
+   * vector and keeps the Datum alive until the array is garbage
+   * collected, so that large results, e.g. the events of a spike
+   * detector, are returned in constant time. If copy is true, the
+   * elements are copied into a new array instead.
+   */
+  static void set_copy_vectors(bool copy)
+  {
+    copy_vectors_ = copy;
+  }
+
+  static bool get_copy_vectors()
+  {
+    return copy_vectors_;
+  }
+
  private:
   PyObject *py_object_;
 
+  static bool copy_vectors_;
+
 };
 
 #endif
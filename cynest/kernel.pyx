@@ -110,6 +110,21 @@ cdef class NESTEngine:
         """
         return self.thisptr.pop()
 
+    def set_copy_vectors(self, copy):
+        """
+        If copy is true, pop() copies double and integer vectors into new
+        numpy arrays. Otherwise, the arrays share the storage of the
+        vectors, which is much faster for large results.
+        This function is part of the low-level API.
+        """
+        self.thisptr.set_copy_vectors(copy)
+
+    def get_copy_vectors(self):
+        """
+        Return true if pop() copies vectors, see set_copy_vectors().
+        """
+        return self.thisptr.get_copy_vectors()
+
     def run(self, command):
         """
         Execute a SLI command string.
@@ -175,66 +190,75 @@ cdef class NESTEngine:
         return self.thisptr.check_engine()
 
     def convergent_connect(self, pre, post, weight, delay, model):
-        self.add_command('ConvergentConnect')
-        cdef PyToken cmd = self.get_pytoken('ConvergentConnect')
-        cdef PyToken m = self.generate_arg_pytoken('/'+model)
-
-        if weight == None and delay == None:
-            for d in post :
-                self.push(pre)
-                self.push(d)
-                self.push_pytoken(m)
-                self.run_pytoken(cmd) # always run in unprotected mode
+        """
+        Connect all nodes in pre to each node in post. pre, post, weight
+        and delay may be lists or numpy arrays; they are handed to the
+        network in one call without going through the interpreter.
+        """
+        if (weight is None) != (delay is None):
+            raise NESTError("Both 'weight' and 'delay' have to be given.")
 
-        elif weight != None and delay != None:
-            weight = broadcast(weight, len(pre), (float,), "weight")
-            if len(weight) != len(pre):
-                raise NESTError("weight must be a float, or sequence of floats of length 1 or len(pre)")
-            delay = broadcast(delay, len(pre), (float,), "delay")
-            if len(delay) != len(pre):
-                raise NESTError("delay must be a float, or sequence of floats of length 1 or len(pre)")
-        
-            for d in post:
-                self.push(pre)
-                self.push(d)
-                self.push(weight)
-                self.push(delay)
-                self.push_pytoken(m)
-                self.run_pytoken(cmd) # always run in unprotected mode
+        cdef bytes model_bytes = model.encode('UTF-8')
+        self.thisptr.connect_arrays(pre, post, weight, delay, model_bytes, True)
 
-        else:
+    def divergent_connect(self, pre, post, weight, delay, model):
+        """
+        Connect each node in pre to all nodes in post, see convergent_connect.
+        """
+        if (weight is None) != (delay is None):
             raise NESTError("Both 'weight' and 'delay' have to be given.")
 
-    def divergent_connect(self, pre, post, weight, delay, model):
-        self.add_command('DivergentConnect')
-        cdef PyToken cmd = self.get_pytoken('DivergentConnect')
-        cdef PyToken m = self.generate_arg_pytoken('/' + model)
+        cdef bytes model_bytes = model.encode('UTF-8')
+        self.thisptr.connect_arrays(pre, post, weight, delay, model_bytes, False)
 
-        if weight == None and delay == None:
-            for s in pre :
-                self.push(s)
-                self.push(post)
-                self.push_pytoken(m)
-                self.run_pytoken(cmd) # always run in unprotected mode
 
-        elif weight != None and delay != None:
-            weight = broadcast(weight, len(post), (float,), "weight")
-            if len(weight) != len(post):
-                raise NESTError("weight must be a float, or sequence of floats of length 1 or len(post)")
-            delay = broadcast(delay, len(post), (float,), "delay")
-            if len(delay) != len(post):
-                raise NESTError("delay must be a float, or sequence of floats of length 1 or len(post)")
-
-            for s in pre :
-                self.push(s)
-                self.push(post)
-                self.push(weight)
-                self.push(delay)
-                self.push_pytoken(m)
-                self.run_pytoken(cmd) # always run in unprotected mode
+    # Direct calls for the hot functions of the high-level API. They go
+    # straight to the network and bypass the interpreter.
 
-        else:
-            raise NESTError("Both 'weight' and 'delay' have to be given.")
+    def simulate(self, double t):
+        """
+        Simulate the network for t milliseconds.
+        """
+        self.thisptr.simulate(t)
+        signal.signal(signal.SIGINT, cynest_signal_handler)
+
+    def create(self, model, long n):
+        """
+        Create n nodes of the given model and return the GID of the last one.
+        """
+        cdef bytes model_bytes = model if isinstance(model, bytes) else model.encode('UTF-8')
+        return self.thisptr.create(model_bytes, n)
+
+    def set_status(self, nodes, params):
+        """
+        Set the status of each node in nodes to the matching dictionary in params.
+        """
+        self.thisptr.set_status(nodes, params)
+
+    def get_status(self, nodes, key=None):
+        """
+        Return the list of status dictionaries of nodes or, if key is given,
+        the list of values of key.
+        """
+        cdef bytes key_bytes = b'' if key is None else key.encode('UTF-8')
+        return self.thisptr.get_status(nodes, key_bytes)
+
+    def connect(self, pre, post, params, delay, model):
+        """
+        Connect pre[i] to post[i]. params is None, a list of dictionaries,
+        or a list of weights, in which case delay is the list of delays.
+        """
+        cdef bytes model_bytes = model.encode('UTF-8')
+        self.thisptr.connect(pre, post, params, delay, model_bytes)
+
+    def data_connect(self, columns, model):
+        """
+        Create one connection per entry of the arrays in the dictionary
+        columns, which holds 'source', 'target', 'weight', 'delay' and
+        optionally 'receptor_type' and parameters of the synapse model.
+        """
+        cdef bytes model_bytes = model.encode('UTF-8')
+        self.thisptr.data_connect(columns, model_bytes)
 
 
     def data_connect1(self, list pre, list params, model):
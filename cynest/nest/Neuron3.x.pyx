@@ -1,5 +1,15 @@
 # cython: language_level=3
 
+from cython.view cimport array as cvarray
+from libc.stdlib cimport free
+from libc.string cimport memset
+from cpython.ref cimport PyObject
+
+import numpy
+
+cdef extern from "stdlib.h":
+    int posix_memalign(void** memptr, size_t alignment, size_t size)
+
 cdef class Neuron:
     # Standard Parameters
     cdef double currents
@@ -8,6 +18,9 @@ cdef class Neuron:
     cdef long t_lag
     cdef long spike
     cdef double current_value
+
+    # set by the default update_nogil, see checkUpdateNogil
+    cdef bint nogil_default
     
     def __cinit__(self):
         pass
@@ -17,6 +30,13 @@ cdef class Neuron:
         
     cpdef update(self):
         pass
+
+    # GIL-free update. If a model overrides this method, the kernel calls
+    # it directly instead of update(), without acquiring the GIL, so that
+    # Cython neurons are updated in parallel on all threads. Being nogil,
+    # it can only use the standard parameters and C typed members.
+    cdef void update_nogil(self) noexcept nogil:
+        self.nogil_default = True
         
     cpdef getStatus(self):
         return {}
@@ -44,6 +64,225 @@ cdef class Neuron:
     cpdef getPCurrent_Value(self):
         return <long>(&(self.current_value))
 
+    cpdef getPUpdate_Nogil(self):
+        if type(self) in nogil_models:
+            return <long>(&neuron_update_nogil)
+        return 0
+
+# Allocate a zero-filled C-contiguous array whose data is aligned to
+# 64 bytes. The buffer is owned and freed by the returned array.
+cdef cvarray aligned_array(tuple shape, Py_ssize_t itemsize, format):
+    cdef size_t nbytes = itemsize
+    cdef void* data = NULL
+    cdef cvarray a
+
+    for s in shape:
+        nbytes *= s
+    if posix_memalign(&data, 64, nbytes) != 0:
+        raise MemoryError()
+    memset(data, 0, nbytes)
+
+    a = cvarray(shape=shape, itemsize=itemsize, format=format, allocate_buffer=False)
+    a.data = <char*>data
+    a.callback_free_data = free
+    return a
+
+
+# Base class for models whose neurons are updated together.
+# All neurons of the model that live on the same thread share one
+# instance. Each neuron owns one slot (row) of the block arrays, whose
+# columns are the lags of the current time slice. update_block is
+# called once per thread and slice; it reads the inputs of member i in
+# lag l from currents[i, l], in_spikes[i, l] and ex_spikes[i, l] and
+# writes spike[i, l] and current_value[i, l], which are zero on entry.
+#
+# The names listed in the class attribute state_variables are stored
+# structure-of-arrays style: state[k, i] is variable k of member i,
+# and every row is 64 byte aligned. They are read and written by the
+# default getStatus/setStatus and can be obtained as numpy views with
+# get_state(). Models with other per-member state grow it in an
+# overridden reserve(), which must call NeuronPopulation.reserve.
+
+cdef class NeuronPopulation:
+    cdef long size
+    cdef long capacity
+    cdef long n_lags
+
+    # Block arrays, indexed by [slot, lag]
+    cdef double[:, ::1] currents
+    cdef double[:, ::1] in_spikes
+    cdef double[:, ::1] ex_spikes
+    cdef long[:, ::1] spike
+    cdef double[:, ::1] current_value
+
+    # State arena, indexed by [variable, slot], and the gids by slot
+    cdef double[:, ::1] state
+    cdef long[::1] gids
+    cdef dict state_index
+
+    cdef bint nogil_default
+
+    state_variables = ()
+
+    def __cinit__(self):
+        self.size = 0
+        self.capacity = 0
+        self.n_lags = 0
+        self.state_index = {}
+        for k, name in enumerate(self.state_variables):
+            self.state_index[name] = k
+
+    cpdef long add_member(self):
+        cdef long slot = self.size
+        if self.size == self.capacity:
+            self.reserve(max(2 * self.capacity, 16))
+        self.size += 1
+        return slot
+
+    cpdef reserve(self, long n):
+        cdef double[:, ::1] state
+        cdef long[::1] gids
+
+        n = (n + 7) & ~7  # keep the rows of the arena aligned
+
+        gids = aligned_array((n,), sizeof(long), "l")
+        if len(self.state_index) > 0:
+            state = aligned_array((len(self.state_index), n), sizeof(double), "d")
+
+        if self.size > 0:
+            gids[:self.size] = self.gids[:self.size]
+            if len(self.state_index) > 0:
+                state[:, :self.size] = self.state[:, :self.size]
+
+        self.gids = gids
+        if len(self.state_index) > 0:
+            self.state = state
+        self.capacity = n
+
+    cpdef set_gid(self, long i, long gid):
+        self.gids[i] = gid
+
+    cpdef allocate_block(self, long n, long n_lags):
+        self.n_lags = n_lags
+        self.currents = aligned_array((n, n_lags), sizeof(double), "d")
+        self.in_spikes = aligned_array((n, n_lags), sizeof(double), "d")
+        self.ex_spikes = aligned_array((n, n_lags), sizeof(double), "d")
+        self.spike = aligned_array((n, n_lags), sizeof(long), "l")
+        self.current_value = aligned_array((n, n_lags), sizeof(double), "d")
+
+    cpdef calibrate(self):
+        pass
+
+    cpdef update_block(self, long lag_from, long lag_to):
+        pass
+
+    # GIL-free variant of update_block, see Neuron.update_nogil.
+    cdef void update_block_nogil(self, long lag_from, long lag_to) noexcept nogil:
+        self.nogil_default = True
+
+    cpdef getStatus(self, long i):
+        cdef dict d = {}
+
+        for name, k in self.state_index.items():
+            d[name] = self.state[k, i]
+        return d
+
+    cpdef setStatus(self, long i, params):
+        for name, k in self.state_index.items():
+            if name in params:
+                self.state[k, i] = params[name]
+
+    # Row of the state arena holding the given variable, for use
+    # in update_block. Only valid until the next reserve().
+    cdef double[::1] state_row(self, name):
+        return self.state[self.state_index[name], :]
+
+    def has_state(self, name):
+        return name in self.state_index
+
+    # Zero-copy views on the arena. They share memory with the
+    # population until it grows on the next Create.
+
+    def get_state(self, name):
+        return numpy.asarray(self.state[self.state_index[name], :self.size])
+
+    def get_gids(self):
+        return numpy.asarray(self.gids[:self.size])
+
+    def get_block(self, name):
+        if name == "currents":
+            return numpy.asarray(self.currents)
+        if name == "in_spikes":
+            return numpy.asarray(self.in_spikes)
+        if name == "ex_spikes":
+            return numpy.asarray(self.ex_spikes)
+        if name == "spike":
+            return numpy.asarray(self.spike)
+        if name == "current_value":
+            return numpy.asarray(self.current_value)
+        raise KeyError(name)
+
+    # Addresses of the block arrays, see Neuron
+
+    cpdef getPCurrents(self):
+        return <long>(&(self.currents[0, 0]))
+
+    cpdef getPIn_Spikes(self):
+        return <long>(&(self.in_spikes[0, 0]))
+
+    cpdef getPEx_Spikes(self):
+        return <long>(&(self.ex_spikes[0, 0]))
+
+    cpdef getPSpike(self):
+        return <long>(&(self.spike[0, 0]))
+
+    cpdef getPCurrent_Value(self):
+        return <long>(&(self.current_value[0, 0]))
+
+    cpdef getPUpdate_Block_Nogil(self):
+        if type(self) in nogil_models:
+            return <long>(&population_update_block_nogil)
+        return 0
+
+
+# Classes of this module whose update_nogil (update_block_nogil) was
+# found to be overridden by checkUpdateNogil.
+cdef set nogil_models = set()
+
+# Entry points called by the kernel without holding the GIL. obj is a
+# borrowed reference owned by the node.
+
+cdef void neuron_update_nogil(PyObject* obj) noexcept nogil:
+    (<Neuron>obj).update_nogil()
+
+cdef void population_update_block_nogil(PyObject* obj, long lag_from, long lag_to) noexcept nogil:
+    (<NeuronPopulation>obj).update_block_nogil(lag_from, lag_to)
+
+
+# Called by RegisterNeuron. Enables the GIL-free update for cls if it
+# overrides update_nogil (or update_block_nogil) and returns whether it
+# does. The check calls the method once on a fresh instance, with an
+# empty lag range for populations.
+def checkUpdateNogil(cls):
+    cdef Neuron n
+    cdef NeuronPopulation p
+
+    if issubclass(cls, NeuronPopulation):
+        p = cls()
+        p.nogil_default = False
+        p.update_block_nogil(0, 0)
+        if p.nogil_default:
+            return False
+    else:
+        n = cls()
+        n.nogil_default = False
+        n.update_nogil()
+        if n.nogil_default:
+            return False
+
+    nogil_models.add(cls)
+    return True
+
 # This class contains the totality of the imported objects
 # needed for accessing classes on the project side
 cdef class ObjectManager:
@@ -0,0 +1,126 @@
+"""
+Readers for the columnar files written by recording devices with
+/columnar set to true. See the documentation of RecordingDevice for
+the layout of the files.
+
+The columns of a file are returned as numpy arrays that are
+memory-mapped from the file, so that the data are only read from disk
+when they are used.
+"""
+
+import numpy
+
+MAGIC = b"NESTCOLS"
+HEADER_SIZE = 64
+COLUMN_SIZE = 32
+
+
+def read_header(fname):
+    """
+    Return the header of the columnar file fname as a dictionary with
+    the entries version, resolution, gid, vp and columns, a list of
+    (name, dtype) pairs, and the entries header_size and
+    chunk_header_size in bytes.
+    """
+
+    f = open(fname, "rb")
+    try:
+        head = f.read(HEADER_SIZE)
+        if len(head) < HEADER_SIZE or head[:8] != MAGIC:
+            raise ValueError("%s is not a columnar NEST file." % fname)
+
+        # the version is 1, which tells us the byte order
+        order = "<"
+        if numpy.frombuffer(head, "<i8", 1, 8)[0] != 1:
+            order = ">"
+        ints = numpy.frombuffer(head, order + "i8", 4, 8)
+        version, header_size, n_columns, chunk_header_size = [int(i) for i in ints]
+        resolution = float(numpy.frombuffer(head, order + "f8", 1, 40)[0])
+        gid, vp = [int(i) for i in numpy.frombuffer(head, order + "i8", 2, 48)]
+
+        columns = []
+        for j in range(n_columns):
+            desc = f.read(COLUMN_SIZE)
+            name = desc[:24].rstrip(b"\0").decode("ascii")
+            dtype = numpy.dtype(desc[24:].rstrip(b"\0").decode("ascii"))
+            columns.append((name, dtype))
+    finally:
+        f.close()
+
+    return {"version": version, "header_size": header_size,
+            "chunk_header_size": chunk_header_size, "resolution": resolution,
+            "gid": gid, "vp": vp, "columns": columns, "byte_order": order}
+
+
+def read_chunks(fname, header=None):
+    """
+    Return the chunk index of the columnar file fname as a list of
+    (slice, n_rows, offset) tuples, where slice is the first step of
+    the time slice in which the rows were recorded and offset the
+    position of the first column of the chunk in the file.
+    """
+
+    if header is None:
+        header = read_header(fname)
+
+    data = numpy.memmap(fname, dtype=numpy.uint8, mode="r")
+    index_dtype = numpy.dtype(header["byte_order"] + "i8")
+
+    chunks = []
+    pos = header["header_size"]
+    while pos + header["chunk_header_size"] <= len(data):
+        slice_begin, n_rows, size = numpy.frombuffer(data, index_dtype, 3, pos)
+        chunks.append((int(slice_begin), int(n_rows), pos + header["chunk_header_size"]))
+        pos += int(size)
+
+    return chunks
+
+
+def load(fname):
+    """
+    Return the columns of the columnar file fname as a dictionary of
+    numpy arrays. fname may also be a list of files, e.g. the files of
+    all virtual processes of a device, whose columns are concatenated.
+    Columns that consist of a single chunk are memory-mapped, others
+    are copied into one array.
+    """
+
+    if not isinstance(fname, str):
+        parts = [load(f) for f in fname]
+        if len(parts) == 0:
+            return {}
+        return dict((name, numpy.concatenate([p[name] for p in parts]))
+                    for name in parts[0])
+
+    header = read_header(fname)
+    chunks = read_chunks(fname, header)
+
+    pieces = dict((name, []) for name, dtype in header["columns"])
+    for slice_begin, n_rows, offset in chunks:
+        for name, dtype in header["columns"]:
+            pieces[name].append(numpy.memmap(fname, dtype=dtype, mode="r",
+                                             offset=offset, shape=(n_rows,)))
+            offset += n_rows * dtype.itemsize
+
+    columns = {}
+    for name, dtype in header["columns"]:
+        if len(pieces[name]) == 1:
+            columns[name] = pieces[name][0]
+        elif len(pieces[name]) == 0:
+            columns[name] = numpy.zeros(0, dtype)
+        else:
+            columns[name] = numpy.concatenate(pieces[name])
+
+    return columns
+
+
+def is_columnar(fname):
+    """
+    Return True if fname is a columnar NEST file.
+    """
+
+    f = open(fname, "rb")
+    try:
+        return f.read(len(MAGIC)) == MAGIC
+    finally:
+        f.close()
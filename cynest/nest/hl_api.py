@@ -48,11 +48,17 @@ Authors: Jochen Eppler, Marc-Oliver Gewaltig, Moritz Helias, Eilif Mueller
 """
 
 import pyximport
+from cynest import model_cache
 import string
 import types
 import os
 import sys
 
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
 # These variables MUST be set by __init__.py right after importing.
 # There is no safety net, whatsoever.
 nest = sps = spp = sr = None
@@ -66,6 +72,14 @@ pyximport.install()
 sys.path.append(os.getcwd())
 cython_models = []
 
+# models derived from NeuronPopulation and their shared instances,
+# one per (model, thread)
+cython_population_models = []
+cython_populations = {}
+
+# models whose update is called without the GIL
+cython_nogil_models = []
+
 class NESTError(Exception):
     def __init__(self, msg) :
         Exception.__init__(self, msg)
@@ -159,6 +173,20 @@ def flatten(x):
 
 # -------------------- Functions to get information on NEST
 
+def direct_call(fct, *args):
+    """
+    Call one of the direct entry points of the kernel, which bypass
+    the interpreter, and report errors as NESTError.
+    """
+
+    try:
+        return fct(*args)
+    except NESTError:
+        raise
+    except Exception:
+        raise NESTError(str(sys.exc_info()[1]))
+
+
 def sysinfo():
     """
     Print information on the platform on which NEST was compiled.
@@ -244,6 +272,28 @@ def message(level,sender,text):
     sr('message')
 
 
+def get_copy_vectors():
+    """
+    Return True if vector results are copied, see set_copy_vectors().
+    """
+
+    return nest.engine.get_copy_vectors()
+
+
+def set_copy_vectors(copy):
+    """
+    Select how double and integer vectors, e.g. the events of a spike
+    detector, are returned. By default, the returned NumPy arrays
+    share the memory of NEST's result, so that even very large results
+    are returned without copying. If copy is True, every result is
+    copied into a new array instead. Shared arrays that NEST still
+    refers to are read-only; use numpy.array(a) to get a writeable
+    copy of a single result.
+    """
+
+    nest.engine.set_copy_vectors(bool(copy))
+
+
 # -------------------- Functions for simulation control
 
 def Simulate(t):
@@ -251,8 +301,7 @@ def Simulate(t):
     Simulate the network for t milliseconds.
     """
 
-    sps(float(t))
-    sr('ms Simulate')
+    direct_call(nest.engine.simulate, float(t))
 
 
 def ResumeSimulation():
@@ -270,6 +319,7 @@ def ResetKernel():
     function is equivalent to restarting NEST.
     """
 
+    cython_populations.clear()
     sr('ResetKernel')
 
 
@@ -458,30 +508,44 @@ def CopyModel(existing, new, params=None):
 
 # -------------------- Functions for node handling
 
+def PreloadNeurons(model_names):
+    """
+    Compile the given Cython models into the persistent model cache
+    without registering them. Run this once before starting a batch
+    of jobs, so that none of them has to compile a model.
+    """
+
+    if type(model_names) == str:
+        model_names = [model_names]
+
+    for m in model_names:
+        path = model_cache.find_source(m)
+        if path is None:
+            raise NESTError("Cannot find the source of the model " + m + ".")
+        model_cache.build(m, path)
+
+
 def RegisterNeuron(model_name):
     print ("Registering " + model_name + "...")
 
-    if sys.version_info >= (3,0):
-        d = {}
-        exec("import " + model_name, globals(), d)
-        globals()[model_name] = d[model_name]
-        exec(model_name + ".setScheduler(schedulerObj)", globals())
-        exec(model_name + ".setTime(timeObj)", globals())
-        exec(model_name + ".setTic(ticObj)", globals())
-        exec(model_name + ".setStep(stepObj)", globals())
-        exec(model_name + ".setMs(msObj)", globals())
-        exec(model_name + ".setMs_stamp(ms_stampObj)", globals())
-    else:
-        exec("import " + model_name)
-        globals()[model_name] = locals()[model_name]
-        exec(model_name + ".setScheduler(schedulerObj)")
-        exec(model_name + ".setTime(timeObj)")
-        exec(model_name + ".setTic(ticObj)")
-        exec(model_name + ".setStep(stepObj)")
-        exec(model_name + ".setMs(msObj)")
-        exec(model_name + ".setMs_stamp(ms_stampObj)")
+    # compiled models are loaded from the model cache, see model_cache.py
+    module = model_cache.load(model_name)
+    globals()[model_name] = module
+    module.setScheduler(schedulerObj)
+    module.setTime(timeObj)
+    module.setTic(ticObj)
+    module.setStep(stepObj)
+    module.setMs(msObj)
+    module.setMs_stamp(ms_stampObj)
+
+    cls = getattr(module, model_name)
 
     cython_models.append(model_name)
+    if hasattr(cls, "update_block"):
+        cython_population_models.append(model_name)
+    if hasattr(module, "checkUpdateNogil") and module.checkUpdateNogil(cls):
+        cython_nogil_models.append(model_name)
+        print ("Using GIL-free update for " + model_name)
     reg(model_name)
     print ("Registration completed")
 
@@ -497,26 +561,40 @@ def Create(model, n=1, params=None):
     if type(model) != str and type(model) != bytes:
         raise NESTError("UnknownModelName: model should be a string.")
 
-    sps(n)
-    cmd = "/"+model+" exch Create"
+    # The defaults of Cython models only know the parameters that were
+    # set with SetDefaults, so their parameters are set on the nodes.
+    if type(params) == dict and model in cython_models:
+        params = [params]
 
-    if params:
-        if type(params) == dict:
-            sps(params)
-            cmd = "/"+model+" 3 1 roll Create"
-        elif is_sequencetype(params) and (len(params) == 1 or len(params) == n):
-            broadcast_params = True
-        else:
-            sr(";") # pop n from the stack
-            raise NESTError("params has to be a single dictionary or a list of dictionaries with size n.")
-        
-    sr(cmd)
+    if type(params) == dict and params:
+        sps(n)
+        sps(params)
+        sr("/"+model+" 3 1 roll Create")
+        lastgid = spp()
+    else:
+        if params:
+            if is_sequencetype(params) and (len(params) == 1 or len(params) == n):
+                broadcast_params = True
+            else:
+                raise NESTError("params has to be a single dictionary or a list of dictionaries with size n.")
+
+        lastgid = direct_call(nest.engine.create, model, n)
 
-    lastgid = spp()
     ids = list(range(lastgid - n + 1, lastgid + 1))
 
     # have to check if cython model or normal model, then process multiple creations
-    if model in cython_models:
+    if model in cython_population_models:
+        cls = getattr(globals()[model], model)
+        threads = GetStatus(ids, "thread")
+        for i, t in zip(ids, threads):
+            pop = cython_populations.get((model, t))
+            if pop is None:
+                pop = cls()
+                cython_populations[(model, t)] = pop
+            slot = pop.add_member()
+            pop.set_gid(slot, i)
+            SetStatus([i], {"pyobject" : pop, "population_index" : slot})
+    elif model in cython_models:
         if sys.version_info >= (3,0):
             for i in ids:
                 d = {}
@@ -566,12 +644,11 @@ def SetStatus(nodes, params, val=None) :
 
     if  (type(nodes[0]) == dict) or is_sequencetype(nodes[0]):
         nest.engine.push_connections(nodes)
+        sps(params)
+        sr('2 arraystore')
+        sr('Transpose { arrayload ; SetStatus } forall')
     else:
-        sps(nodes)
-
-    sps(params)
-    sr('2 arraystore')
-    sr('Transpose { arrayload ; SetStatus } forall')
+        direct_call(nest.engine.set_status, nodes, params)
 
 
 
@@ -590,6 +667,15 @@ def GetStatus(nodes, keys=None) :
     if len(nodes) == 0:
         return nodes
 
+    if type(keys) == str and len(cython_populations) > 0:
+        values = _get_population_state(nodes, keys)
+        if values is not None:
+            return values.tolist()
+
+    if (type(nodes[0]) != dict and not is_sequencetype(nodes[0])
+        and (not keys or type(keys) == str)):
+        return direct_call(nest.engine.get_status, nodes, keys or None)
+
     cmd='{ GetStatus } Map'
 
     if keys:
@@ -609,6 +695,56 @@ def GetStatus(nodes, keys=None) :
     return spp()
 
 
+def _get_population_state(nodes, key):
+    """
+    Gather the state variable key of the given nodes directly from
+    the state arenas of their populations. Returns None if numpy is
+    missing or any of the nodes does not keep key in an arena.
+    """
+
+    if numpy is None or is_sequencetype(nodes[0]) or type(nodes[0]) == dict:
+        return None
+
+    gids = numpy.asarray(nodes, dtype=numpy.int_)
+    values = numpy.empty(len(gids))
+    found = numpy.zeros(len(gids), dtype=bool)
+
+    for pop in cython_populations.values():
+        if not pop.has_state(key):
+            continue
+
+        # slots are assigned in order of creation, so members are sorted
+        members = pop.get_gids()
+        if len(members) == 0:
+            continue
+
+        pos = numpy.searchsorted(members, gids)
+        pos[pos == len(members)] = 0
+        hit = members[pos] == gids
+        values[hit] = pop.get_state(key)[pos[hit]]
+        found |= hit
+
+    if not found.all():
+        return None
+
+    return values
+
+
+def GetPopulationState(model, key):
+    """
+    Return the state variable key of all local neurons of the given
+    NeuronPopulation model as a list of (gids, values) pairs, one per
+    thread. Both are numpy views on the population's arrays and stay
+    valid until the next Create of the model.
+    """
+
+    if model not in cython_population_models:
+        raise NESTError("%s is not a NeuronPopulation model." % model)
+
+    return [(pop.get_gids(), pop.get_state(key))
+            for (m, t), pop in sorted(cython_populations.items()) if m == model]
+
+
 def GetLID(gid) :
     """
     Return the local id of a node with gid.
@@ -741,10 +877,7 @@ def Connect(pre, post, params=None, delay=None, model="static_synapse"):
 
     # pre post Connect
     if params == None and delay == None:
-        for s,d in zip(pre, post):
-            sps(s)
-            sps(d)
-            sr('/'+model+' Connect')
+        direct_call(nest.engine.connect, pre, post, None, None, model)
 
     # pre post params Connect
     elif params != None and delay == None:
@@ -752,11 +885,7 @@ def Connect(pre, post, params=None, delay=None, model="static_synapse"):
         if len(params) != len(pre):
             raise NESTError("params must be a dict, or list of dicts of length 1 or len(pre).")
 
-        for s,d,p in zip(pre, post, params) :
-            sps(s)
-            sps(d)
-            sps(p)
-            sr('/'+model+' Connect')
+        direct_call(nest.engine.connect, pre, post, params, None, model)
 
     # pre post w d Connect
     elif params != None and delay != None:
@@ -767,12 +896,7 @@ def Connect(pre, post, params=None, delay=None, model="static_synapse"):
         if len(delay) != len(pre):
             raise NESTError("delay must be a float, or list of floats of length 1 or len(pre).")
 
-        for s,d,w,dl in zip(pre, post, params, delay) :
-            sps(s)
-            sps(d)
-            sps(w)
-            sps(dl)
-            sr('/'+model+' Connect')
+        direct_call(nest.engine.connect, pre, post, params, delay, model)
 
     else:
         raise NESTError("Both 'params' and 'delay' have to be given.")
@@ -781,12 +905,12 @@ def Connect(pre, post, params=None, delay=None, model="static_synapse"):
 def ConvergentConnect(pre, post, weight=None, delay=None, model="static_synapse"):
     """
     Connect all neurons in pre to each neuron in post. pre and post
-    have to be lists. If weight is given (as a single float or as list
-    of floats), delay also has to be given as float or as list of
-    floats.
+    have to be lists or numpy arrays. If weight is given (as a single
+    float or as list or array of floats), delay also has to be given
+    as float or as list or array of floats.
     """
     
-    cvc(pre, post, weight, delay, model)
+    direct_call(cvc, pre, post, weight, delay, model)
 
 
 def RandomConvergentConnect(pre, post, n, weight=None, delay=None, model="static_synapse", options=None):
@@ -805,12 +929,12 @@ def RandomConvergentConnect(pre, post, n, weight=None, delay=None, model="static
 def DivergentConnect(pre, post, weight=None, delay=None, model="static_synapse"):
     """
     Connect each neuron in pre to all neurons in post. pre and post
-    have to be lists. If weight is given (as a single float or as list
-    of floats), delay also has to be given as float or as list of
-    floats.
+    have to be lists or numpy arrays. If weight is given (as a single
+    float or as list or array of floats), delay also has to be given
+    as float or as list or array of floats.
     """
 
-    dvc(pre, post, weight, delay, model)
+    direct_call(dvc, pre, post, weight, delay, model)
 
 
 def DataConnect(pre, params=None, model=None, version=1):
@@ -827,6 +951,11 @@ def DataConnect(pre, params=None, model=None, version=1):
     params=None
     model=None
 
+    Variant 3:
+    pre = {'source': [...], 'target': [...], 'weight': [...], 'delay': [...]}
+    params=None
+    model='synapse_model'
+
     Variant 1 of DataConnect connects each neuron in pre to the targets given in params, using synapse type model.
     The dictionary params must contain at least the following keys:
     'target'
@@ -838,10 +967,18 @@ def DataConnect(pre, params=None, model=None, version=1):
         print "pr"
     Variant 2 of DataConnect will connect neurons according to a list of synapse status dictionaries,
     as obtained from GetStatus.
+    Variant 3 of DataConnect creates one connection for each index into the arrays in pre, which
+    must contain the keys 'source', 'target', 'weight' and 'delay' and may contain 'receptor_type'
+    and other parameters of the synapse model. All arrays must have the same length and should be
+    numpy.ndarrays. This is the fastest way to create many connections from data.
     Note: During connection, status dictionary misses will not raise errors, even if
     the kernel property 'dict_miss_is_error' is True.
     """
 
+    if type(pre) == dict:
+        direct_call(nest.engine.data_connect, pre, model or "static_synapse")
+        return
+
     if not is_sequencetype(pre):
         raise NESTError("'pre' must be a list of nodes or connection dictionaries.")
     if params and not is_sequencetype(params):
@@ -0,0 +1,189 @@
+"""
+Persistent cache of compiled Cython neuron models.
+
+Each model source is compiled once into a shared object that is
+stored under a key derived from the contents of the .pyx file, the
+files it includes, and the Python version. Later sessions load the
+shared object directly, so batch jobs that register the same models do
+not pay for Cython and the C compiler again. Cached models can be
+loaded on hosts without Cython.
+
+The cache lives in $CYNEST_MODEL_CACHE, or ~/.cynest/models if that
+is not set. Entries are written atomically and may be shared by
+concurrent jobs.
+"""
+
+import hashlib
+import os
+import re
+import shutil
+import sys
+import tempfile
+
+try:
+    import Cython
+    from Cython.Build import cythonize
+except ImportError:
+    Cython = None
+
+_include_re = re.compile(r'^\s*include\s+[\'"]([^\'"]+)[\'"]', re.M)
+
+
+def cache_dir():
+    """
+    Return the directory of the model cache.
+    """
+
+    d = os.environ.get("CYNEST_MODEL_CACHE")
+    if not d:
+        d = os.path.join(os.path.expanduser("~"), ".cynest", "models")
+    return d
+
+
+def find_source(name):
+    """
+    Return the path of name.pyx on sys.path, or None.
+    """
+
+    for d in sys.path:
+        path = os.path.join(d or os.curdir, name + ".pyx")
+        if os.path.isfile(path):
+            return os.path.abspath(path)
+    return None
+
+
+def source_hash(path):
+    """
+    Return the cache key of a model source. It covers the source, all
+    files it includes, and the Python version. The Cython version is
+    not part of the key, so that hosts without Cython find the entries.
+    """
+
+    h = hashlib.sha1()
+    h.update(sys.version.encode("UTF-8"))
+
+    seen = set()
+    todo = [path]
+    while todo:
+        p = todo.pop()
+        if p in seen:
+            continue
+        seen.add(p)
+
+        f = open(p, "rb")
+        src = f.read()
+        f.close()
+        h.update(src)
+
+        for inc in _include_re.findall(src.decode("UTF-8", "replace")):
+            inc = os.path.join(os.path.dirname(p), inc)
+            if os.path.isfile(inc):
+                todo.append(os.path.abspath(inc))
+
+    return h.hexdigest()
+
+
+def _so_suffix():
+    try:
+        import importlib.machinery
+        return importlib.machinery.EXTENSION_SUFFIXES[0]
+    except ImportError:
+        return ".so"
+
+
+def cached_path(name, path):
+    """
+    Return the location of the compiled model in the cache, whether or
+    not it exists.
+    """
+
+    return os.path.join(cache_dir(), source_hash(path), name + _so_suffix())
+
+
+def build(name, path):
+    """
+    Compile the model source into the cache unless it is there
+    already, and return the path of the shared object.
+    """
+
+    target = cached_path(name, path)
+    if os.path.isfile(target):
+        return target
+
+    if Cython is None:
+        raise ImportError("Cython is needed to compile the model " + name)
+
+    try:
+        from setuptools import Distribution, Extension
+    except ImportError:
+        from distutils.core import Distribution, Extension
+
+    entry = os.path.dirname(target)
+    if not os.path.isdir(entry):
+        try:
+            os.makedirs(entry)
+        except OSError:
+            pass  # created by a concurrent job
+
+    tmp = tempfile.mkdtemp(dir=entry)
+    try:
+        ext = Extension(name, [path])
+        dist = Distribution({"ext_modules" : cythonize([ext], quiet=True, build_dir=tmp,
+                                                       include_path=[os.path.dirname(path)])})
+        cmd = dist.get_command_obj("build_ext")
+        cmd.build_lib = tmp
+        cmd.build_temp = tmp
+        dist.run_command("build_ext")
+
+        # rename is atomic, so other jobs never load a partial file
+        os.rename(cmd.get_ext_fullpath(name), target)
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+    return target
+
+
+def _load_shared(name, so):
+    if sys.version_info >= (3,0):
+        import importlib.util
+        spec = importlib.util.spec_from_file_location(name, so)
+        module = importlib.util.module_from_spec(spec)
+        sys.modules[name] = module
+        spec.loader.exec_module(module)
+        return module
+    else:
+        import imp
+        return imp.load_dynamic(name, so)
+
+
+def load(name):
+    """
+    Return the module of the named model, from the cache if it has an
+    entry for the source, else compiling it into the cache. Falls back
+    to a plain import if the source cannot be found, or if it is not
+    cached and Cython is not available.
+    """
+
+    if name in sys.modules:
+        return sys.modules[name]
+
+    path = find_source(name)
+    if path is None:
+        return __import__(name)
+
+    target = cached_path(name, path)
+    if os.path.isfile(target):
+        return _load_shared(name, target)
+
+    if Cython is None:
+        return __import__(name)
+
+    return _load_shared(name, build(name, path))
+
+
+def clear():
+    """
+    Remove all entries from the model cache.
+    """
+
+    shutil.rmtree(cache_dir(), ignore_errors=True)
@@ -1,4 +1,5 @@
 import cynest as nest
+import cynest.columnar as columnar
 import numpy
 import pylab
 
@@ -59,14 +60,31 @@ def from_file(fname, title=None, hist=False, hist_binwidth=5.0, grayscale=False)
         data = None
         for f in fname:
             if data is None:
-                data = numpy.loadtxt(f)
+                data = _load_file(f)
             else:
-                data = numpy.concatenate((data, numpy.loadtxt(f)))
+                data = numpy.concatenate((data, _load_file(f)))
     else:
-        data = numpy.loadtxt(fname)
+        data = _load_file(fname)
 
     return from_data(data, title, hist, hist_binwidth, grayscale)
 
+def _load_file(fname):
+    """
+    Return the senders and times in a text or columnar file as the
+    first two columns of a matrix
+    """
+
+    if columnar.is_columnar(fname):
+        c = columnar.load(fname)
+        if "time" in c:
+            times = c["time"]
+        else:
+            h = columnar.read_header(fname)["resolution"]
+            times = c["step"] * h - c.get("offset", 0.0)
+        return numpy.column_stack((c["sender"], times))
+
+    return numpy.loadtxt(fname)
+
 def from_device(detec, title=None, hist=False, hist_binwidth=5.0, grayscale=False, plot_lid=False):
     """
     Plot raster from spike detector
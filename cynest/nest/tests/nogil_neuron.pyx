@@ -0,0 +1,32 @@
+include "/home/jonny/Programs/Nest/include/Neuron.pyx"
+
+
+
+cdef class nogil_neuron(Neuron):
+    cdef double V_m
+    cdef double V_th
+
+    def __cinit__(self):
+        self.V_m = 0.0
+        self.V_th = 5.0
+
+    cdef void update_nogil(self) noexcept nogil:
+        self.V_m = self.V_m + 1.0 + self.ex_spikes
+        if self.V_m >= self.V_th:
+            self.spike = 1
+            self.V_m = 0.0
+        else:
+            self.spike = 0
+
+    cpdef getStatus(self):
+        cdef dict d = {}
+
+        d["V_m"] = self.V_m
+        d["V_th"] = self.V_th
+        return d
+
+    cpdef setStatus(self, d):
+        if "V_m" in d:
+            self.V_m = d["V_m"]
+        if "V_th" in d:
+            self.V_th = d["V_th"]
@@ -0,0 +1,22 @@
+include "/home/jonny/Programs/Nest/include/Neuron.pyx"
+
+
+
+cdef class sample_population(NeuronPopulation):
+    state_variables = ("param", "period")
+
+    cpdef long add_member(self):
+        cdef long slot = NeuronPopulation.add_member(self)
+        self.state[self.state_index["param"], slot] = 12
+        return slot
+
+    cpdef update_block(self, long lag_from, long lag_to):
+        cdef double[::1] param = self.state_row("param")
+        cdef double[::1] period = self.state_row("period")
+        cdef long i, lag
+
+        for i in range(self.size):
+            for lag in range(lag_from, lag_to):
+                param[i] += 1
+                if period[i] > 0 and <long>param[i] % <long>period[i] == 0:
+                    self.spike[i, lag] = 1
@@ -32,6 +32,10 @@ import test_threads
 import test_use
 import test_dataconnect
 import test_simulate
+import test_population
+import test_nogil
+import test_model_cache
+import test_columnar
 
 def run():
     test_errors.run()
@@ -47,4 +51,8 @@ def run():
     test_use.run()
     test_dataconnect.run()
     test_simulate.run()
+    test_population.run()
+    test_nogil.run()
+    test_model_cache.run()
+    test_columnar.run()
 
@@ -0,0 +1,102 @@
+#! /usr/bin/env python
+#
+# test_columnar.py
+#
+# This file is part of NEST.
+#
+# Copyright (C) 2004 The NEST Initiative
+#
+# NEST is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# NEST is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+"""
+Tests of columnar recording files
+"""
+
+import unittest
+import cynest as nest
+import cynest.columnar as columnar
+import shutil
+import tempfile
+
+
+class ColumnarTestCase(unittest.TestCase):
+
+    def setUp(self):
+        self.dir = tempfile.mkdtemp()
+        nest.ResetKernel()
+        nest.sr('20 setverbosity')
+        nest.SetKernelStatus({'data_path': self.dir, 'overwrite_files': True})
+
+    def tearDown(self):
+        shutil.rmtree(self.dir, ignore_errors=True)
+
+
+    def test_SpikeDetector(self):
+        """Spikes in a columnar file match the spikes in memory"""
+
+        sg = nest.Create('spike_generator', 1, {'spike_times': [1.0, 2.0, 12.0]})
+        p  = nest.Create('parrot_neuron')
+        sd = nest.Create('spike_detector', 1, {'to_file': True, 'columnar': True,
+                                               'withweight': True})
+        nest.Connect(sg, p)
+        nest.Connect(p, sd, 2.5, 1.0)
+        nest.Simulate(20.0)
+        nest.SetStatus(sd, {'to_file': False})
+
+        fname = nest.GetStatus(sd, 'filenames')[0][0]
+        self.assertTrue(columnar.is_columnar(fname))
+
+        header = columnar.read_header(fname)
+        self.assertEqual([c[0] for c in header['columns']], ['sender', 'time', 'weight'])
+        self.assertEqual(header['gid'], sd[0])
+
+        # one chunk for each time slice with spikes
+        self.assertEqual([c[1] for c in columnar.read_chunks(fname)], [1, 1, 1])
+
+        d = columnar.load(fname)
+        events = nest.GetStatus(sd, 'events')[0]
+        self.assertEqual(list(d['sender']), list(events['senders']))
+        self.assertEqual(list(d['time']), list(events['times']))
+        self.assertEqual(list(d['weight']), [2.5, 2.5, 2.5])
+
+
+    def test_Multimeter(self):
+        """Recorded variables are columns named after the variables"""
+
+        n  = nest.Create('iaf_psc_alpha', 1, {'I_e': 500.0})
+        mm = nest.Create('multimeter', 1, {'record_from': ['V_m'], 'interval': 1.0,
+                                           'withgid': True, 'to_file': True,
+                                           'columnar': True})
+        nest.Connect(mm, n)
+        nest.Simulate(10.0)
+        nest.SetStatus(mm, {'to_file': False})
+
+        d = columnar.load(nest.GetStatus(mm, 'filenames')[0])
+        events = nest.GetStatus(mm, 'events')[0]
+        self.assertEqual(sorted(d.keys()), ['V_m', 'sender', 'time'])
+        self.assertEqual(list(d['time']), list(events['times']))
+        self.assertEqual(list(d['V_m']), list(events['V_m']))
+
+
+def suite():
+    suite = unittest.makeSuite(ColumnarTestCase,'test')
+    return suite
+
+
+def run():
+    runner = unittest.TextTestRunner(verbosity=2)
+    runner.run(suite())
+
+
+if __name__ == "__main__":
+    run()
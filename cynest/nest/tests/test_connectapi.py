@@ -179,6 +179,37 @@ class ConnectAPITestCase(unittest.TestCase):
         self.assertEqual(delays , [1.0,2.0,3.0])
 
 
+    def test_ConnectArrays(self):
+        """Convergent and DivergentConnect with arrays"""
+
+        try:
+            import numpy
+        except ImportError:
+            return # numpy's not required for pynest to work
+
+        nest.ResetKernel()
+        pre  = numpy.array(nest.Create("iaf_neuron", 3), dtype=numpy.int32)
+        post = numpy.array(nest.Create("iaf_neuron", 2))
+
+        nest.ConvergentConnect(pre, post, weight=numpy.array([1.0, 2.0, 3.0]), delay=1.5)
+        connections = nest.FindConnections(list(pre))
+        self.assertEqual(len(connections), 6)
+        self.assertEqual(sorted(nest.GetStatus(connections, "weight")), [1.0, 1.0, 2.0, 2.0, 3.0, 3.0])
+
+        nest.DivergentConnect(post, pre, weight=numpy.array([4.0]), delay=numpy.array([2.0]))
+        connections = nest.FindConnections(list(post))
+        self.assertEqual(len(connections), 6)
+        self.assertEqual(nest.GetStatus(connections, "delay"), [2.0] * 6)
+
+        try:
+            nest.ConvergentConnect(pre, post, weight=[1.0, 2.0], delay=1.0)
+            self.fail() # should not be reached
+        except nest.NESTError:
+            info = sys.exc_info()[1]
+            if not "DimensionMismatch" in info.__str__():
+                self.fail()
+
+
     def test_WrongConnection(self):
         """Wrong Connections"""
 
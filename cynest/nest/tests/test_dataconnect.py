@@ -63,6 +63,55 @@ class DataConnectTestCase(unittest.TestCase):
         target1=[ d['target'] for d in stat1]
         self.assertEqual(target, target1)
 
+    def test_DataConnect3(self):
+        """DataConnect with arrays of sources and targets"""
+
+        try:
+            import numpy
+        except ImportError:
+            return # numpy's not required for cynest to work
+
+        cynest.ResetKernel()
+
+        a=cynest.Create("iaf_neuron", 10)
+        sources=numpy.array([1, 1, 2, 3], dtype=numpy.int32)
+        targets=numpy.array([2, 3, 3, 1])
+        columns={'source': sources, 'target': targets,
+                 'weight': numpy.array([1.0, 2.0, 3.0, 4.0]),
+                 'delay': numpy.array([1.0, 1.5, 2.0, 2.5]),
+                 'Wmax': numpy.array([10.0, 20.0, 30.0, 40.0])}
+        cynest.DataConnect(columns, model="stdp_synapse")
+        conn1=cynest.GetConnections([1, 2, 3])
+        stat1=cynest.GetStatus(conn1)
+        self.assertEqual([(d['source'], d['target'], d['weight'], d['delay'], d['Wmax']) for d in stat1],
+                         [(1, 2, 1.0, 1.0, 10.0), (1, 3, 2.0, 1.5, 20.0),
+                          (2, 3, 3.0, 2.0, 30.0), (3, 1, 4.0, 2.5, 40.0)])
+
+        columns['delay']=numpy.array([1.0, 1.0])
+        self.assertRaises(cynest.NESTError, cynest.DataConnect, columns, None, "stdp_synapse")
+
+    def test_DataConnect3SLI(self):
+        """DataConnect in SLI with arrays of sources and targets"""
+
+        try:
+            import numpy
+        except ImportError:
+            return # numpy's not required for cynest to work
+
+        cynest.ResetKernel()
+
+        a=cynest.Create("iaf_neuron", 10)
+        columns={'source': numpy.array([1.0, 2.0, 3.0]),
+                 'target': numpy.array([2.0, 3.0, 1.0]),
+                 'weight': numpy.array([1.0, 2.0, 3.0]),
+                 'delay': numpy.array([1.0, 1.5, 2.0])}
+        cynest.sps(columns)
+        cynest.sr("/static_synapse DataConnect")
+        conn1=cynest.GetConnections([1, 2, 3])
+        stat1=cynest.GetStatus(conn1)
+        self.assertEqual([(d['source'], d['target'], d['weight'], d['delay']) for d in stat1],
+                         [(1, 2, 1.0, 1.0), (2, 3, 2.0, 1.5), (3, 1, 3.0, 2.0)])
+
     def test_ConvergentConnect(self):
         """ConvergentConnect"""
 
@@ -82,6 +82,15 @@ class EventsTestCase(unittest.TestCase):
         d  = nest.GetStatus(sd,'events')[0]
 
         self.assert_(len(d['times'])>0)
+
+        try:
+            import numpy
+            # the events are handed over without copying, and nobody
+            # else refers to them
+            self.assertFalse(d['times'].flags.owndata)
+            self.assertTrue(d['times'].flags.writeable)
+        except ImportError:
+            pass # numpy's not required for pynest to work
         
 
 
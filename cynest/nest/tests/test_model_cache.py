@@ -0,0 +1,106 @@
+#! /usr/bin/env python
+#
+# test_model_cache.py
+#
+# This file is part of cynest.
+#
+# Copyright (C) 2004 The cynest Initiative
+#
+# cynest is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# cynest is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with cynest.  If not, see <http://www.gnu.org/licenses/>.
+"""
+Model cache tests
+"""
+
+import unittest
+import cynest
+import cynest.model_cache as model_cache
+import os
+import shutil
+import sys
+import tempfile
+
+
+class ModelCacheTestCase(unittest.TestCase):
+
+    def setUp(self):
+        self.old = os.environ.get("CYNEST_MODEL_CACHE")
+        self.dir = tempfile.mkdtemp()
+        os.environ["CYNEST_MODEL_CACHE"] = self.dir
+
+    def tearDown(self):
+        if self.old is None:
+            del os.environ["CYNEST_MODEL_CACHE"]
+        else:
+            os.environ["CYNEST_MODEL_CACHE"] = self.old
+        shutil.rmtree(self.dir, ignore_errors=True)
+
+
+    def test_Hash(self):
+        """Cache key follows the source and its includes"""
+
+        inc = os.path.join(self.dir, "inc.pxi")
+        src = os.path.join(self.dir, "m.pyx")
+        open(inc, "w").write("cdef int a = 1\n")
+        open(src, "w").write('include "inc.pxi"\n')
+
+        h1 = model_cache.source_hash(src)
+        self.assertEqual(h1, model_cache.source_hash(src))
+
+        open(inc, "w").write("cdef int a = 2\n")
+        self.assertNotEqual(h1, model_cache.source_hash(src))
+
+
+    def test_Preload(self):
+        """PreloadNeurons fills the cache"""
+
+        path = model_cache.find_source("sample_neuron")
+        target = model_cache.cached_path("sample_neuron", path)
+        self.assertFalse(os.path.exists(target))
+
+        cynest.PreloadNeurons("sample_neuron")
+        self.assertTrue(os.path.isfile(target))
+
+        # a second preload finds the entry
+        cynest.PreloadNeurons(["sample_neuron"])
+        self.assertEqual(os.listdir(os.path.dirname(target)), [os.path.basename(target)])
+
+
+    def test_LoadWithoutCython(self):
+        """Cached models are loaded without Cython"""
+
+        cynest.PreloadNeurons("sample_neuron")
+        path = model_cache.find_source("sample_neuron")
+        target = model_cache.cached_path("sample_neuron", path)
+
+        cython = model_cache.Cython
+        module = sys.modules.pop("sample_neuron", None)
+        model_cache.Cython = None
+        try:
+            self.assertEqual(model_cache.cached_path("sample_neuron", path), target)
+            loaded = model_cache.load("sample_neuron")
+            self.assertEqual(os.path.abspath(loaded.__file__), os.path.abspath(target))
+        finally:
+            model_cache.Cython = cython
+            if module is not None:
+                sys.modules["sample_neuron"] = module
+
+
+def suite():
+    suite = unittest.makeSuite(ModelCacheTestCase,'test')
+    return suite
+
+
+def run():
+    runner = unittest.TextTestRunner(verbosity=2)
+    runner.run(suite())
@@ -0,0 +1,80 @@
+#! /usr/bin/env python
+#
+# test_nogil.py
+#
+# This file is part of cynest.
+#
+# Copyright (C) 2004 The cynest Initiative
+#
+# cynest is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# cynest is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with cynest.  If not, see <http://www.gnu.org/licenses/>.
+"""
+GIL-free update tests
+"""
+
+import unittest
+import cynest
+
+if "nogil_neuron" not in cynest.Models():
+    cynest.RegisterNeuron("nogil_neuron")
+
+if "sample_neuron" not in cynest.Models():
+    cynest.RegisterNeuron("sample_neuron")
+
+
+class NogilTestCase(unittest.TestCase):
+
+
+    def test_Registration(self):
+        """Only models overriding update_nogil are GIL-free"""
+
+        self.assertTrue("nogil_neuron" in cynest.cython_nogil_models)
+        self.assertFalse("sample_neuron" in cynest.cython_nogil_models)
+
+
+    def test_Simulate(self):
+        """GIL-free update is called every step"""
+
+        cynest.ResetKernel()
+
+        nodes = cynest.Create("nogil_neuron", 2, [{"V_th":100.0}, {"V_th":4.0}])
+        cynest.Simulate(1)
+
+        self.assertEqual(cynest.GetStatus(nodes, "V_m"), [10.0, 2.0])
+
+
+    def test_Threads(self):
+        """GIL-free update on several threads"""
+
+        cynest.ResetKernel()
+        cynest.SetKernelStatus({"local_num_threads":4})
+
+        nodes = cynest.Create("nogil_neuron", 100, {"V_th":4.0})
+        sd = cynest.Create("spike_detector")
+        cynest.ConvergentConnect(nodes, sd)
+        cynest.Simulate(10)
+
+        # every neuron fires every 4 steps, all of them in the same steps
+        n = cynest.GetStatus(sd, "n_events")[0]
+        self.assertTrue(n >= 100 * 20)
+        self.assertEqual(n % 100, 0)
+
+
+def suite():
+    suite = unittest.makeSuite(NogilTestCase,'test')
+    return suite
+
+
+def run():
+    runner = unittest.TextTestRunner(verbosity=2)
+    runner.run(suite())
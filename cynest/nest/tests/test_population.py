@@ -0,0 +1,132 @@
+#! /usr/bin/env python
+#
+# test_population.py
+#
+# This file is part of cynest.
+#
+# Copyright (C) 2004 The cynest Initiative
+#
+# cynest is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# cynest is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with cynest.  If not, see <http://www.gnu.org/licenses/>.
+"""
+NeuronPopulation tests
+"""
+
+import unittest
+import cynest
+
+if "sample_population" not in cynest.Models():
+    cynest.RegisterNeuron("sample_population")
+
+
+class PopulationTestCase(unittest.TestCase):
+
+
+    def test_CreateSimulate(self):
+        """Population members are updated every step"""
+
+        cynest.ResetKernel()
+
+        cynest.SetDefaults("sample_population", {"param":20})
+        nodes = cynest.Create("sample_population", 5)
+        cynest.Simulate(1)
+
+        for s in cynest.GetStatus(nodes):
+            self.assertEqual(s["param"], 30)
+
+
+    def test_MemberStatus(self):
+        """Status of members is kept separately"""
+
+        cynest.ResetKernel()
+
+        nodes = cynest.Create("sample_population", 3)
+        cynest.SetStatus(nodes, [{"param":p} for p in [1, 2, 3]])
+        cynest.Simulate(1)
+
+        self.assertEqual(cynest.GetStatus(nodes, "param"), [11, 12, 13])
+
+
+    def test_Spikes(self):
+        """Spikes of members are delivered"""
+
+        cynest.ResetKernel()
+
+        nodes = cynest.Create("sample_population", 2, [{"param":0, "period":5},
+                                                       {"param":0, "period":0}])
+        sd = cynest.Create("spike_detector")
+        cynest.ConvergentConnect(nodes, sd)
+        cynest.Simulate(4)
+
+        senders = cynest.GetStatus(sd, "events")[0]["senders"]
+        self.assertTrue(len(senders) >= 3)
+        self.assertEqual(set(senders), set([nodes[0]]))
+
+
+    def test_StateViews(self):
+        """State arena is shared with numpy views"""
+
+        cynest.ResetKernel()
+
+        nodes = cynest.Create("sample_population", 20, {"param":0})
+        gids, param = cynest.GetPopulationState("sample_population", "param")[0]
+
+        self.assertEqual(list(gids), list(nodes))
+
+        param[:] = 5
+        cynest.Simulate(1)
+
+        self.assertEqual(list(param), [15] * 20)
+        self.assertEqual(cynest.GetStatus(nodes, "param"), [15] * 20)
+        self.assertEqual(cynest.GetStatus(nodes)[3]["param"], 15)
+
+
+    def test_Threads(self):
+        """One population per thread"""
+
+        cynest.ResetKernel()
+        cynest.SetKernelStatus({"local_num_threads":2})
+
+        nodes = cynest.Create("sample_population", 4, {"param":0})
+        cynest.Simulate(1)
+
+        self.assertEqual(cynest.GetStatus(nodes, "param"), [10, 10, 10, 10])
+
+
+    def test_WorkStealing(self):
+        """Populations are not stolen by other threads"""
+
+        cynest.ResetKernel()
+        cynest.SetKernelStatus({"local_num_threads":4, "work_stealing":True,
+                                "update_chunk_size":1})
+
+        # neurons that may be stolen give the other threads work to steal
+        cynest.Create("iaf_psc_alpha", 40, {"I_e":500.0})
+        nodes = cynest.Create("sample_population", 16, {"param":0, "period":3})
+        sd = cynest.Create("spike_detector")
+        cynest.ConvergentConnect(nodes, sd)
+        cynest.Simulate(20)
+
+        self.assertEqual(cynest.GetStatus(nodes, "param"), [200] * 16)
+        senders = cynest.GetStatus(sd, "events")[0]["senders"]
+        self.assertEqual(set(senders), set(nodes))
+
+
+def suite():
+    suite = unittest.makeSuite(PopulationTestCase,'test')
+    return suite
+
+
+def run():
+    runner = unittest.TextTestRunner(verbosity=2)
+    runner.run(suite())
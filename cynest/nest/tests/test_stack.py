@@ -78,6 +78,72 @@ class StackTestCase(unittest.TestCase):
             pass # numpy's not required for pynest to work
 
 
+    def test_PushBuffer(self):
+        """Buffers are pushed as vectors"""
+
+        import array
+
+        nest.sps(array.array('i', [4, 5, 6]))
+        self.assertEqual(list(nest.spp()), [4, 5, 6])
+
+        nest.sps(array.array('d', [0.5, 1.5]))
+        self.assertEqual(list(nest.spp()), [0.5, 1.5])
+
+        try:
+            import numpy
+            nest.sps(numpy.array([1, 2, 3], dtype=numpy.int32))
+            self.assertEqual(list(nest.spp()), [1, 2, 3])
+            nest.sps(numpy.arange(10.0)[::3])
+            self.assertEqual(list(nest.spp()), [0.0, 3.0, 6.0, 9.0])
+        except ImportError:
+            pass # numpy's not required for pynest to work
+
+
+    def test_PopVectorShared(self):
+        """Popped vectors share NEST's storage unless copying is selected"""
+
+        try:
+            import numpy
+        except ImportError:
+            return # numpy's not required for pynest to work
+
+        nest.ResetKernel()
+        self.assertFalse(nest.get_copy_vectors())
+
+        # the first result is still referenced by the copy on the stack
+        # and must not be writeable from Python
+        nest.sps(numpy.array([1.0, 2.0, 3.0]))
+        nest.sr('dup')
+        a = nest.spp()
+        self.assertFalse(a.flags.owndata)
+        self.assertFalse(a.flags.writeable)
+        self.assertEqual(list(a), [1.0, 2.0, 3.0])
+
+        # once a is gone, the vector belongs to the second result alone
+        del a
+        b = nest.spp()
+        self.assertTrue(b.flags.writeable)
+        self.assertEqual(list(b), [1.0, 2.0, 3.0])
+
+        nest.sps(numpy.array([1, 2, 3], dtype=numpy.int64))
+        a = nest.spp()
+        self.assertEqual(a.dtype, numpy.dtype('l')) # no longer truncated to int
+        self.assertEqual(list(a), [1, 2, 3])
+
+        nest.set_copy_vectors(True)
+        try:
+            nest.sps(numpy.array([1.0, 2.0]))
+            nest.sr('dup')
+            a = nest.spp()
+            b = nest.spp()
+            self.assertTrue(a.flags.owndata)
+            self.assertTrue(a.flags.writeable)
+            a[0] = 3.0
+            self.assertEqual(list(b), [1.0, 2.0])
+        finally:
+            nest.set_copy_vectors(False)
+
+
 def suite():
 
     suite = unittest.makeSuite(StackTestCase,'test')
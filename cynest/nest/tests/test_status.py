@@ -106,6 +106,38 @@ class StatusTestCase(unittest.TestCase):
         self.assertEqual(cynest.GetStatus(n,'V_m')[0], 3.)
 
 
+    def test_SetStatusChangedOnly(self):
+        """SetStatus passes only the changed values"""
+
+        m = "sample_neuron"
+
+        cynest.ResetKernel()
+        n  = cynest.Create(m)
+        cynest.Simulate(1)
+        cynest.SetStatus(n,{'V_m':4.})
+
+        # param is incremented in update and must not be reset
+        self.assertEqual(cynest.GetStatus(n,'param')[0], 22)
+        self.assertEqual(cynest.GetStatus(n,'V_m')[0], 4.)
+
+
+    def test_StatusErrors(self):
+        """Errors of Set/GetStatus"""
+
+        cynest.ResetKernel()
+        n = cynest.Create("iaf_neuron")
+
+        for f, args in ((cynest.GetStatus, (n, 'DUMMY')),
+                        (cynest.SetStatus, (n, {'DUMMY' : 0}))):
+            try:
+                f(*args)
+                self.fail('an error should have risen!')
+            except cynest.NESTError:
+                info = sys.exc_info()[1]
+                if not "DictError" in info.__str__():
+                    self.fail('wrong error message')
+
+
     def test_SetStatusVth_E_L(self):
         """SetStatus of reversal and threshold potential """
 
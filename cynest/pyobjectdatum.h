@@ -21,7 +21,14 @@
 #include "datum.h"
 
 #include <string>
+#include <map>
+#include <set>
+#include <vector>
 #include "dataconverter.h"
+#include "dictdatum.h"
+#include "doubledatum.h"
+#include "integerdatum.h"
+#include "name.h"
 
 #define GET_STATUS_METHOD 1
 #define SET_STATUS_METHOD 2
@@ -33,6 +40,89 @@
 
 
 
+/**
+ * Status schema of a Cython model class.
+ *
+ * Resolves every parameter name that is exchanged with a model class
+ * once into an entry holding the Name, an interned Python key and
+ * whether the name is reserved by the kernel. Status calls then
+ * neither compare strings against the reserved names nor create key
+ * strings for every node. Schemas are kept per Python type for the
+ * whole session and must only be used with the GIL held.
+ */
+class StatusSchema
+{
+public:
+  struct Entry
+  {
+    Name name;
+    PyObject* key;   //!< interned Python string, owned by the schema
+    bool forbidden;  //!< kernel parameter, never passed to the model
+  };
+
+  static StatusSchema& get(PyTypeObject* t)
+  {
+    static std::map<PyTypeObject*, StatusSchema> schemas;
+    return schemas[t];
+  }
+
+  /**
+   * Return the entry for a name, creating it on first use.
+   */
+  const Entry& entry(const Name& n)
+  {
+    std::map<Name, Entry>::iterator it = entries_.find(n);
+    if(it != entries_.end())
+      return it->second;
+
+    Entry e;
+    e.name = n;
+  #if PY_MAJOR_VERSION >= 3
+    e.key = PyUnicode_InternFromString(n.toString().c_str());
+  #else
+    e.key = PyString_InternFromString(n.toString().c_str());
+  #endif
+    e.forbidden = forbidden_().count(n) > 0;
+    return entries_.insert(std::make_pair(n, e)).first->second;
+  }
+
+  /**
+   * Entries reported by the model's getStatus so far.
+   */
+  const std::vector<const Entry*>& reported() const
+  {
+    return reported_;
+  }
+
+  void report(const Entry& e)
+  {
+    for(size_t i = 0; i < reported_.size(); ++i)
+      if(reported_[i] == &e)
+        return;
+    reported_.push_back(&e);
+  }
+
+private:
+  // the cython model shouldn't use or access these parameters
+  static const std::set<Name>& forbidden_()
+  {
+    static std::set<Name> f;
+    if(f.empty()) {
+      const char* names[] = { "archiver_length", "frozen", "global_id", "local",
+                              "local_id", "model", "node_type", "parent", "pyobject",
+                              "recordables", "state", "t_spike", "tau_minus",
+                              "tau_minus_triplet", "thread", "vp", "population_index" };
+      for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+        f.insert(Name(names[i]));
+    }
+    return f;
+  }
+
+  std::map<Name, Entry> entries_;        //!< all names seen, entries are never moved
+  std::vector<const Entry*> reported_;
+};
+
+
 class PyObjectDatum: public Datum
 {
 
@@ -45,60 +135,73 @@ private:
   long* spike;
   double* current_value;
   
-  int forbiddenParamsLength;
-  std::string forbiddenParams[16];
+  // slot of the node in a NeuronPopulation, -1 for single neurons
+  long member_;
 
   PyCFunction updateFct;
 
+  // GIL-free update of the model, 0 if the model has none
+  typedef void (*UpdateNogilFct)(PyObject*);
+  UpdateNogilFct updateNogilFct;
+
 
 
+// Newer Cython versions do not list cpdef methods in tp_methods, in
+// which case update is called by name.
 struct PyMethodDef* getUpdateRef(struct PyMethodDef *tp_methods) {
-	int i = 0;
-	while(&(tp_methods[i]) != NULL) {
-		if(std::string("update").compare(tp_methods[i].ml_name) == 0) {
+	for(int i = 0; tp_methods != NULL && tp_methods[i].ml_name != NULL; i++) {
+		if(std::string("update").compare(tp_methods[i].ml_name) == 0
+		   && tp_methods[i].ml_flags == METH_NOARGS) {
 			return &(tp_methods[i]);
 		}
-		i++;
 	}
 	return NULL;
 }
 
 
-bool isOK(std::string method)
-{	
-	for(int i = 0; i < forbiddenParamsLength; i++) {
-		if(method.compare(forbiddenParams[i]) == 0) {
-			return false;
-		}
-	}
-	
-	return true;
-}
-
 void init() {
 	  currents = NULL;
 	  in_spikes = NULL;
 	  ex_spikes = NULL;
 	  t_lag = NULL;
 	  spike = NULL;
-	  // the cython model shouldn't use or access these parameters
-	  forbiddenParamsLength = 16;
-	  forbiddenParams[0] = "archiver_length";
-	  forbiddenParams[1] = "frozen";
-	  forbiddenParams[2] = "global_id";
-	  forbiddenParams[3] = "local";
-	  forbiddenParams[4] = "local_id";
-	  forbiddenParams[5] = "model";
-	  forbiddenParams[6] = "node_type";
-	  forbiddenParams[7] = "parent";
-	  forbiddenParams[8] = "pyobject";
-	  forbiddenParams[9] = "recordables";
-	  forbiddenParams[10] = "state";
-	  forbiddenParams[11] = "t_spike";
-	  forbiddenParams[12] = "tau_minus";
-	  forbiddenParams[13] = "tau_minus_triplet";
-	  forbiddenParams[14] = "thread";
-	  forbiddenParams[15] = "vp";
+	  updateFct = NULL;
+	  updateNogilFct = NULL;
+	  member_ = -1;
+}
+
+// Doubles and integers are converted directly, everything else
+// goes through the DataConverter.
+PyObject* to_object_(Datum* d) {
+	DoubleDatum* dd = dynamic_cast<DoubleDatum*>(d);
+	if(dd != NULL)
+		return PyFloat_FromDouble(dd->get());
+
+	IntegerDatum* id = dynamic_cast<IntegerDatum*>(d);
+	if(id != NULL)
+		return PyInt_FromLong(id->get());
+
+	PyObjectDatum* pd = dynamic_cast<PyObjectDatum*>(d);
+	if(pd != NULL) {
+		Py_XINCREF(pd->pyObj);
+		return pd->pyObj;
+	}
+
+	return dataConverter.datumToObject(d);
+}
+
+void put_value_(DictionaryDatum& d, const Name& n, PyObject* value) {
+	if(PyFloat_CheckExact(value))
+		(*d)[n] = PyFloat_AS_DOUBLE(value);
+#if PY_MAJOR_VERSION >= 3
+	else if(PyLong_CheckExact(value))
+		(*d)[n] = PyLong_AsLong(value);
+#else
+	else if(PyInt_CheckExact(value))
+		(*d)[n] = PyInt_AsLong(value);
+#endif
+	else
+		(*d)[n] = dataConverter.objectToDatum(value);
 }
 
 public:
@@ -122,6 +225,18 @@ public:
         return new PyObjectDatum(*this);
   }
 
+PyObject* get_pyobject() const {
+	return pyObj;
+}
+
+/**
+ * Address the status methods to one member of a NeuronPopulation.
+ * getStatus and setStatus are then called with the slot as first argument.
+ */
+void set_member(long m) {
+	member_ = m;
+}
+
 void putStdParams(double** curr, double** is, double** es, long** tl, long** sp, double** cv) {
 	// important, otherwise segmentation fault
 	PyGILState_STATE s = PyGILState_Ensure();
@@ -140,9 +255,33 @@ void putStdParams(double** curr, double** is, double** es, long** tl, long** sp,
 		this->updateFct = updateRef->ml_meth;
 	}
 
+	// and the address of the nogil update, if the model provides one
+	this->updateNogilFct = reinterpret_cast<UpdateNogilFct>(get_address("getPUpdate_Nogil"));
+
 	PyGILState_Release(s);
 }
 
+/**
+ * Call a getP* method of the model and return the address it reports.
+ * Returns 0 if the method does not exist, e.g. for models built
+ * against an older Neuron.pyx. The GIL must be held.
+ */
+long get_address(const char* method) {
+	PyObject* a = PyObject_CallMethod(this->pyObj, method, NULL);
+	if(a == NULL) {
+		PyErr_Clear();
+		return 0;
+	}
+
+	long addr = PyInt_AsLong(a);
+	Py_DECREF(a);
+	return addr;
+}
+
+bool has_update_nogil() const {
+	return updateNogilFct != NULL;
+}
+
 void call_method(std::string cmd) {
 	// important, otherwise segmentation fault
 	PyGILState_STATE s = PyGILState_Ensure();
@@ -156,77 +295,138 @@ void call_update() {
 	// important, otherwise segmentation fault
 	PyGILState_STATE s = PyGILState_Ensure();
 	
-	updateFct(this->pyObj, NULL);
+	if(updateFct != NULL)
+		updateFct(this->pyObj, NULL);
+	else
+		Py_XDECREF(PyObject_CallMethod(this->pyObj, "update", NULL));
 
     PyGILState_Release(s);
 }
 
+void call_update_nogil() {
+	// checked at registration, see Neuron.update_nogil
+	updateNogilFct(this->pyObj);
+}
+
 void call_update_optimized() {
 	// without the GIL the function is faster and, much more
 	// important, the multithreading is not affected
-	updateFct(this->pyObj, NULL);
+	if(updateFct != NULL)
+		updateFct(this->pyObj, NULL);
+	else
+		call_update();
 }
 
 
 
 void call_status_method(int m, void* status_) {
+	DictionaryDatum* status = static_cast<DictionaryDatum*>(status_);
+
+	if(m == SET_STATUS_METHOD)
+		set_status(*status);
+	else if(m == GET_STATUS_METHOD)
+		get_status(*status);
+}
+
+/**
+ * Pass the model parameters among the entries of d to the model's
+ * setStatus. Only the given entries are converted, so callers should
+ * pass the changed values rather than the node's whole state.
+ * Returns false if setStatus raised; the Python error is then left
+ * set for the caller.
+ */
+bool set_status(const DictionaryDatum& d) {
 	// important, otherwise segmentation fault
 	PyGILState_STATE s = PyGILState_Ensure();
-	DictionaryDatum* status = static_cast<DictionaryDatum*>(status_);
-	
-	if(m == SET_STATUS_METHOD) {
-		// creation of an empty python dictionary
-		PyObject* dict = PyDict_New();
-
-		// filling the dictionary
-		for(Dictionary::iterator it = (*status)->begin(); it != (*status)->end(); ++it) {
-			// if the status_ element is not forbidden (is actually one of the model parameters), it is copied
-			if(isOK(it->first.toString()) == true) {
-			#if PY_MAJOR_VERSION >= 3
-				PyObject_SetItem(dict, PyUnicode_FromString(it->first.toString().c_str()), dataConverter.datumToObject( (**status)[it->first.toString()].datum()));
-			#else
-				PyObject_SetItem(dict, PyString_FromString(it->first.toString().c_str()), dataConverter.datumToObject( (**status)[it->first.toString()].datum()));				
-			#endif
+	StatusSchema& schema = StatusSchema::get(Py_TYPE(this->pyObj));
+
+	// creation of an empty python dictionary
+	PyObject* dict = PyDict_New();
+
+	// filling the dictionary
+	for(Dictionary::const_iterator it = d->begin(); it != d->end(); ++it) {
+		const StatusSchema::Entry& e = schema.entry(it->first);
+		// if the element is not forbidden (is actually one of the model parameters), it is copied
+		if(not e.forbidden) {
+			PyObject* value = to_object_(it->second.datum());
+			if(value == NULL) {
+				PyErr_Clear();
+				continue;
 			}
+			PyDict_SetItem(dict, e.key, value);
+			Py_DECREF(value);
 		}
-		
-		// after the python dict has been filled, we can call the method
-		#if PY_MAJOR_VERSION >= 3
-			PyObject_CallMethodObjArgs(this->pyObj, PyUnicode_FromString("setStatus"), dict, NULL);
-		#else
-			PyObject_CallMethodObjArgs(this->pyObj, PyString_FromString("setStatus"), dict, NULL);
-		#endif
-                Py_XDECREF(dict);
 	}
-	else if(m == GET_STATUS_METHOD) {
-		PyObject* dict = PyObject_CallMethod(this->pyObj, "getStatus", NULL);
-		PyObject* subPyObj=0;
-		PyObject *key=0;
+
+	// after the python dict has been filled, we can call the method
+	PyObject* result = (member_ >= 0) ? PyObject_CallMethod(this->pyObj, "setStatus", "lO", member_, dict)
+	                                  : PyObject_CallMethod(this->pyObj, "setStatus", "O", dict);
+
+	Py_XDECREF(result);
+	Py_XDECREF(dict);
+	PyGILState_Release(s);
+	return result != NULL;
+}
+
+/**
+ * Store the values returned by the model's getStatus in d.
+ */
+void get_status(DictionaryDatum& d) {
+	// important, otherwise segmentation fault
+	PyGILState_STATE s = PyGILState_Ensure();
+	StatusSchema& schema = StatusSchema::get(Py_TYPE(this->pyObj));
+
+	PyObject* dict = (member_ >= 0) ? PyObject_CallMethod(this->pyObj, "getStatus", "l", member_)
+	                                : PyObject_CallMethod(this->pyObj, "getStatus", NULL);
+	if(dict == NULL || not PyDict_Check(dict)) {
+		PyErr_Clear();
+		Py_XDECREF(dict);
+		PyGILState_Release(s);
+		return;
+	}
+
+	// look up the parameters the model is known to report
+	const std::vector<const StatusSchema::Entry*>& reported = schema.reported();
+	Py_ssize_t found = 0;
+	for(size_t i = 0; i < reported.size(); ++i) {
+		PyObject* value = PyDict_GetItem(dict, reported[i]->key);
+		if(value != NULL) {
+			put_value_(d, reported[i]->name, value);
+			++found;
+		}
+	}
+
+	// the dictionary holds names not seen before, resolve them
+	if(found < PyDict_Size(dict)) {
+		PyObject* key = 0;
+		PyObject* value = 0;
 		Py_ssize_t pos = 0;
 
 		// looping through the received python dictionary
-		while (PyDict_Next(dict, &pos, &key, &subPyObj)) 
+		while (PyDict_Next(dict, &pos, &key, &value)) 
 		{
 		#if PY_MAJOR_VERSION >= 3
 			PyObject* pStrObj = PyUnicode_AsUTF8String(key); 
-			char* zStr = PyBytes_AsString(pStrObj); 
+			const StatusSchema::Entry& e = schema.entry(Name(PyBytes_AsString(pStrObj)));
 			Py_DECREF(pStrObj);
-			(**status)[zStr] = dataConverter.objectToDatum(subPyObj);
 		#else
-			(**status)[PyString_AsString(key)] = dataConverter.objectToDatum(subPyObj);
+			const StatusSchema::Entry& e = schema.entry(Name(PyString_AsString(key)));
 		#endif
+			schema.report(e);
+			put_value_(d, e.name, value);
 		}
+	}
 
-		Py_XDECREF(dict);
-		// the std params also have to be updated
-		if(currents != NULL && in_spikes != NULL && ex_spikes != NULL && t_lag != NULL && spike != NULL) {
-			(**status)["currents"] = *currents;
-			(**status)["in_spikes"] = *in_spikes;
-			(**status)["ex_spikes"] = *ex_spikes;
-			(**status)["t_lag"] = *t_lag;
-			(**status)["spike"] = *spike;
-			(**status)["current_value"] = *current_value;
-		}
+	Py_XDECREF(dict);
+
+	// the std params also have to be updated
+	if(currents != NULL && in_spikes != NULL && ex_spikes != NULL && t_lag != NULL && spike != NULL) {
+		(*d)["currents"] = *currents;
+		(*d)["in_spikes"] = *in_spikes;
+		(*d)["ex_spikes"] = *ex_spikes;
+		(*d)["t_lag"] = *t_lag;
+		(*d)["spike"] = *spike;
+		(*d)["current_value"] = *current_value;
 	}
 	PyGILState_Release(s);
 }
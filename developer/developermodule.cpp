@@ -345,6 +345,10 @@ BeginDocumentation
        throw UnknownSynapseType(synmodel_name.toString());
      const index synmodel_id = static_cast<index>(synmodel);
 
+     // the distribution of the targets is derived from their gids
+     if ( !get_network().round_robin_placement() )
+       throw KernelException("RandomPopulationConnectD requires the round-robin placement of nodes.");
+
      int_t M = Communicator::get_num_virtual_processes();
      int_t proc = Communicator::get_rank();
 
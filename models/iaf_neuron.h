@@ -141,6 +141,8 @@ SeeAlso: iaf_psc_alpha, testsuite::test_iaf
     using Node::connect_sender;
     using Node::handle;
 
+    bool supports_stealing() const {return true;}
+
     port check_connection(Connection&, port);
     
     void handle(SpikeEvent &);
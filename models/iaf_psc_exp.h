@@ -139,6 +139,8 @@ namespace nest
     using Node::connect_sender;
     using Node::handle;
 
+    bool supports_stealing() const {return true;}
+
     port check_connection(Connection&, port);
     
     void handle(SpikeEvent &);
@@ -90,6 +90,7 @@
 // Generic (template) implementations for synapse prototypes
 #include "generic_connector_model.h"
 #include "generic_connector.h"
+#include "compact_connector.h"
 
 // Prototypes for synapses
 
@@ -214,6 +215,9 @@ namespace nest
                                                             CommonPropertiesHomWD
                                                           > (net_, "static_synapse_hom_wd");
 
+    // static connection with weight, delay, rport, target in a compact, target-sorted store
+    register_prototype_connection_compact<StaticConnection>(net_, "static_synapse_compact");
+
     register_prototype_connection<ContDelayConnection>(net_, "cont_delay_synapse");
     register_prototype_connection<TsodyksConnection>(net_,   "tsodyks_synapse");
     register_prototype_connection<Tsodyks2Connection>(net_,   "tsodyks2_synapse");
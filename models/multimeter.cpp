@@ -22,6 +22,9 @@
 
 #include "multimeter.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace nest
 {
   Multimeter::Multimeter()
@@ -44,29 +47,38 @@ namespace nest
 
   port Multimeter::check_connection(Connection& c, port receptor_type)  
   { 
-    DataLoggingRequest e(P_.interval_, P_.record_from_);
+    // in block mode, the target writes to the next column of the block
+    DataLoggingRequest e = P_.to_block_
+      ? DataLoggingRequest(P_.interval_, P_.record_from_,
+                           B_.block_, B_.block_.get_num_nodes())
+      : DataLoggingRequest(P_.interval_, P_.record_from_);
     e.set_sender(*this);
     c.check_event(e);
     port p = c.get_target()->connect_sender(e, receptor_type);
     // no throw so far, so we have connection
     B_.has_targets_ = true;
+    if ( P_.to_block_ )
+      B_.block_.add_node(c.get_target()->get_gid(), P_.record_from_.size());
     return p;
   }
   
   nest::Multimeter::Parameters_::Parameters_()
     : interval_(Time::ms(1.0)),
-      record_from_()
+      record_from_(),
+      to_block_(false)
   {}
   
   nest::Multimeter::Parameters_::Parameters_(const Parameters_& p)
     : interval_(p.interval_),
-      record_from_(p.record_from_)
+      record_from_(p.record_from_),
+      to_block_(p.to_block_)
   {
     interval_.calibrate();
   }
 
   nest::Multimeter::Buffers_::Buffers_()
-    : has_targets_(false)
+    : has_targets_(false),
+      block_()
   {
   }
 
@@ -77,14 +89,16 @@ namespace nest
     for ( size_t j = 0 ; j < record_from_.size() ; ++j )
       ad.push_back(LiteralDatum(record_from_[j]));
     (*d)[names::record_from] = ad;
+    (*d)[names::to_block] = to_block_;
   }  
 
   void nest::Multimeter::Parameters_::set(const DictionaryDatum &d, const Buffers_& b)
   {
-    if ( b.has_targets_ && ( d->known(names::interval) || d->known(names::record_from) ) )
-      throw BadProperty("The recording interval and the list of properties to record "
-			"cannot be changed after the multimeter has been connected to "
-			"nodes.");
+    if ( b.has_targets_ && ( d->known(names::interval) || d->known(names::record_from)
+                             || d->known(names::to_block) ) )
+      throw BadProperty("The recording interval, the list of properties to record "
+			"and block mode cannot be changed after the multimeter has "
+			"been connected to nodes.");
 
     double_t v;
     if ( updateValue<double_t>(d, names::interval, v) )
@@ -110,6 +124,8 @@ namespace nest
       for ( Token* t = ad.begin() ; t != ad.end() ; ++t )
 	record_from_.push_back(Name(getValue<std::string>(*t)));
     }  
+
+    updateValue<bool>(d, names::to_block, to_block_);
   }
 
   void Multimeter::init_state_(const Node& np)
@@ -117,6 +133,7 @@ namespace nest
     const Multimeter& asd = dynamic_cast<const Multimeter&>(np);
     device_.init_state(asd.device_);
     S_.data_.clear();
+    B_.block_.clear();
   }
 
   void Multimeter::init_buffers_()
@@ -126,9 +143,34 @@ namespace nest
   
   void Multimeter::calibrate()
   {
+    // name the value columns of columnar files
+    std::vector<std::string> names;
+    for ( size_t j = 0 ; j < P_.record_from_.size() ; ++j )
+      names.push_back(P_.record_from_[j].toString());
+    device_.set_value_names(names);
+
     device_.calibrate();
     V_.new_request_ = false;
     V_.current_request_data_start_ = 0;
+
+    if ( P_.to_block_ )
+    {
+      // add rows for all recording times of this simulation, i.e.,
+      // multiples of the interval with t_min < T <= t_max
+      const long_t interval = P_.interval_.get_steps();
+      const long_t now = network()->get_time().get_steps();
+      const long_t end = now + network()->get_to_do();
+      const long_t t_min = std::max(now, device_.get_t_min_());
+      const long_t t_max = std::min(end, device_.get_t_max_());
+
+      // the whole window is known if the device stops
+      const long_t max_step =
+        Time(Time::step(device_.get_t_max_())).is_finite()
+        ? device_.get_t_max_() / interval * interval : -1;
+
+      B_.block_.extend(( t_min / interval + 1 ) * interval,
+                       t_max / interval * interval, interval, max_step);
+    }
   }
 
   void Multimeter::finalize()
@@ -146,6 +188,10 @@ namespace nest
     if ( origin.get_steps() == 0 || from != 0 )
       return;
 
+    // in block mode, the nodes write their data directly to the block
+    if ( P_.to_block_ )
+      return;
+
     // We send a request to each of our targets.
     // The target then immediately returns a DataLoggingReply event,
     // which is caught by multimeter::handle(), which in turn
@@ -251,6 +297,58 @@ namespace nest
       }
   }
 
+  void Multimeter::add_block_(DictionaryDatum& d) const
+  {
+    // collect the blocks of all threads
+    std::vector<const DataBlock*> blocks;
+    const SiblingContainer* siblings = network()->get_thread_siblings(get_gid());
+    for ( std::vector<Node*>::const_iterator sibling = siblings->begin() ;
+          sibling != siblings->end() ; ++sibling )
+      blocks.push_back(&dynamic_cast<const Multimeter*>(*sibling)->B_.block_);
+
+    // all threads record at the same times
+    const size_t n_times = blocks[0]->get_num_times();
+    const size_t n_vars = P_.record_from_.size();
+
+    // sort the nodes of all threads by GID, as (gid, (block, column))
+    std::vector<std::pair<index, std::pair<size_t, size_t> > > nodes;
+    for ( size_t b = 0 ; b < blocks.size() ; ++b )
+    {
+      assert(blocks[b]->get_num_times() == n_times);
+      const std::vector<index>& gids = blocks[b]->get_gids();
+      for ( size_t c = 0 ; c < gids.size() ; ++c )
+        nodes.push_back(std::make_pair(gids[c], std::make_pair(b, c)));
+    }
+    std::sort(nodes.begin(), nodes.end());
+
+    // the datums take ownership of the vectors, so fill them in place
+    std::vector<double_t>* times = new std::vector<double_t>(n_times);
+    std::vector<long_t>* senders = new std::vector<long_t>(nodes.size());
+    std::vector<double_t>* data = new std::vector<double_t>(n_times * nodes.size() * n_vars);
+
+    DictionaryDatum dd(new Dictionary);
+    (*dd)[names::times] = DoubleVectorDatum(times);
+    (*dd)[names::senders] = IntVectorDatum(senders);
+    (*dd)[names::data] = DoubleVectorDatum(data);
+
+    for ( size_t n = 0 ; n < nodes.size() ; ++n )
+      (*senders)[n] = nodes[n].first;
+
+    std::vector<double_t>::iterator dest = data->begin();
+    for ( size_t t = 0 ; t < n_times ; ++t )
+    {
+      (*times)[t] = Time(Time::step(blocks[0]->get_step(t))).get_ms();
+      for ( size_t n = 0 ; n < nodes.size() ; ++n )
+      {
+        const DataBlock& block = *blocks[nodes[n].second.first];
+        const double_t* src = block.get_row(t) + nodes[n].second.second * n_vars;
+        dest = std::copy(src, src + n_vars, dest);
+      }
+    }
+
+    (*d)[names::block] = dd;
+  }
+
   bool Multimeter::is_active(Time const & T) const
   {
     const long_t stamp = T.get_steps();
@@ -32,6 +32,7 @@
 #include "dictutils.h"
 #include "exceptions.h"
 #include "sibling_container.h"
+#include "data_block.h"
 
 /*BeginDocumentation
 Name: multimeter - Device to record analog data from neurons.
@@ -69,6 +70,27 @@ to memory, to screen, with GID or with weight. You must activate accumulator mod
 before simulating. Accumulator data is never written to file. You must extract it
 from the device using GetStatus.
 
+Block mode:
+When recording many variables from many nodes, the multimeter can record
+into a single block of memory instead. To activate block mode, set /to_block
+to true before connecting the multimeter to any node. Before each call to
+Simulate, the multimeter then allocates the rows for all recording times of
+the simulation at once, or for all recording times up to /stop if it is
+finite, and the nodes write their data directly into the block in every
+step. The block is returned in the /block entry of the status dictionary:
+
+  /times    - recording times in ms, one per row
+  /senders  - GIDs of the recorded nodes, in increasing order
+  /data     - all data as one vector in the order time, node, variable,
+              i.e., the value of variable v of node n at time t is at
+              index (t * N + n) * V + v, with N nodes and V variables
+              in /record_from
+
+Entries that were not recorded, e.g. from frozen nodes, hold the largest
+double value. In block mode, no data are recorded to memory, file, screen or
+the accumulator, and /n_events remains 0. Setting /n_events to 0 clears the
+block.
+
 Note:
  - The set of variables to record and the recording interval must be set
    BEFORE the multimeter is connected to any node, and cannot be changed
@@ -85,6 +107,7 @@ Parameters:
      record_from  array  - Array containing the names of variables to record
                            from, obtained from the /recordables entry of the
                            model from which one wants to record
+     to_block     bool   - Record into a block of memory, see above
   
 Examples:
 SLI ] /iaf_cond_alpha Create /n Set
@@ -223,6 +246,13 @@ namespace nest {
      */
     void add_data_(DictionaryDatum&) const;
 
+    /**
+     * Add the blocks of all threads to the dictionary, merged into one
+     * block with the nodes sorted by GID.
+     * @param d properties dictionary
+     */
+    void add_block_(DictionaryDatum&) const;
+
     // ------------------------------------------------------------
 
     RecordingDevice device_;
@@ -234,6 +264,7 @@ namespace nest {
     struct Parameters_ {
       Time interval_;                 //!< recording interval, in ms
       std::vector<Name> record_from_; //!< which data to record
+      bool to_block_;                 //!< record to B_.block_
       
       Parameters_();
       Parameters_(const Parameters_&);
@@ -267,6 +298,11 @@ namespace nest {
       Buffers_();
 
       bool has_targets_;
+
+      /**
+       * Data recorded in block mode from the targets on this thread.
+       */
+      DataBlock block_;
     };
 
     // ------------------------------------------------------------
@@ -316,6 +352,9 @@ namespace nest {
       std::vector<Node*>::const_iterator sibling;
       for (sibling = siblings->begin() + 1; sibling != siblings->end(); ++sibling)
         (*sibling)->get_status(d);
+
+      if ( P_.to_block_ )
+        add_block_(d);
     }
 
     P_.get(d);
@@ -334,7 +373,16 @@ namespace nest {
     
     // Set properties in device. As a side effect, this will clear data_,
     // if /clear_events set in d
-    device_.set_status(d, S_.data_);
+    if ( !ptmp.to_block_ )
+      device_.set_status(d, S_.data_);
+    else
+    {
+      // no events are counted in block mode, so only an explicit
+      // /n_events 0 clears the block
+      device_.set_status(d);
+      if ( d->known(names::n_events) )
+        B_.block_.clear();
+    }
 
     P_ = ptmp;
   }
@@ -32,7 +32,9 @@
  * ---------------------------------------------------------------- */
 
 nest::poisson_generator::Parameters_::Parameters_()
-  : rate_(0.0    )  // pA
+  : rate_(0.0    ),  // pA
+    batch_(false),
+    batch_identical_(false)
 {}
 
 
@@ -43,6 +45,8 @@ nest::poisson_generator::Parameters_::Parameters_()
 void nest::poisson_generator::Parameters_::get(DictionaryDatum &d) const
 {
   def<double>(d, names::rate, rate_);
+  def<bool>(d, names::batch, batch_);
+  def<bool>(d, names::batch_identical, batch_identical_);
 }
 
 void nest::poisson_generator::Parameters_::set(const DictionaryDatum& d)
@@ -50,6 +54,9 @@ void nest::poisson_generator::Parameters_::set(const DictionaryDatum& d)
   updateValue<double>(d, names::rate, rate_);
   if ( rate_ < 0 )
     throw BadProperty("The rate cannot be negative.");
+
+  updateValue<bool>(d, names::batch, batch_);
+  updateValue<bool>(d, names::batch_identical, batch_identical_);
 }
 
 
@@ -60,13 +67,15 @@ void nest::poisson_generator::Parameters_::set(const DictionaryDatum& d)
 nest::poisson_generator::poisson_generator()
   : Node(),
     device_(),
-    P_()
+    P_(),
+    B_()
 {}
 
 nest::poisson_generator::poisson_generator(const poisson_generator& n)
   : Node(n),
     device_(n.device_),
-    P_(n.P_)
+    P_(n.P_),
+    B_()
 {}
 
 
@@ -84,6 +93,9 @@ void nest::poisson_generator::init_state_(const Node& proto)
 void nest::poisson_generator::init_buffers_()
 {
   device_.init_buffers();
+  B_.counts_.clear();
+  B_.next_ = 0;
+  B_.end_ = 0;
 }
 
 void nest::poisson_generator::calibrate()
@@ -91,7 +103,12 @@ void nest::poisson_generator::calibrate()
   device_.calibrate();
 
   // rate_ is in Hz, dt in ms, so we have to convert from s to ms
-  V_.poisson_dev_.set_lambda(Time::get_resolution().get_ms() * P_.rate_ * 1e-3);
+  V_.lambda_ = Time::get_resolution().get_ms() * P_.rate_ * 1e-3;
+  V_.poisson_dev_.set_lambda(V_.lambda_);
+
+  V_.n_targets_ = 0;
+  V_.scatter_ = !P_.batch_identical_ && V_.lambda_ < 1.0;
+  V_.batch_dev_.set_lambda(0.0);
 }
 
 
@@ -107,6 +124,12 @@ void nest::poisson_generator::update(Time const & T, const long_t from, const lo
   if ( P_.rate_ <= 0 )
     return;
 
+  if ( P_.batch_ )
+  {
+    update_batch_(T, from, to);
+    return;
+  }
+
   for ( long_t lag = from ; lag < to ; ++lag )
   {
     if ( !device_.is_active( T + Time::step(lag) ) )
@@ -117,8 +140,71 @@ void nest::poisson_generator::update(Time const & T, const long_t from, const lo
   }
 }
 
+void nest::poisson_generator::update_batch_(Time const & T, const long_t from, const long_t to)
+{
+  // count the targets in every slice, so that the counts match the
+  // targets even if connections were added since calibrate()
+  const size_t n_targets = network()->get_num_local_connections(*this);
+  if ( n_targets == 0 )
+    return;
+
+  if ( V_.scatter_ && n_targets != V_.n_targets_ )
+    V_.batch_dev_.set_lambda(V_.lambda_ * n_targets);
+  V_.n_targets_ = n_targets;
+
+  std::vector<long_t> lags;
+  for ( long_t lag = from ; lag < to ; ++lag )
+    if ( device_.is_active( T + Time::step(lag) ) )
+      lags.push_back(lag);
+
+  if ( lags.empty() )
+    return;
+
+  // draw all spike counts of the slice, step by step and target by
+  // target, which is the order in which event_hook() would draw them
+  librandom::RngPtr rng = net_->get_rng(get_thread());
+  if ( !V_.scatter_ )
+  {
+    B_.counts_.resize(lags.size() * n_targets);
+    for ( std::vector<ulong_t>::iterator it = B_.counts_.begin() ; it != B_.counts_.end() ; ++it )
+      *it = V_.poisson_dev_.uldev(rng);
+  }
+  else
+  {
+    B_.counts_.assign(lags.size() * n_targets, 0);
+    for ( size_t k = 0 ; k < lags.size() ; ++k )
+    {
+      ulong_t* const counts = &B_.counts_[k * n_targets];
+      for ( ulong_t n_spikes = V_.batch_dev_.uldev(rng) ; n_spikes > 0 ; --n_spikes )
+        ++counts[rng->ulrand(n_targets)];
+    }
+  }
+
+  for ( size_t k = 0 ; k < lags.size() ; ++k )
+  {
+    B_.next_ = k * n_targets;
+    B_.end_ = B_.next_ + n_targets;
+    DSSpikeEvent se;
+    network()->send(*this, se, lags[k]);
+  }
+}
+
 void nest::poisson_generator::event_hook(DSSpikeEvent& e)
 {
+  if ( P_.batch_ )
+  {
+    if ( B_.next_ >= B_.end_ )
+      throw KernelException("poisson_generator: more targets than spike counts in batch mode.");
+
+    const ulong_t n_spikes = B_.counts_[B_.next_++];
+    if ( n_spikes > 0 )
+    {
+      e.set_multiplicity(n_spikes);
+      e.get_receiver().handle(e);
+    }
+    return;
+  }
+
   librandom::RngPtr rng = net_->get_rng(get_thread());
   ulong_t n_spikes = V_.poisson_dev_.uldev(rng);
 
@@ -59,6 +59,11 @@ Parameters:
    origin   double - Time origin for device timer in ms
    start    double - begin of device application with resp. to origin in ms
    stop     double - end of device application with resp. to origin in ms
+   batch    bool   - draw the spike counts of all targets for a time slice
+                     at once, see below (default: false)
+   batch_identical
+            bool   - in batch mode, draw exactly the same spike trains as
+                     without batch mode (default: false)
 
 Sends: SpikeEvent
 
@@ -93,6 +98,24 @@ Remarks:
 
    http://ken.brainworks.uni-freiburg.de/cgi-bin/mailman/private/nest_developer/2011-January/002977.html
 
+   In batch mode, the generator draws the number of spikes for all its
+   targets and all steps of a time slice in a single pass over the RNG of
+   its thread, before it sends the first event of the slice. The event
+   hook then only looks up the number for its target. If /batch_identical
+   is true, the numbers are drawn one by one in the order in which the
+   event hook would draw them, so that the spike trains are identical to
+   those without batch mode. Otherwise, if less than one spike per target
+   and step is expected, the generator draws the total number of spikes
+   per step and distributes them uniformly over the targets, which has
+   the same statistics but needs far fewer random numbers. Above one
+   expected spike per target and step, the numbers are always drawn in
+   the order of the event hook.
+
+   Batch mode only removes the random numbers from the event hook. The
+   spikes still reach every target through the event hook and a virtual
+   call of its handle function, as the target decides how a spike enters
+   its ring buffers, so the delivery itself is not faster.
+
 SeeAlso: poisson_generator_ps, Device, parrot_neuron
 */
 
@@ -127,6 +150,12 @@ SeeAlso: poisson_generator_ps, Device, parrot_neuron
     void update(Time const &, const long_t, const long_t);
     void event_hook(DSSpikeEvent&);
 
+    /**
+     * Draw the spike counts of all targets for the active steps of the
+     * slice and send one event per active step, see batch mode.
+     */
+    void update_batch_(Time const &, const long_t, const long_t);
+
     // ------------------------------------------------------------
 
     /**
@@ -134,6 +163,8 @@ SeeAlso: poisson_generator_ps, Device, parrot_neuron
      */
     struct Parameters_ {
       double_t rate_;   //!< process rate in Hz
+      bool batch_;            //!< draw spike counts for a slice at once
+      bool batch_identical_;  //!< draw them in the order of event_hook()
 
       Parameters_();  //!< Sets default parameter values
 
@@ -143,14 +174,37 @@ SeeAlso: poisson_generator_ps, Device, parrot_neuron
 
     // ------------------------------------------------------------
 
+    struct Buffers_ {
+      /**
+       * Spike counts drawn in batch mode, for each active step of the
+       * slice one entry per target, in the order in which the targets
+       * receive the event.
+       */
+      std::vector<ulong_t> counts_;
+      size_t next_;  //!< entry of counts_ for the next target
+      size_t end_;   //!< end of the entries for the current step
+    };
+
+    // ------------------------------------------------------------
+
     struct Variables_ {
       librandom::PoissonRandomDev poisson_dev_;  //!< Random deviate generator
+
+      /**
+       * Random deviate generator for the total number of spikes of
+       * all targets in one step, in batch mode.
+       */
+      librandom::PoissonRandomDev batch_dev_;
+      double_t lambda_;   //!< expected number of spikes per target and step
+      size_t n_targets_;  //!< targets on this thread, in batch mode
+      bool scatter_;      //!< distribute the total number of spikes over the targets
     };
 
     // ------------------------------------------------------------
 
     StimulatingDevice<SpikeEvent> device_;
     Parameters_ P_;
+    Buffers_    B_;
     Variables_  V_;
 
   };
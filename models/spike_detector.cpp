@@ -54,7 +54,7 @@ void nest::spike_detector::init_buffers_()
 {
   device_.init_buffers();
 
-  std::vector<std::vector<Event*> > tmp(2, std::vector<Event*>());
+  std::vector<RecordingDevice::EventColumns> tmp(2);
   B_.spikes_.swap(tmp);
 }
 
@@ -75,18 +75,13 @@ void nest::spike_detector::calibrate()
 
 void nest::spike_detector::update(Time const&, const long_t, const long_t)
 {
-  for(std::vector<Event*>::iterator 
-      e = B_.spikes_[network()->read_toggle()].begin();
-      e != B_.spikes_[network()->read_toggle()].end(); ++e)
-  {
-    assert(*e != 0);
-    device_.record_event(**e);
-    delete *e;
-  }
+  RecordingDevice::EventColumns& spikes = B_.spikes_[network()->read_toggle()];
+  if ( !spikes.empty() )
+    device_.record_events(spikes);
   
   // do not use swap here to clear, since we want to keep the reserved()
   // memory for the next round
-  B_.spikes_[network()->read_toggle()].clear();  
+  spikes.clear();  
 } 
 
 void nest::spike_detector::get_status(DictionaryDatum &d) const
@@ -127,11 +122,8 @@ void nest::spike_detector::handle(SpikeEvent & e)
     else
       dest_buffer = network()->write_toggle();  // locally delivered events
 
+    const long_t steps = e.get_stamp().get_steps();
     for (int_t i = 0; i < e.get_multiplicity(); ++i)
-    {
-      // We store the complete events
-      Event *event = e.clone();
-      B_.spikes_[dest_buffer].push_back(event);
-    }
+      B_.spikes_[dest_buffer].push_back(e.get_sender_gid(), steps, e.get_offset(), e.get_weight());
   }
 }
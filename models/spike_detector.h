@@ -144,8 +144,11 @@ namespace nest
      *
      * This data structure buffers all incoming spikes until they are
      * passed to the RecordingDevice for storage or output during update().
+     * Each spike is stored as sender, time stamp, offset and weight in
+     * the columns of the buffer, once for each unit of its multiplicity.
      * update() always reads from spikes_[network()->read_toggle()] and
-     * deletes all events that have been read.
+     * clears it, keeping the capacity, so that recording does not
+     * allocate memory for each spike.
      *
      * Events arriving from locally sending nodes, i.e., devices without
      * proxies, are stored in spikes_[network()->write_toggle()], to ensure
@@ -159,7 +162,7 @@ namespace nest
      * from the global queue before any node is updated.
      */
     struct Buffers_ {
-      std::vector<std::vector<Event*> > spikes_; 
+      std::vector<RecordingDevice::EventColumns> spikes_; 
     };
     
     RecordingDevice device_;
@@ -0,0 +1,376 @@
+/*
+ *  async_writer.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "async_writer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <ctime>
+#include <sys/time.h>
+
+#ifdef HAVE_ASYNC_WRITER
+#include <pthread.h>
+#endif
+
+namespace
+{
+  // wall-clock time in seconds for measuring the stall time
+  inline
+  double wall_time_()
+  {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+  }
+
+  // wait briefly for the I/O thread
+  inline
+  void pause_()
+  {
+    timespec ts;
+    ts.tv_sec = 0;
+    ts.tv_nsec = 50000;
+    nanosleep(&ts, 0);
+  }
+
+  const size_t max_block_size = 65536;
+}
+
+#ifdef HAVE_ASYNC_WRITER
+
+namespace nest
+{
+  /**
+   * The I/O thread shared by all AsyncStreambufs.
+   *
+   * Blocks are passed to the thread through an intrusive queue with
+   * many producers and one consumer (D. Vyukov's algorithm): producers
+   * swap themselves into the head with a single atomic operation, and
+   * only the I/O thread touches the tail. The thread sleeps on a
+   * condition variable when the queue is empty.
+   *
+   * The writer is created on first use and lives until the process
+   * exits, so that its thread never waits on a destroyed condition.
+   */
+  class AsyncWriter
+  {
+  public:
+    static AsyncWriter& instance();
+
+    void push(AsyncStreambuf::Block*);
+
+  private:
+    AsyncWriter();
+
+    static void create_();
+    static void* run_(void*);
+
+    AsyncStreambuf::Block* pop_();
+    void push_(AsyncStreambuf::Block*);
+
+    AsyncStreambuf::Block stub_;
+    AsyncStreambuf::Block* volatile head_;  //!< last block pushed
+    AsyncStreambuf::Block* tail_;           //!< next block to pop
+
+    volatile bool waiting_;                 //!< true if the thread sleeps
+    pthread_mutex_t mutex_;
+    pthread_cond_t cond_;
+    pthread_t thread_;
+
+    static AsyncWriter* instance_;
+    static pthread_once_t once_;
+  };
+
+  AsyncWriter* AsyncWriter::instance_ = 0;
+  pthread_once_t AsyncWriter::once_ = PTHREAD_ONCE_INIT;
+
+  AsyncWriter::AsyncWriter()
+    : stub_(0),
+      head_(&stub_),
+      tail_(&stub_),
+      waiting_(false)
+  {
+    pthread_mutex_init(&mutex_, 0);
+    pthread_cond_init(&cond_, 0);
+  }
+
+  void AsyncWriter::create_()
+  {
+    instance_ = new AsyncWriter();
+    pthread_create(&instance_->thread_, 0, &AsyncWriter::run_, instance_);
+    pthread_detach(instance_->thread_);
+  }
+
+  AsyncWriter& AsyncWriter::instance()
+  {
+    pthread_once(&once_, &AsyncWriter::create_);
+    return *instance_;
+  }
+
+  void AsyncWriter::push_(AsyncStreambuf::Block* b)
+  {
+    b->next_ = 0;
+    AsyncStreambuf::Block* prev;
+    do
+      prev = head_;
+    while ( !__sync_bool_compare_and_swap(&head_, prev, b) );
+    prev->next_ = b;
+  }
+
+  void AsyncWriter::push(AsyncStreambuf::Block* b)
+  {
+    push_(b);
+
+    __sync_synchronize();
+    if ( waiting_ )
+    {
+      pthread_mutex_lock(&mutex_);
+      waiting_ = false;
+      pthread_cond_signal(&cond_);
+      pthread_mutex_unlock(&mutex_);
+    }
+  }
+
+  AsyncStreambuf::Block* AsyncWriter::pop_()
+  {
+    AsyncStreambuf::Block* tail = tail_;
+    AsyncStreambuf::Block* next = tail->next_;
+    if ( tail == &stub_ )
+    {
+      if ( next == 0 )
+        return 0;
+      tail_ = next;
+      tail = next;
+      next = next->next_;
+    }
+
+    if ( next == 0 )
+    {
+      // a producer has swapped in a block, but not linked it yet
+      if ( tail != head_ )
+        return 0;
+
+      push_(&stub_);
+      next = tail->next_;
+      if ( next == 0 )
+        return 0;
+    }
+
+    tail_ = next;
+    __sync_synchronize();
+    return tail;
+  }
+
+  void* AsyncWriter::run_(void* arg)
+  {
+    AsyncWriter* w = static_cast<AsyncWriter*>(arg);
+    while ( true )
+    {
+      AsyncStreambuf::Block* b = w->pop_();
+      if ( b != 0 )
+      {
+        b->stream_->write_(b);
+        continue;
+      }
+
+      pthread_mutex_lock(&w->mutex_);
+      w->waiting_ = true;
+      __sync_synchronize();
+      if ( w->head_ == w->tail_ )
+        pthread_cond_wait(&w->cond_, &w->mutex_);
+      w->waiting_ = false;
+      pthread_mutex_unlock(&w->mutex_);
+
+      // a block that is being linked needs a moment
+      if ( w->head_ != w->tail_ && w->tail_->next_ == 0 )
+        pause_();
+    }
+    return 0;
+  }
+
+} // namespace
+
+#endif // HAVE_ASYNC_WRITER
+
+nest::AsyncStreambuf::Block::Block(size_t size)
+  : next_(0),
+    stream_(0),
+    data_(size),
+    size_(0),
+    flush_(false)
+{}
+
+nest::AsyncStreambuf::AsyncStreambuf()
+  : file_(0),
+    block_size_(0),
+    max_blocks_(0),
+    blocks_(),
+    current_(0),
+    free_(0),
+    returned_(0),
+    pending_(0),
+    failed_(false),
+    stall_time_(0.0)
+{}
+
+nest::AsyncStreambuf::~AsyncStreambuf()
+{
+  close();
+}
+
+void nest::AsyncStreambuf::open(std::streambuf* file, size_t budget)
+{
+  assert(file_ == 0);
+
+  // two blocks at least, so that one is filled while the other is written
+  block_size_ = std::max<size_t>(1, std::min(budget / 2, max_block_size));
+  max_blocks_ = std::max<size_t>(2, budget / block_size_);
+
+  file_ = file;
+  failed_ = false;
+  current_ = get_block_();
+  setp(&current_->data_[0], &current_->data_[0] + block_size_);
+}
+
+bool nest::AsyncStreambuf::close()
+{
+  if ( file_ == 0 )
+    return true;
+
+  const bool ok = drain();
+
+  for ( size_t i = 0; i < blocks_.size(); ++i )
+    delete blocks_[i];
+  blocks_.clear();
+  current_ = free_ = returned_ = 0;
+  setp(0, 0);
+  file_ = 0;
+
+  return ok;
+}
+
+bool nest::AsyncStreambuf::drain()
+{
+  if ( file_ == 0 )
+    return true;
+
+  if ( pptr() > pbase() )
+    submit_();
+
+  if ( pending_ > 0 )
+  {
+    const double begin = wall_time_();
+    while ( pending_ > 0 )
+      pause_();
+    stall_time_ += wall_time_() - begin;
+  }
+  __sync_synchronize();
+
+  if ( file_->pubsync() == -1 )
+    failed_ = true;
+
+  return !failed_;
+}
+
+nest::AsyncStreambuf::int_type nest::AsyncStreambuf::overflow(int_type c)
+{
+  if ( file_ == 0 )
+    return traits_type::eof();
+
+  submit_();
+
+  if ( !traits_type::eq_int_type(c, traits_type::eof()) )
+  {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+  return traits_type::not_eof(c);
+}
+
+int nest::AsyncStreambuf::sync()
+{
+  // handing over a block for each flush would bring back the stalls
+  // the I/O thread is there to avoid, so the flush waits for the block
+  if ( file_ != 0 && pptr() > pbase() )
+    current_->flush_ = true;
+  return 0;
+}
+
+void nest::AsyncStreambuf::submit_()
+{
+  current_->size_ = pptr() - pbase();
+  __sync_fetch_and_add(&pending_, 1);
+
+#ifdef HAVE_ASYNC_WRITER
+  AsyncWriter::instance().push(current_);
+#else
+  write_(current_);
+#endif
+
+  current_ = get_block_();
+  setp(&current_->data_[0], &current_->data_[0] + block_size_);
+}
+
+nest::AsyncStreambuf::Block* nest::AsyncStreambuf::get_block_()
+{
+  if ( free_ == 0 )
+    free_ = __sync_lock_test_and_set(&returned_, 0);
+
+  if ( free_ == 0 && blocks_.size() < max_blocks_ )
+  {
+    blocks_.push_back(new Block(block_size_));
+    blocks_.back()->stream_ = this;
+    return blocks_.back();
+  }
+
+  if ( free_ == 0 )
+  {
+    // back-pressure: all blocks wait to be written
+    const double begin = wall_time_();
+    while ( ( free_ = __sync_lock_test_and_set(&returned_, 0) ) == 0 )
+      pause_();
+    stall_time_ += wall_time_() - begin;
+  }
+
+  Block* b = free_;
+  free_ = b->next_;
+  b->flush_ = false;
+  return b;
+}
+
+void nest::AsyncStreambuf::write_(Block* b)
+{
+  if ( file_->sputn(&b->data_[0], b->size_) != static_cast<std::streamsize>(b->size_) )
+    failed_ = true;
+  if ( b->flush_ && file_->pubsync() == -1 )
+    failed_ = true;
+
+  Block* head;
+  do
+  {
+    head = returned_;
+    b->next_ = head;
+  }
+  while ( !__sync_bool_compare_and_swap(&returned_, head, b) );
+
+  __sync_fetch_and_sub(&pending_, 1);
+}
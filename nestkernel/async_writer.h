@@ -0,0 +1,159 @@
+/*
+ *  async_writer.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ASYNC_WRITER_H
+#define ASYNC_WRITER_H
+
+#include "config.h"
+
+#include <streambuf>
+#include <vector>
+#include <cstddef>
+
+// OpenMP runtimes are built on POSIX threads on all platforms we
+// support, so the writer thread is available with either threading
+// model. Without threads, blocks are written when they are handed over.
+#if defined(HAVE_PTHREADS) || defined(_OPENMP)
+#define HAVE_ASYNC_WRITER
+#endif
+
+namespace nest
+{
+  class AsyncWriter;
+
+  /**
+   * Stream buffer that writes to a file buffer in a background thread.
+   *
+   * The data written to the stream are collected in blocks. Full blocks
+   * are handed to the I/O thread of the AsyncWriter through a lock-free
+   * queue. The I/O thread writes them to the file buffer and returns
+   * them to the stream, which reuses them. At most the given budget of bytes is
+   * allocated for blocks. When all blocks wait to be written, the
+   * writing thread waits for the I/O thread, and the time it waits is
+   * added to the stall time.
+   *
+   * Flushing the stream does not hand over the current block, but
+   * makes the I/O thread flush the file buffer after writing it. Only
+   * drain() and close() write all data.
+   *
+   * Each stream must be written from one thread at a time. The file
+   * buffer must not be used while the stream is open.
+   */
+  class AsyncStreambuf : public std::streambuf
+  {
+  public:
+    AsyncStreambuf();
+    ~AsyncStreambuf();
+
+    /**
+     * Start writing to file, with at most budget bytes in blocks.
+     */
+    void open(std::streambuf* file, size_t budget);
+
+    /**
+     * Wait until all data are written, flush the file buffer, and
+     * detach from it. Returns false if writing failed.
+     */
+    bool close();
+
+    /**
+     * Wait until all data are written and flush the file buffer.
+     * Returns false if writing failed.
+     */
+    bool drain();
+
+    bool is_open() const;
+
+    /**
+     * Return the time in seconds the writing thread has waited for the
+     * I/O thread.
+     */
+    double get_stall_time() const;
+
+  protected:
+    int_type overflow(int_type);
+    int sync();
+
+  private:
+    friend class AsyncWriter;
+
+    /**
+     * A block of data, linked into the queue of the AsyncWriter or the
+     * list of returned blocks of its stream.
+     */
+    struct Block {
+      Block* volatile next_;
+      AsyncStreambuf* stream_;
+      std::vector<char> data_;
+      size_t size_;  //!< bytes used
+      bool flush_;   //!< flush the file after writing the block
+
+      explicit Block(size_t);
+    };
+
+    AsyncStreambuf(const AsyncStreambuf&);
+    AsyncStreambuf& operator=(const AsyncStreambuf&);
+
+    /**
+     * Hand the current block to the I/O thread and start a new one.
+     */
+    void submit_();
+
+    /**
+     * Return a free block, waiting for the I/O thread if all blocks are
+     * in use.
+     */
+    Block* get_block_();
+
+    /**
+     * Write the block to the file and return it, called by the I/O
+     * thread.
+     */
+    void write_(Block*);
+
+    std::streambuf* file_;      //!< the file buffer written by the I/O thread
+    size_t block_size_;         //!< bytes per block
+    size_t max_blocks_;         //!< blocks allowed by the budget
+    std::vector<Block*> blocks_; //!< all blocks allocated
+    Block* current_;            //!< block that is being filled
+    Block* free_;               //!< free blocks taken from returned_
+    Block* volatile returned_;  //!< blocks returned by the I/O thread
+    volatile long pending_;     //!< blocks handed over and not yet written
+    volatile bool failed_;      //!< true if writing failed
+    double stall_time_;         //!< seconds waited for the I/O thread
+  };
+
+  inline
+  bool AsyncStreambuf::is_open() const
+  {
+    return file_ != 0;
+  }
+
+  inline
+  double AsyncStreambuf::get_stall_time() const
+  {
+    return stall_time_;
+  }
+
+} // namespace
+
+#endif
@@ -31,6 +31,8 @@
 
 #include <limits>
 #include <numeric>
+#include <algorithm>
+#include <cmath>
 #include <time.h>
 #include <sys/time.h>  // required to fix header dependencies in OS X, HEP
 #include <sys/times.h>
@@ -50,6 +52,9 @@ int nest::Communicator::send_buffer_size_ = 1;
 int nest::Communicator::recv_buffer_size_ = 1;
 bool nest::Communicator::initialized_ = false;
 bool nest::Communicator::use_Allgather_ = true;
+bool nest::Communicator::adaptive_exchange_ = false;
+bool nest::Communicator::compressed_exchange_ = false;
+size_t nest::Communicator::exchange_bytes_ = 0;
 
 #ifdef HAVE_MPI
 
@@ -68,15 +73,127 @@ MPI_Comm comm=0;
 template<> MPI_Datatype MPI_Type<nest::int_t>::type = MPI_INT;
 template<> MPI_Datatype MPI_Type<nest::double_t>::type = MPI_DOUBLE;
 template<> MPI_Datatype MPI_Type<nest::long_t>::type = MPI_LONG;
+template<> MPI_Datatype MPI_Type<nest::uint_t>::type = MPI_UNSIGNED;
 
 MPI_Datatype MPI_OFFGRID_SPIKE = 0;
 
+// set to MPI_OFFGRID_SPIKE once the type is committed in init()
+template<> MPI_Datatype MPI_Type<nest::Communicator::OffGridSpike>::type = 0;
+
 /* ------------------------------------------------------ */
 
 unsigned int nest::Communicator::COMM_OVERFLOW_ERROR = std::numeric_limits<unsigned int>::max();
 
 std::vector<int> nest::Communicator::comm_step_ = std::vector<int>();
 
+int nest::Communicator::low_use_exchanges_ = 0;
+
+std::vector<unsigned char> nest::Communicator::compressed_send_buffer_ = std::vector<unsigned char>();
+std::vector<unsigned char> nest::Communicator::compressed_recv_buffer_ = std::vector<unsigned char>();
+
+bool nest::Communicator::pending_overflow_check_ = false;
+std::vector<int> nest::Communicator::pending_counts_ = std::vector<int>();
+std::vector<int> nest::Communicator::pending_displacements_ = std::vector<int>();
+
+// Non-blocking collectives were introduced with MPI-3. With older
+// libraries, start_communicate() completes the exchange.
+#if defined(MPI_VERSION) && MPI_VERSION >= 3
+#define HAVE_MPI_NONBLOCKING_COLLECTIVES
+#endif
+
+// The request of the exchange started by start_communicate().
+MPI_Request exchange_request = MPI_REQUEST_NULL;
+
+namespace
+{
+  // the GID stored in an entry of the spike buffers, to read and
+  // write the overflow message of the exchange of fixed size
+  inline
+  nest::uint_t entry_gid(nest::uint_t entry)
+  {
+    return entry;
+  }
+
+  inline
+  nest::uint_t entry_gid(const nest::Communicator::OffGridSpike& entry)
+  {
+    return entry.get_gid();
+  }
+
+  inline
+  void set_entry_gid(nest::uint_t& entry, nest::uint_t gid)
+  {
+    entry = gid;
+  }
+
+  inline
+  void set_entry_gid(nest::Communicator::OffGridSpike& entry, nest::uint_t gid)
+  {
+    entry.set_gid(gid);
+  }
+
+  // write a varint, 7 bits per byte with the high bit set on all but
+  // the last byte
+  inline
+  void put_varint(std::vector<unsigned char>& bytes, nest::uint_t value)
+  {
+    while (value >= 0x80)
+    {
+      bytes.push_back(static_cast<unsigned char>(value | 0x80));
+      value >>= 7;
+    }
+    bytes.push_back(static_cast<unsigned char>(value));
+  }
+
+  // write the difference of two GIDs as zigzag varint, so that small
+  // negative differences take few bytes, too
+  inline
+  void put_gid_delta(std::vector<unsigned char>& bytes, nest::uint_t gid, nest::uint_t prev)
+  {
+    const nest::uint_t delta = gid - prev;
+    put_varint(bytes, (delta << 1) ^ (0U - (delta >> 31)));
+  }
+
+  inline
+  nest::uint_t get_varint(const unsigned char*& p)
+  {
+    nest::uint_t value = 0;
+    int shift = 0;
+    while (*p & 0x80)
+    {
+      value |= static_cast<nest::uint_t>(*p++ & 0x7f) << shift;
+      shift += 7;
+    }
+    value |= static_cast<nest::uint_t>(*p++) << shift;
+    return value;
+  }
+
+  inline
+  nest::uint_t get_gid_delta(const unsigned char*& p, nest::uint_t prev)
+  {
+    const nest::uint_t zigzag = get_varint(p);
+    return prev + ((zigzag >> 1) ^ (0U - (zigzag & 1)));
+  }
+
+  // difference between a spike and its decoded copy, that is the
+  // difference of the offsets of off-grid spikes, or the largest
+  // double for different GIDs
+  inline
+  nest::double_t decoding_error(nest::uint_t a, nest::uint_t b)
+  {
+    return a == b ? 0.0 : std::numeric_limits<nest::double_t>::max();
+  }
+
+  inline
+  nest::double_t decoding_error(const nest::Communicator::OffGridSpike& a,
+                                const nest::Communicator::OffGridSpike& b)
+  {
+    if (a.get_gid() != b.get_gid())
+      return std::numeric_limits<nest::double_t>::max();
+    return std::abs(a.get_offset() - b.get_offset());
+  }
+}
+
 /**
  * Set up MPI, establish number of processes and rank, and initialize
  * the vector of communication partners.
@@ -144,6 +261,7 @@ void nest::Communicator::init (int* argc, char** argv[])
   //generate and commit struct
   MPI_Type_struct(2, blockcounts, offsets, source_types, &MPI_OFFGRID_SPIKE);
   MPI_Type_commit(&MPI_OFFGRID_SPIKE);
+  MPI_Type<OffGridSpike>::type = MPI_OFFGRID_SPIKE;
   init_communication();
   initialized_ = true;
 }
@@ -236,6 +354,222 @@ void nest::Communicator::init_communication ()
   }
 }
 
+/**
+ * Gather the spikes of all processes in two collectives, first the
+ * number of entries each process sends, then exactly these entries.
+ * Unlike the fixed-size exchange, no collective has to be repeated if
+ * a process sends more than send_buffer_size_ entries, and only the
+ * entries actually sent are transferred.
+ */
+template <typename T>
+void nest::Communicator::communicate_adaptive(std::vector<T>& send_buffer,
+                                              std::vector<T>& recv_buffer,
+                                              std::vector<int>& displacements)
+{
+  int send_count = send_buffer.size();
+  std::vector<int> recv_counts(num_processes_);
+  MPI_Allgather(&send_count, 1, MPI_INT, &recv_counts[0], 1, MPI_INT, comm);
+
+  int disp = 0;
+  int max_recv_count = 0;
+  for (int pid = 0; pid < num_processes_; ++pid)
+  {
+    displacements[pid] = disp;
+    disp += recv_counts[pid];
+    if (recv_counts[pid] > max_recv_count)
+      max_recv_count = recv_counts[pid];
+  }
+
+  // all processes know the largest send buffer, so the buffer sizes
+  // remain the same on all processes and can be used by the
+  // fixed-size exchange when the adaptive exchange is switched off
+  adapt_buffer_sizes(max_recv_count);
+
+  // reallocate the receive buffer only if it is too small or at least
+  // twice as large as needed
+  recv_buffer.clear();
+  if ( recv_buffer.capacity() < static_cast<size_t>(disp)
+       || recv_buffer.capacity() > 2 * static_cast<size_t>(recv_buffer_size_) )
+  {
+    std::vector<T> tmp;
+    tmp.reserve(recv_buffer_size_);
+    recv_buffer.swap(tmp);
+  }
+  recv_buffer.resize(disp);
+
+  MPI_Allgatherv(&send_buffer[0], send_count, MPI_Type<T>::type,
+                 &recv_buffer[0], &recv_counts[0], &displacements[0], MPI_Type<T>::type, comm);
+
+  if ( send_buffer.capacity() > 2 * static_cast<size_t>(send_buffer_size_) )
+    std::vector<T>(send_buffer).swap(send_buffer);
+
+  exchange_bytes_ = num_processes_ * sizeof(int) + disp * sizeof(T);
+}
+
+template <typename T>
+void nest::Communicator::communicate_compressed(std::vector<T>& send_buffer,
+                                                std::vector<T>& recv_buffer,
+                                                std::vector<int>& displacements)
+{
+  compressed_send_buffer_.clear();
+  encode_spikes(send_buffer, compressed_send_buffer_);
+
+  int send_count = compressed_send_buffer_.size();
+  std::vector<int> recv_counts(num_processes_);
+  MPI_Allgather(&send_count, 1, MPI_INT, &recv_counts[0], 1, MPI_INT, comm);
+
+  std::vector<int> byte_displacements(num_processes_);
+  int disp = 0;
+  for (int pid = 0; pid < num_processes_; ++pid)
+  {
+    byte_displacements[pid] = disp;
+    disp += recv_counts[pid];
+  }
+
+  // no process sends an empty buffer, since there is one marker per
+  // lag and thread
+  compressed_recv_buffer_.resize(disp);
+  MPI_Allgatherv(&compressed_send_buffer_[0], send_count, MPI_BYTE,
+                 &compressed_recv_buffer_[0], &recv_counts[0], &byte_displacements[0], MPI_BYTE, comm);
+
+  recv_buffer.clear();
+  int max_recv_count = 0;
+  for (int pid = 0; pid < num_processes_; ++pid)
+  {
+    displacements[pid] = recv_buffer.size();
+    const unsigned char* block = &compressed_recv_buffer_[0] + byte_displacements[pid];
+    decode_spikes(block, block + recv_counts[pid], recv_buffer);
+    max_recv_count = std::max(max_recv_count, static_cast<int>(recv_buffer.size()) - displacements[pid]);
+  }
+
+  // keep the buffer sizes of the fixed-size exchange up to date, as
+  // the adaptive exchange does
+  adapt_buffer_sizes(max_recv_count);
+
+  exchange_bytes_ = num_processes_ * sizeof(int) + disp;
+}
+
+void nest::Communicator::encode_spikes(const std::vector<uint_t>& spikes,
+                                       std::vector<unsigned char>& bytes)
+{
+  std::vector<uint_t>::const_iterator begin = spikes.begin();
+  while (begin != spikes.end())
+  {
+    std::vector<uint_t>::const_iterator end = std::find(begin, spikes.end(), 0U);
+    put_varint(bytes, end - begin);
+
+    uint_t prev = 0;
+    for (; begin != end; ++begin)
+    {
+      put_gid_delta(bytes, *begin, prev);
+      prev = *begin;
+    }
+
+    if (end != spikes.end())
+      ++begin;  // skip the marker
+  }
+}
+
+void nest::Communicator::encode_spikes(const std::vector<OffGridSpike>& spikes,
+                                       std::vector<unsigned char>& bytes)
+{
+  // offsets lie in [0, h]
+  const double_t scale = std::numeric_limits<unsigned int>::max() / Time::get_resolution().get_ms();
+
+  std::vector<OffGridSpike>::const_iterator begin = spikes.begin();
+  while (begin != spikes.end())
+  {
+    std::vector<OffGridSpike>::const_iterator end = begin;
+    while (end != spikes.end() && end->get_gid() != 0)
+      ++end;
+    put_varint(bytes, end - begin);
+
+    uint_t prev = 0;
+    for (; begin != end; ++begin)
+    {
+      put_gid_delta(bytes, begin->get_gid(), prev);
+      prev = begin->get_gid();
+
+      const double_t fraction = std::min(std::max(begin->get_offset() * scale + 0.5, 0.0),
+                                         static_cast<double_t>(std::numeric_limits<unsigned int>::max()));
+      const unsigned int offset = static_cast<unsigned int>(fraction);
+      for (int byte = 0; byte < 4; ++byte)
+        bytes.push_back(static_cast<unsigned char>(offset >> (8 * byte)));
+    }
+
+    if (end != spikes.end())
+      ++begin;  // skip the marker
+  }
+}
+
+void nest::Communicator::decode_spikes(const unsigned char* begin, const unsigned char* end,
+                                       std::vector<uint_t>& spikes)
+{
+  while (begin != end)
+  {
+    const uint_t n_spikes = get_varint(begin);
+    uint_t gid = 0;
+    for (uint_t k = 0; k < n_spikes; ++k)
+    {
+      gid = get_gid_delta(begin, gid);
+      spikes.push_back(gid);
+    }
+    spikes.push_back(0U);  // the marker
+  }
+}
+
+void nest::Communicator::decode_spikes(const unsigned char* begin, const unsigned char* end,
+                                       std::vector<OffGridSpike>& spikes)
+{
+  const double_t unit = Time::get_resolution().get_ms() / std::numeric_limits<unsigned int>::max();
+
+  while (begin != end)
+  {
+    const uint_t n_spikes = get_varint(begin);
+    uint_t gid = 0;
+    for (uint_t k = 0; k < n_spikes; ++k)
+    {
+      gid = get_gid_delta(begin, gid);
+      unsigned int offset = 0;
+      for (int byte = 0; byte < 4; ++byte)
+        offset |= static_cast<unsigned int>(*begin++) << (8 * byte);
+      spikes.push_back(OffGridSpike(gid, offset * unit));
+    }
+    spikes.push_back(OffGridSpike(0, 0.0));  // the marker
+  }
+}
+
+/**
+ * Adjust the buffer sizes to the largest send buffer of the last
+ * adaptive exchange. The sizes grow with some headroom as soon as a
+ * send buffer exceeds them, but shrink only after a number of
+ * exchanges with little activity, so that bursty activity does not
+ * reallocate the buffers in every slice.
+ */
+void nest::Communicator::adapt_buffer_sizes(int max_send_count)
+{
+  const int target_size = max_send_count + max_send_count / ADAPTIVE_HEADROOM;
+
+  if (max_send_count > send_buffer_size_)
+  {
+    send_buffer_size_ = target_size;
+    low_use_exchanges_ = 0;
+  }
+  else if (2 * target_size < send_buffer_size_)
+  {
+    if (++low_use_exchanges_ >= ADAPTIVE_SHRINK_DELAY)
+    {
+      // the overflow message of the fixed-size exchange needs two entries
+      send_buffer_size_ = std::max(target_size, 2);
+      low_use_exchanges_ = 0;
+    }
+  }
+  else
+    low_use_exchanges_ = 0;
+
+  recv_buffer_size_ = send_buffer_size_ * num_processes_;
+}
+
 void nest::Communicator::communicate (std::vector<uint_t>& send_buffer, 
 				      std::vector<uint_t>& recv_buffer, 
 				      std::vector<int>& displacements)
@@ -249,7 +583,12 @@ void nest::Communicator::communicate (std::vector<uint_t>& send_buffer,
 	  recv_buffer.resize(recv_buffer_size_);
 	}
       recv_buffer.swap(send_buffer);
+      exchange_bytes_ = 0;
     }
+  else if (compressed_exchange_)
+    communicate_compressed(send_buffer, recv_buffer, displacements);
+  else if (adaptive_exchange_)
+    communicate_adaptive(send_buffer, recv_buffer, displacements);
   else if ((num_processes_ > 1) && use_Allgather_)   //communicate using Allgather
     communicate_Allgather(send_buffer, recv_buffer,displacements);
   else  
@@ -261,6 +600,7 @@ void nest::Communicator::communicate_Allgather (std::vector<uint_t>& send_buffer
 						std::vector<int>& displacements)
 {  
   std::vector<int> recv_counts(num_processes_,send_buffer_size_);
+  exchange_bytes_ = num_processes_ * send_buffer_size_ * sizeof(uint_t);
 
   //attempt Allgather
   if (send_buffer.size() == static_cast<uint_t>(send_buffer_size_))
@@ -296,6 +636,7 @@ void nest::Communicator::communicate_Allgather (std::vector<uint_t>& send_buffer
   //do Allgatherv if necessary
   if (overflow)
     {
+      exchange_bytes_ += disp * sizeof(uint_t);
       recv_buffer.resize(disp,0);
       MPI_Allgatherv(&send_buffer[0], send_buffer.size(), MPI_UNSIGNED, 
 		     &recv_buffer[0], &recv_counts[0], &displacements[0], MPI_UNSIGNED, comm);
@@ -312,6 +653,7 @@ void nest::Communicator::communicate_CPEX (std::vector<uint_t>& send_buffer,
   int partner;
   int disp;
   std::vector<int> recv_counts(num_processes_,send_buffer_size_);
+  exchange_bytes_ = num_processes_ * send_buffer_size_ * sizeof(uint_t);
   
   if (send_buffer.size() == static_cast<uint_t>(send_buffer_size_))    //no overflow condition
     {
@@ -386,6 +728,7 @@ void nest::Communicator::communicate_CPEX (std::vector<uint_t>& send_buffer,
 
   if (overflow)
     {
+      exchange_bytes_ += disp * sizeof(uint_t);
       recv_buffer.resize(disp,0);
       for (size_t step = 0; step < comm_step_.size(); ++step)
 	{
@@ -473,7 +816,12 @@ void nest::Communicator::communicate (std::vector<OffGridSpike>& send_buffer,
 	  recv_buffer.resize(recv_buffer_size_);
 	}
       recv_buffer.swap(send_buffer);
+      exchange_bytes_ = 0;
     }
+  else if (compressed_exchange_)
+    communicate_compressed(send_buffer, recv_buffer, displacements);
+  else if (adaptive_exchange_)
+    communicate_adaptive(send_buffer, recv_buffer, displacements);
   else if ((num_processes_ > 1) && use_Allgather_)   //communicate using Allgather
     communicate_Allgather(send_buffer, recv_buffer,displacements);
   else  
@@ -485,6 +833,7 @@ void nest::Communicator::communicate_Allgather (std::vector<OffGridSpike>& send_
 						std::vector<int>& displacements)
 {  
   std::vector<int> recv_counts(num_processes_,send_buffer_size_);
+  exchange_bytes_ = num_processes_ * send_buffer_size_ * sizeof(OffGridSpike);
   //attempt Allgather
   if (send_buffer.size() == static_cast<uint_t>(send_buffer_size_))
     MPI_Allgather(&send_buffer[0], send_buffer_size_, MPI_OFFGRID_SPIKE, 
@@ -519,6 +868,7 @@ void nest::Communicator::communicate_Allgather (std::vector<OffGridSpike>& send_
   //do Allgatherv if necessary
   if (overflow)
     {
+      exchange_bytes_ += disp * sizeof(OffGridSpike);
       recv_buffer.resize(disp);
       MPI_Allgatherv(&send_buffer[0], send_buffer.size(), MPI_OFFGRID_SPIKE, 
 		     &recv_buffer[0], &recv_counts[0], &displacements[0], 
@@ -536,6 +886,7 @@ void nest::Communicator::communicate_CPEX (std::vector<OffGridSpike>& send_buffe
   int partner;
   int disp;
   std::vector<int> recv_counts(num_processes_,send_buffer_size_);
+  exchange_bytes_ = num_processes_ * send_buffer_size_ * sizeof(OffGridSpike);
   
   
   if (send_buffer.size() == static_cast<uint_t>(send_buffer_size_)) //no overflow condition
@@ -618,6 +969,7 @@ void nest::Communicator::communicate_CPEX (std::vector<OffGridSpike>& send_buffe
 
   if (overflow)
     {
+      exchange_bytes_ += disp * sizeof(OffGridSpike);
       recv_buffer.resize(disp);
       for (size_t step = 0; step < comm_step_.size(); ++step)
 	{
@@ -675,6 +1027,336 @@ void nest::Communicator::communicate(std::vector<double_t>& send_buffer,
 }
 
 
+void nest::Communicator::communicate(std::vector<long_t>& send_buffer,
+                                     std::vector<long_t>& recv_buffer,
+                                     std::vector<int>& displacements)
+{
+  //get size of buffers
+  std::vector<int> n_nodes(num_processes_);
+  n_nodes[Communicator::rank_] = send_buffer.size();
+  communicate(n_nodes);
+  // Set up displacements vector.
+  displacements.resize(num_processes_,0);
+
+  for ( int i = 1; i < num_processes_; ++i )
+    displacements.at(i) = displacements.at(i-1)+n_nodes.at(i-1);
+
+  // Calculate total number of node data items to be gathered.
+  size_t n_globals =
+    std::accumulate(n_nodes.begin(),n_nodes.end(), 0);
+
+  if (n_globals != 0) {
+    recv_buffer.resize(n_globals,0L);
+    communicate_Allgatherv(send_buffer, recv_buffer, displacements, n_nodes);
+  } else {
+    recv_buffer.clear();
+  }
+}
+
+
+void nest::Communicator::communicate(std::vector<uint_t>& send_buffer,
+                                     std::vector<int>& send_counts,
+                                     std::vector<uint_t>& recv_buffer,
+                                     std::vector<int>& displacements,
+                                     std::vector<int>& recv_counts)
+{
+  if (num_processes_ == 1)    //purely thread-based
+    {
+      displacements[0] = 0;
+      recv_counts.assign(1, send_counts[0]);
+      recv_buffer.swap(send_buffer);
+      exchange_bytes_ = 0;
+    }
+  else
+    communicate_Alltoallv(send_buffer, send_counts, recv_buffer, displacements, recv_counts);
+}
+
+void nest::Communicator::communicate(std::vector<OffGridSpike>& send_buffer,
+                                     std::vector<int>& send_counts,
+                                     std::vector<OffGridSpike>& recv_buffer,
+                                     std::vector<int>& displacements,
+                                     std::vector<int>& recv_counts)
+{
+  if (num_processes_ == 1)    //purely thread-based
+    {
+      displacements[0] = 0;
+      recv_counts.assign(1, send_counts[0]);
+      recv_buffer.swap(send_buffer);
+      exchange_bytes_ = 0;
+    }
+  else
+    communicate_Alltoallv(send_buffer, send_counts, recv_buffer, displacements, recv_counts);
+}
+
+/**
+ * Exchange the spikes in two collectives, first the number of
+ * entries each process sends to each other process, then exactly
+ * these entries. A process thus only receives the spikes of sources
+ * that have targets on it.
+ */
+template <typename T>
+void nest::Communicator::communicate_Alltoallv(std::vector<T>& send_buffer,
+                                               std::vector<int>& send_counts,
+                                               std::vector<T>& recv_buffer,
+                                               std::vector<int>& displacements,
+                                               std::vector<int>& recv_counts)
+{
+  recv_counts.resize(num_processes_);
+  MPI_Alltoall(&send_counts[0], 1, MPI_INT, &recv_counts[0], 1, MPI_INT, comm);
+
+  std::vector<int> send_displacements(num_processes_);
+  int send_disp = 0;
+  int recv_disp = 0;
+  for (int pid = 0; pid < num_processes_; ++pid)
+  {
+    send_displacements[pid] = send_disp;
+    send_disp += send_counts[pid];
+    displacements[pid] = recv_disp;
+    recv_disp += recv_counts[pid];
+  }
+
+  recv_buffer.resize(recv_disp);
+
+  // buffers may be empty if a process sends or receives no spikes
+  MPI_Alltoallv(send_buffer.empty() ? 0 : &send_buffer[0],
+                &send_counts[0], &send_displacements[0], MPI_Type<T>::type,
+                recv_buffer.empty() ? 0 : &recv_buffer[0],
+                &recv_counts[0], &displacements[0], MPI_Type<T>::type, comm);
+
+  exchange_bytes_ = num_processes_ * sizeof(int) + recv_disp * sizeof(T);
+}
+
+
+void nest::Communicator::start_communicate(std::vector<uint_t>& send_buffer,
+                                           std::vector<uint_t>& recv_buffer,
+                                           std::vector<int>& displacements)
+{
+  if (num_processes_ == 1)
+    communicate(send_buffer, recv_buffer, displacements);
+  else if (adaptive_exchange_)
+    start_Allgatherv(send_buffer, recv_buffer, displacements);
+  else
+    start_Allgather(send_buffer, recv_buffer);
+}
+
+void nest::Communicator::start_communicate(std::vector<OffGridSpike>& send_buffer,
+                                           std::vector<OffGridSpike>& recv_buffer,
+                                           std::vector<int>& displacements)
+{
+  if (num_processes_ == 1)
+    communicate(send_buffer, recv_buffer, displacements);
+  else if (adaptive_exchange_)
+    start_Allgatherv(send_buffer, recv_buffer, displacements);
+  else
+    start_Allgather(send_buffer, recv_buffer);
+}
+
+void nest::Communicator::start_communicate(std::vector<uint_t>& send_buffer,
+                                           std::vector<int>& send_counts,
+                                           std::vector<uint_t>& recv_buffer,
+                                           std::vector<int>& displacements,
+                                           std::vector<int>& recv_counts)
+{
+  if (num_processes_ == 1)
+    communicate(send_buffer, send_counts, recv_buffer, displacements, recv_counts);
+  else
+    start_Alltoallv(send_buffer, send_counts, recv_buffer, displacements, recv_counts);
+}
+
+void nest::Communicator::start_communicate(std::vector<OffGridSpike>& send_buffer,
+                                           std::vector<int>& send_counts,
+                                           std::vector<OffGridSpike>& recv_buffer,
+                                           std::vector<int>& displacements,
+                                           std::vector<int>& recv_counts)
+{
+  if (num_processes_ == 1)
+    communicate(send_buffer, send_counts, recv_buffer, displacements, recv_counts);
+  else
+    start_Alltoallv(send_buffer, send_counts, recv_buffer, displacements, recv_counts);
+}
+
+void nest::Communicator::finish_communicate(std::vector<uint_t>& send_buffer,
+                                            std::vector<uint_t>& recv_buffer,
+                                            std::vector<int>& displacements)
+{
+  MPI_Wait(&exchange_request, MPI_STATUS_IGNORE);
+  if (pending_overflow_check_)
+    finish_Allgather(send_buffer, recv_buffer, displacements);
+}
+
+void nest::Communicator::finish_communicate(std::vector<OffGridSpike>& send_buffer,
+                                            std::vector<OffGridSpike>& recv_buffer,
+                                            std::vector<int>& displacements)
+{
+  MPI_Wait(&exchange_request, MPI_STATUS_IGNORE);
+  if (pending_overflow_check_)
+    finish_Allgather(send_buffer, recv_buffer, displacements);
+}
+
+/**
+ * Start the exchange of fixed size. Each process writes its block,
+ * or the overflow message if its spikes do not fit, directly into the
+ * receive buffer, so that no separate send buffer has to be kept until
+ * the exchange is complete.
+ */
+template <typename T>
+void nest::Communicator::start_Allgather(std::vector<T>& send_buffer,
+                                         std::vector<T>& recv_buffer)
+{
+  recv_buffer.assign(recv_buffer_size_, T());
+
+  typename std::vector<T>::iterator block = recv_buffer.begin() + rank_ * send_buffer_size_;
+  if (send_buffer.size() <= static_cast<size_t>(send_buffer_size_))
+    std::copy(send_buffer.begin(), send_buffer.end(), block);
+  else
+  {
+    set_entry_gid(*block, COMM_OVERFLOW_ERROR);
+    set_entry_gid(*(block + 1), send_buffer.size());
+  }
+
+#ifdef HAVE_MPI_NONBLOCKING_COLLECTIVES
+  MPI_Iallgather(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
+                 &recv_buffer[0], send_buffer_size_, MPI_Type<T>::type, comm, &exchange_request);
+#else
+  MPI_Allgather(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
+                &recv_buffer[0], send_buffer_size_, MPI_Type<T>::type, comm);
+#endif
+
+  pending_overflow_check_ = true;
+  exchange_bytes_ = num_processes_ * send_buffer_size_ * sizeof(T);
+}
+
+/**
+ * Complete the exchange of fixed size. If any process could not send
+ * all its spikes, all spikes are exchanged again as in
+ * communicate_Allgather().
+ */
+template <typename T>
+void nest::Communicator::finish_Allgather(std::vector<T>& send_buffer,
+                                          std::vector<T>& recv_buffer,
+                                          std::vector<int>& displacements)
+{
+  pending_overflow_check_ = false;
+
+  std::vector<int> recv_counts(num_processes_, send_buffer_size_);
+  int disp = 0;
+  int max_recv_count = send_buffer_size_;
+  bool overflow = false;
+  for (int pid = 0; pid < num_processes_; ++pid)
+  {
+    const size_t block_disp = pid * send_buffer_size_;
+    displacements[pid] = disp;
+    if (entry_gid(recv_buffer[block_disp]) == COMM_OVERFLOW_ERROR)
+    {
+      overflow = true;
+      recv_counts[pid] = entry_gid(recv_buffer[block_disp + 1]);
+      max_recv_count = std::max(max_recv_count, recv_counts[pid]);
+    }
+    disp += recv_counts[pid];
+  }
+
+  if (overflow)
+  {
+    // unlike in communicate_Allgather(), the send buffers are not
+    // padded to send_buffer_size_, so all processes send their counts
+    int send_count = send_buffer.size();
+    MPI_Allgather(&send_count, 1, MPI_INT, &recv_counts[0], 1, MPI_INT, comm);
+    disp = 0;
+    for (int pid = 0; pid < num_processes_; ++pid)
+    {
+      displacements[pid] = disp;
+      disp += recv_counts[pid];
+    }
+
+    exchange_bytes_ += num_processes_ * sizeof(int) + disp * sizeof(T);
+    recv_buffer.resize(disp);
+    MPI_Allgatherv(&send_buffer[0], send_count, MPI_Type<T>::type,
+                   &recv_buffer[0], &recv_counts[0], &displacements[0], MPI_Type<T>::type, comm);
+    send_buffer_size_ = max_recv_count;
+    recv_buffer_size_ = send_buffer_size_ * num_processes_;
+  }
+}
+
+/**
+ * Start the adaptive exchange. The number of entries is exchanged
+ * before the exchange is started, as in communicate_adaptive().
+ */
+template <typename T>
+void nest::Communicator::start_Allgatherv(std::vector<T>& send_buffer,
+                                          std::vector<T>& recv_buffer,
+                                          std::vector<int>& displacements)
+{
+  int send_count = send_buffer.size();
+  pending_counts_.resize(num_processes_);
+  MPI_Allgather(&send_count, 1, MPI_INT, &pending_counts_[0], 1, MPI_INT, comm);
+
+  int disp = 0;
+  int max_recv_count = 0;
+  for (int pid = 0; pid < num_processes_; ++pid)
+  {
+    displacements[pid] = disp;
+    disp += pending_counts_[pid];
+    max_recv_count = std::max(max_recv_count, pending_counts_[pid]);
+  }
+  adapt_buffer_sizes(max_recv_count);
+
+  recv_buffer.resize(disp);
+
+#ifdef HAVE_MPI_NONBLOCKING_COLLECTIVES
+  MPI_Iallgatherv(&send_buffer[0], send_count, MPI_Type<T>::type,
+                  &recv_buffer[0], &pending_counts_[0], &displacements[0], MPI_Type<T>::type,
+                  comm, &exchange_request);
+#else
+  MPI_Allgatherv(&send_buffer[0], send_count, MPI_Type<T>::type,
+                 &recv_buffer[0], &pending_counts_[0], &displacements[0], MPI_Type<T>::type, comm);
+#endif
+
+  exchange_bytes_ = num_processes_ * sizeof(int) + disp * sizeof(T);
+}
+
+/**
+ * Start the targeted exchange. The number of entries is exchanged
+ * before the exchange is started, as in communicate_Alltoallv().
+ */
+template <typename T>
+void nest::Communicator::start_Alltoallv(std::vector<T>& send_buffer,
+                                         std::vector<int>& send_counts,
+                                         std::vector<T>& recv_buffer,
+                                         std::vector<int>& displacements,
+                                         std::vector<int>& recv_counts)
+{
+  recv_counts.resize(num_processes_);
+  MPI_Alltoall(&send_counts[0], 1, MPI_INT, &recv_counts[0], 1, MPI_INT, comm);
+
+  pending_displacements_.resize(num_processes_);
+  int send_disp = 0;
+  int recv_disp = 0;
+  for (int pid = 0; pid < num_processes_; ++pid)
+  {
+    pending_displacements_[pid] = send_disp;
+    send_disp += send_counts[pid];
+    displacements[pid] = recv_disp;
+    recv_disp += recv_counts[pid];
+  }
+
+  recv_buffer.resize(recv_disp);
+
+#ifdef HAVE_MPI_NONBLOCKING_COLLECTIVES
+  MPI_Ialltoallv(send_buffer.empty() ? 0 : &send_buffer[0],
+                 &send_counts[0], &pending_displacements_[0], MPI_Type<T>::type,
+                 recv_buffer.empty() ? 0 : &recv_buffer[0],
+                 &recv_counts[0], &displacements[0], MPI_Type<T>::type, comm, &exchange_request);
+#else
+  MPI_Alltoallv(send_buffer.empty() ? 0 : &send_buffer[0],
+                &send_counts[0], &pending_displacements_[0], MPI_Type<T>::type,
+                recv_buffer.empty() ? 0 : &recv_buffer[0],
+                &recv_counts[0], &displacements[0], MPI_Type<T>::type, comm);
+#endif
+
+  exchange_bytes_ = num_processes_ * sizeof(int) + recv_disp * sizeof(T);
+}
+
+
 void nest::Communicator::communicate(double_t send_val, std::vector<double_t>& recv_buffer)
 {
   recv_buffer.resize(num_processes_);
@@ -826,6 +1508,89 @@ nest::double_t nest::Communicator::time_communicate_offgrid(int num_bytes, int s
   return total_duration/(samples * sysconf(_SC_CLK_TCK));
 }
 
+template <typename T>
+void nest::Communicator::time_spike_codec_(const std::vector<T>& spikes, long samples, DictionaryDatum& d)
+{
+  std::vector<unsigned char> bytes;
+  std::vector<T> decoded;
+
+  struct tms foo;
+  const clock_t start = times(&foo);
+  for (long i = 0; i < samples; ++i)
+  {
+    bytes.clear();
+    encode_spikes(spikes, bytes);
+  }
+  const clock_t encoded = times(&foo);
+  for (long i = 0; i < samples; ++i)
+  {
+    decoded.clear();
+    decode_spikes(&bytes[0], &bytes[0] + bytes.size(), decoded);
+  }
+  const clock_t finish = times(&foo);
+
+  double_t max_error = decoded.size() == spikes.size() ? 0.0 : std::numeric_limits<double_t>::max();
+  for (size_t k = 0; k < spikes.size() && k < decoded.size(); ++k)
+    max_error = std::max(max_error, decoding_error(spikes[k], decoded[k]));
+
+  const double_t ticks = static_cast<double_t>(samples) * spikes.size() * sysconf(_SC_CLK_TCK);
+  def<long>(d, "entries", spikes.size());
+  def<long>(d, "bytes", spikes.size() * sizeof(T));
+  def<long>(d, "encoded_bytes", bytes.size());
+  def<double>(d, "encode_time", (encoded - start) / ticks);
+  def<double>(d, "decode_time", (finish - encoded) / ticks);
+  def<double>(d, "max_error", max_error);
+}
+
+void nest::Communicator::time_spike_codec(DictionaryDatum& d)
+{
+  long samples = 1000;
+  long n_segments = 120;
+  long segment_size = 40;
+  long max_gap = 50;
+  bool offgrid = false;
+  updateValue<long>(d, "samples", samples);
+  updateValue<long>(d, "segments", n_segments);
+  updateValue<long>(d, "segment_size", segment_size);
+  updateValue<long>(d, "max_gap", max_gap);
+  updateValue<bool>(d, "offgrid", offgrid);
+  if (samples < 1 || n_segments < 1 || segment_size < 0 || max_gap < 1)
+    throw BadProperty("samples, segments and max_gap must be positive, segment_size must not be negative.");
+
+  // segments of increasing GIDs, each followed by a marker, as in the
+  // send buffer of one process; a linear congruential generator makes
+  // the buffer the same in every run
+  std::vector<uint_t> gids;
+  unsigned long state = 1;
+  for (long s = 0; s < n_segments; ++s)
+  {
+    uint_t gid = 0;
+    for (long k = 0; k < segment_size; ++k)
+    {
+      state = state * 1103515245UL + 12345UL;
+      gid += 1 + (state >> 16) % max_gap;
+      gids.push_back(gid);
+    }
+    gids.push_back(0U);
+  }
+
+  if (!offgrid)
+  {
+    time_spike_codec_(gids, samples, d);
+    return;
+  }
+
+  std::vector<OffGridSpike> spikes;
+  for (size_t k = 0; k < gids.size(); ++k)
+  {
+    state = state * 1103515245UL + 12345UL;
+    const double_t offset = gids[k] == 0 ? 0.0
+      : Time::get_resolution().get_ms() * ((state >> 16) % 32768) / 32768.0;
+    spikes.push_back(OffGridSpike(gids[k], offset));
+  }
+  time_spike_codec_(spikes, samples, d);
+}
+
 void nest::Communicator::communicate_connector_properties(DictionaryDatum& dict)
 {
   // Confirm that we're having a MPI process
@@ -968,6 +1733,75 @@ void nest::Communicator::communicate(std::vector<double_t>& send_buffer,
   recv_buffer.swap(send_buffer);
 }
 
+void nest::Communicator::communicate(std::vector<long_t>& send_buffer,
+                                     std::vector<long_t>& recv_buffer,
+                                     std::vector<int>& displacements)
+{
+  displacements.resize(1);
+  displacements[0] = 0;
+  recv_buffer.swap(send_buffer);
+}
+
+/**
+ * routed communicate (on-grid) if compiled without MPI
+ */
+void nest::Communicator::communicate(std::vector<uint_t>& send_buffer,
+                                     std::vector<int>& send_counts,
+                                     std::vector<uint_t>& recv_buffer,
+                                     std::vector<int>& displacements,
+                                     std::vector<int>& recv_counts)
+{
+  displacements[0] = 0;
+  recv_counts.assign(1, send_counts[0]);
+  recv_buffer.swap(send_buffer);
+}
+
+/**
+ * routed communicate (off-grid) if compiled without MPI
+ */
+void nest::Communicator::communicate(std::vector<OffGridSpike>& send_buffer,
+                                     std::vector<int>& send_counts,
+                                     std::vector<OffGridSpike>& recv_buffer,
+                                     std::vector<int>& displacements,
+                                     std::vector<int>& recv_counts)
+{
+  displacements[0] = 0;
+  recv_counts.assign(1, send_counts[0]);
+  recv_buffer.swap(send_buffer);
+}
+
+void nest::Communicator::start_communicate(std::vector<uint_t>& send_buffer,
+                                           std::vector<uint_t>& recv_buffer,
+                                           std::vector<int>& displacements)
+{
+  communicate(send_buffer, recv_buffer, displacements);
+}
+
+void nest::Communicator::start_communicate(std::vector<OffGridSpike>& send_buffer,
+                                           std::vector<OffGridSpike>& recv_buffer,
+                                           std::vector<int>& displacements)
+{
+  communicate(send_buffer, recv_buffer, displacements);
+}
+
+void nest::Communicator::start_communicate(std::vector<uint_t>& send_buffer,
+                                           std::vector<int>& send_counts,
+                                           std::vector<uint_t>& recv_buffer,
+                                           std::vector<int>& displacements,
+                                           std::vector<int>& recv_counts)
+{
+  communicate(send_buffer, send_counts, recv_buffer, displacements, recv_counts);
+}
+
+void nest::Communicator::start_communicate(std::vector<OffGridSpike>& send_buffer,
+                                           std::vector<int>& send_counts,
+                                           std::vector<OffGridSpike>& recv_buffer,
+                                           std::vector<int>& displacements,
+                                           std::vector<int>& recv_counts)
+{
+  communicate(send_buffer, send_counts, recv_buffer, displacements, recv_counts);
+}
+
 void nest::Communicator::communicate(double_t send_val, std::vector<double_t>& recv_buffer)
 {
   recv_buffer.resize(1);
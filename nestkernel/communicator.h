@@ -165,9 +165,68 @@ public:
   static void communicate(std::vector<double_t>& send_buffer,
                           std::vector<double_t>& recv_buffer,
                           std::vector<int>& displacements);
+  static void communicate(std::vector<long_t>& send_buffer,
+                          std::vector<long_t>& recv_buffer,
+                          std::vector<int>& displacements);
   static void communicate(double_t, std::vector<double_t>&);
   static void communicate(std::vector<int_t>&);
 
+  /**
+   * Send spikes only to the processes that need them. The first
+   * send_counts[0] entries of send_buffer go to process 0, the next
+   * send_counts[1] entries to process 1, and so on. On return,
+   * recv_buffer holds the recv_counts[pid] entries received from
+   * process pid starting at displacements[pid].
+   */
+  static void communicate(std::vector<uint_t>& send_buffer,
+                          std::vector<int>& send_counts,
+                          std::vector<uint_t>& recv_buffer,
+                          std::vector<int>& displacements,
+                          std::vector<int>& recv_counts);
+  static void communicate(std::vector<OffGridSpike>& send_buffer,
+                          std::vector<int>& send_counts,
+                          std::vector<OffGridSpike>& recv_buffer,
+                          std::vector<int>& displacements,
+                          std::vector<int>& recv_counts);
+
+  /**
+   * Start an exchange of spikes, which finish_communicate() completes,
+   * so that the nodes can be updated while the spikes are in transit.
+   * The arguments are those of the corresponding communicate(), and no
+   * buffer may be used until the exchange is complete. The exchange of
+   * fixed size uses MPI_Iallgather. The adaptive exchange uses
+   * MPI_Iallgatherv and the targeted exchange MPI_Ialltoallv, both
+   * after a blocking exchange of the number of entries. Without MPI-3,
+   * the exchange is complete on return.
+   */
+  static void start_communicate(std::vector<uint_t>& send_buffer,
+                                std::vector<uint_t>& recv_buffer,
+                                std::vector<int>& displacements);
+  static void start_communicate(std::vector<OffGridSpike>& send_buffer,
+                                std::vector<OffGridSpike>& recv_buffer,
+                                std::vector<int>& displacements);
+  static void start_communicate(std::vector<uint_t>& send_buffer,
+                                std::vector<int>& send_counts,
+                                std::vector<uint_t>& recv_buffer,
+                                std::vector<int>& displacements,
+                                std::vector<int>& recv_counts);
+  static void start_communicate(std::vector<OffGridSpike>& send_buffer,
+                                std::vector<int>& send_counts,
+                                std::vector<OffGridSpike>& recv_buffer,
+                                std::vector<int>& displacements,
+                                std::vector<int>& recv_counts);
+
+  /**
+   * Complete the exchange started by start_communicate(), passing the
+   * same send buffer, receive buffer and displacements.
+   */
+  static void finish_communicate(std::vector<uint_t>& send_buffer,
+                                 std::vector<uint_t>& recv_buffer,
+                                 std::vector<int>& displacements);
+  static void finish_communicate(std::vector<OffGridSpike>& send_buffer,
+                                 std::vector<OffGridSpike>& recv_buffer,
+                                 std::vector<int>& displacements);
+
   /**
    * Collect GIDs for all nodes in a given node list across processes.
    * The NodeListType should be one of LocalNodeList, LocalLeafList, LocalChildList.
@@ -193,6 +252,12 @@ public:
   static double_t time_communicate(int num_bytes, int samples=1000);
   static double_t time_communicate_offgrid(int num_bytes, int samples=1000);
 
+  /**
+   * Time the encoder and decoder of the compressed exchange on a
+   * synthetic spike buffer, see TimeSpikeCodec.
+   */
+  static void time_spike_codec(DictionaryDatum& d);
+
   static std::string get_processor_name();
 
   static int get_rank();
@@ -202,11 +267,16 @@ public:
   static int get_send_buffer_size();
   static int get_recv_buffer_size();
   static bool get_use_Allgather();
+  static bool get_adaptive_exchange();
+  static bool get_compressed_exchange();
+  static size_t get_exchange_bytes();
   static bool get_initialized();
 
   static void set_num_threads(thread num_threads);
   static void set_buffer_sizes(int send_buffer_size, int recv_buffer_size);
   static void set_use_Allgather(bool use_Allgather);
+  static void set_adaptive_exchange(bool adaptive_exchange);
+  static void set_compressed_exchange(bool compressed_exchange);
 
 private:
 
@@ -219,10 +289,31 @@ private:
   static int recv_buffer_size_;  //!< size of receive buffer
   static bool initialized_;      //!< whether MPI is initialized
   static bool use_Allgather_;    //!< using Allgather communication
+  static bool adaptive_exchange_; //!< exchange the number of spikes before the spikes
+  static bool compressed_exchange_; //!< exchange spikes in the compressed wire format
+  static size_t exchange_bytes_; //!< bytes gathered by the last spike exchange
 
   static std::vector<int> comm_step_;  //!< array containing communication partner for each step.
   static uint_t COMM_OVERFLOW_ERROR;
 
+  /**
+   * Hysteresis of the buffer size in the adaptive exchange. The buffers
+   * grow to the largest send buffer plus a headroom of
+   * 1/ADAPTIVE_HEADROOM as soon as a send buffer exceeds them. They
+   * shrink to this size once it has been less than half their size
+   * for ADAPTIVE_SHRINK_DELAY exchanges in a row.
+   */
+  static const int ADAPTIVE_HEADROOM = 2;
+  static const int ADAPTIVE_SHRINK_DELAY = 16;
+  static int low_use_exchanges_; //!< number of adaptive exchanges in a row with little use of the buffers
+
+  static std::vector<unsigned char> compressed_send_buffer_; //!< encoded spikes of this process
+  static std::vector<unsigned char> compressed_recv_buffer_; //!< encoded spikes of all processes
+
+  static bool pending_overflow_check_;          //!< whether the exchange in progress may have overflown
+  static std::vector<int> pending_counts_;        //!< receive counts of the adaptive exchange in progress
+  static std::vector<int> pending_displacements_; //!< send displacements of the targeted exchange in progress
+
   static void init_communication();
 
   static void communicate_Allgather(std::vector<uint_t>& send_buffer,
@@ -251,6 +342,74 @@ private:
                                std::vector<OffGridSpike>& recv_buffer,
                                std::vector<int>& displacements);
   static void communicate_CPEX(std::vector<int_t>&);
+
+  template <typename T>
+  static void communicate_adaptive(std::vector<T>& send_buffer,
+                                   std::vector<T>& recv_buffer,
+                                   std::vector<int>& displacements);
+  static void adapt_buffer_sizes(int max_send_count);
+
+  template <typename T>
+  static void communicate_Alltoallv(std::vector<T>& send_buffer,
+                                    std::vector<int>& send_counts,
+                                    std::vector<T>& recv_buffer,
+                                    std::vector<int>& displacements,
+                                    std::vector<int>& recv_counts);
+
+  /**
+   * Gather the spikes of all processes in the compressed wire format.
+   * The number of bytes is exchanged first, as in the adaptive
+   * exchange, then the encoded spikes.
+   */
+  template <typename T>
+  static void communicate_compressed(std::vector<T>& send_buffer,
+                                     std::vector<T>& recv_buffer,
+                                     std::vector<int>& displacements);
+
+  /**
+   * Encode a buffer of spikes separated by markers in the compressed
+   * wire format. Each run of spikes up to a marker is written as the
+   * number of spikes followed by the differences between consecutive
+   * GIDs, as zigzag varints, so that the order of the spikes is kept.
+   * The offsets of off-grid spikes follow their GIDs as 32-bit fixed
+   * point fractions of the resolution.
+   */
+  static void encode_spikes(const std::vector<uint_t>& spikes, std::vector<unsigned char>& bytes);
+  static void encode_spikes(const std::vector<OffGridSpike>& spikes, std::vector<unsigned char>& bytes);
+
+  /**
+   * Decode the spikes encoded by encode_spikes() in [begin, end) and
+   * append them, separated by markers, to spikes.
+   */
+  static void decode_spikes(const unsigned char* begin, const unsigned char* end,
+                            std::vector<uint_t>& spikes);
+  static void decode_spikes(const unsigned char* begin, const unsigned char* end,
+                            std::vector<OffGridSpike>& spikes);
+
+  /**
+   * Encode and decode spikes samples times and store the times and
+   * the sizes in d, see time_spike_codec().
+   */
+  template <typename T>
+  static void time_spike_codec_(const std::vector<T>& spikes, long samples, DictionaryDatum& d);
+
+  template <typename T>
+  static void start_Allgather(std::vector<T>& send_buffer,
+                              std::vector<T>& recv_buffer);
+  template <typename T>
+  static void start_Allgatherv(std::vector<T>& send_buffer,
+                               std::vector<T>& recv_buffer,
+                               std::vector<int>& displacements);
+  template <typename T>
+  static void start_Alltoallv(std::vector<T>& send_buffer,
+                              std::vector<int>& send_counts,
+                              std::vector<T>& recv_buffer,
+                              std::vector<int>& displacements,
+                              std::vector<int>& recv_counts);
+  template <typename T>
+  static void finish_Allgather(std::vector<T>& send_buffer,
+                               std::vector<T>& recv_buffer,
+                               std::vector<int>& displacements);
 };
 
 }
@@ -315,8 +474,39 @@ public:
   static void communicate(std::vector<double_t>& send_buffer,
                           std::vector<double_t>& recv_buffer,
                           std::vector<int>& displacements);
+  static void communicate(std::vector<long_t>& send_buffer,
+                          std::vector<long_t>& recv_buffer,
+                          std::vector<int>& displacements);
   static void communicate(double_t, std::vector<double_t>&);
   static void communicate(std::vector<int_t>&) {}
+  static void communicate(std::vector<uint_t>& send_buffer,
+                          std::vector<int>& send_counts,
+                          std::vector<uint_t>& recv_buffer,
+                          std::vector<int>& displacements,
+                          std::vector<int>& recv_counts);
+  static void communicate(std::vector<OffGridSpike>& send_buffer,
+                          std::vector<int>& send_counts,
+                          std::vector<OffGridSpike>& recv_buffer,
+                          std::vector<int>& displacements,
+                          std::vector<int>& recv_counts);
+  static void start_communicate(std::vector<uint_t>& send_buffer,
+                                std::vector<uint_t>& recv_buffer,
+                                std::vector<int>& displacements);
+  static void start_communicate(std::vector<OffGridSpike>& send_buffer,
+                                std::vector<OffGridSpike>& recv_buffer,
+                                std::vector<int>& displacements);
+  static void start_communicate(std::vector<uint_t>& send_buffer,
+                                std::vector<int>& send_counts,
+                                std::vector<uint_t>& recv_buffer,
+                                std::vector<int>& displacements,
+                                std::vector<int>& recv_counts);
+  static void start_communicate(std::vector<OffGridSpike>& send_buffer,
+                                std::vector<int>& send_counts,
+                                std::vector<OffGridSpike>& recv_buffer,
+                                std::vector<int>& displacements,
+                                std::vector<int>& recv_counts);
+  static void finish_communicate(std::vector<uint_t>&, std::vector<uint_t>&, std::vector<int>&) {}
+  static void finish_communicate(std::vector<OffGridSpike>&, std::vector<OffGridSpike>&, std::vector<int>&) {}
 
    /**
    * Collect GIDs for all nodes in a given node list across processes.
@@ -347,6 +537,7 @@ public:
   static bool grng_synchrony(unsigned long) {return true;}
   static double_t time_communicate(int, int){return 0.0;}
   static double_t time_communicate_offgrid(int, int){return 0.0;}
+  static void time_spike_codec(DictionaryDatum&) {}
 
   static std::string get_processor_name();
 
@@ -357,11 +548,16 @@ public:
   static int get_send_buffer_size();
   static int get_recv_buffer_size();
   static bool get_use_Allgather();
+  static bool get_adaptive_exchange();
+  static bool get_compressed_exchange();
+  static size_t get_exchange_bytes();
   static bool get_initialized();
 
   static void set_num_threads(thread num_threads);
   static void set_buffer_sizes(int send_buffer_size, int recv_buffer_size);
   static void set_use_Allgather(bool use_Allgather);
+  static void set_adaptive_exchange(bool adaptive_exchange);
+  static void set_compressed_exchange(bool compressed_exchange);
 
 private:
 
@@ -374,6 +570,9 @@ private:
   static int recv_buffer_size_;  //!< size of receive buffer
   static bool initialized_;      //!< whether MPI is initialized
   static bool use_Allgather_;    //!< using Allgather communication
+  static bool adaptive_exchange_; //!< exchange the number of spikes before the spikes
+  static bool compressed_exchange_; //!< exchange spikes in the compressed wire format
+  static size_t exchange_bytes_; //!< bytes gathered by the last spike exchange
 };
 
 inline std::string Communicator::get_processor_name()
@@ -425,6 +624,21 @@ inline bool Communicator::get_use_Allgather()
   return use_Allgather_;
 }
 
+inline bool Communicator::get_adaptive_exchange()
+{
+  return adaptive_exchange_;
+}
+
+inline bool Communicator::get_compressed_exchange()
+{
+  return compressed_exchange_;
+}
+
+inline size_t Communicator::get_exchange_bytes()
+{
+  return exchange_bytes_;
+}
+
 inline bool Communicator::get_initialized()
 {
   return initialized_;
@@ -446,6 +660,16 @@ inline void Communicator::set_use_Allgather(bool use_Allgather)
   use_Allgather_ = use_Allgather;
 }
 
+inline void Communicator::set_adaptive_exchange(bool adaptive_exchange)
+{
+  adaptive_exchange_ = adaptive_exchange;
+}
+
+inline void Communicator::set_compressed_exchange(bool compressed_exchange)
+{
+  compressed_exchange_ = compressed_exchange;
+}
+
 } // namespace nest
 
 #endif /* #ifndef COMMUNICATOR_H */
@@ -0,0 +1,485 @@
+/*
+ *  compact_connector.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* BeginDocumentation
+  Name: static_synapse_compact - Static synapse with a compact connection store.
+
+  Description:
+   static_synapse_compact transmits events exactly like static_synapse,
+   but stores the connections of a source in a more compact layout. Each
+   connection holds the 32 bit index of its target in the target table of
+   the target's thread, 32 bits packing the delay in steps and the
+   receiver port, and a weight, which is kept in a separate array. This
+   needs 16 bytes per connection instead of 40 bytes for static_synapse
+   on 64 bit machines. Before the first event is delivered, the
+   connections are sorted by the GID of their targets, so that delivery
+   visits the targets in the order in which they were created.
+
+  Parameters:
+   weight  double - Weight of the connection
+   delay   double - Delay in ms
+
+  Remarks:
+   The delay must not exceed 16777215 steps and the receiver port must
+   not exceed 255. Since sorting changes the port numbers of the
+   connections, connection handles obtained from FindConnections or
+   GetConnections become invalid if further connections are created from
+   the same source.
+
+  Transmits: SpikeEvent, RateEvent, CurrentEvent, ConductanceEvent, DoubleDataEvent, DataLoggingRequest
+
+  FirstVersion: October 2026
+  SeeAlso: synapsedict, static_synapse, static_synapse_hom_wd
+*/
+
+#ifndef COMPACTCONNECTOR_H
+#define COMPACTCONNECTOR_H
+
+#include "dictutils.h"
+#include "nest_time.h"
+#include "connector.h"
+#include "connection.h"
+#include "node.h"
+#include "event.h"
+#include "generic_connector_model.h"
+#include <algorithm>
+#include <vector>
+
+#include "nest_names.h"
+#include "connectiondatum.h"
+
+namespace nest {
+
+/**
+ * Connector storing static connections in a compact, target-sorted layout.
+ * Instead of a vector of ConnectionT objects, which each carry a virtual
+ * table pointer, a pointer to the target, the receiver port, the weight
+ * and the delay, CompactConnector keeps three parallel arrays:
+ * - the index of each target in the target table of the connector's
+ *   thread (see ConnectionManager::get_target_index()),
+ * - the delay in steps (lower 24 bits) and the receiver port (upper
+ *   8 bits) packed into one 32 bit word,
+ * - the weights.
+ * Connections are sorted by target GID before they are accessed by port,
+ * so that send() visits the targets in the order of their creation, and
+ * thus mostly in the order of their addresses in memory. Connections to
+ * the same target keep the order of their creation.
+ *
+ * ConnectionT is only used to hold default parameters and to check new
+ * connections. It must be derived from ConnectionHetWD and must not have
+ * any dynamics, i.e. its send() must only transmit weight and delay.
+ */
+template <typename ConnectionT>
+class CompactConnector : public Connector
+{
+  typedef GenericConnectorModelBase< ConnectionT, CommonSynapseProperties, CompactConnector > ConnectorModelT;
+
+ public:
+
+  /**
+   * Default constructor.
+   * \param cm ConnectorModel, which created this Connector.
+   */
+  CompactConnector(ConnectorModelT &cm);
+
+  virtual ~CompactConnector() {}
+
+  void register_connection(Node&, Node&, bool);
+  void register_connection(Node&, Node&, double_t, double_t, bool);
+  void register_connection(Node&, Node&, DictionaryDatum&, bool);
+  void register_connection(Node&, Node&, double_t, double_t, long_t, DictionaryDatum&, bool);
+
+  /**
+   * Register a new connection at the sender side, using the parameters
+   * of the given connection.
+   */
+  void register_connection(Node&, Node&, ConnectionT&, port, bool);
+
+  std::vector<long>* find_connections(DictionaryDatum params) const;
+
+  void get_connections(size_t source_gid, size_t thrd, size_t synapse_id, ArrayDatum &conns) const;
+  void get_connections(size_t source_gid, size_t target_gid, size_t thrd, size_t synapse_id, ArrayDatum &conns) const;
+
+  size_t get_num_connections() const
+  {
+    return targets_.size();
+  }
+
+  void reserve(size_t n)
+  {
+    targets_.reserve(targets_.size() + n);
+    delay_rport_.reserve(delay_rport_.size() + n);
+    weights_.reserve(weights_.size() + n);
+  }
+
+  void get_status(DictionaryDatum & d) const;
+  void set_status(const DictionaryDatum & d);
+  void get_synapse_status(DictionaryDatum & d, port p) const;
+  void set_synapse_status(const DictionaryDatum & d, port p);
+
+  /**
+   * Send an event to all targets of this connector.
+   */
+  void send(Event& e);
+
+  /**
+   * Re-calibrate the delays in all connections.
+   */
+  void calibrate(const TimeConverter &);
+
+ private:
+
+  static const uint_t delay_bits_ = 24;
+  static const uint_t delay_mask_ = (1u << delay_bits_) - 1;
+  static const uint_t max_rport_ = (1u << (32 - delay_bits_)) - 1;
+
+  /**
+   * Orders connection indices by the GIDs of the targets of the connections.
+   */
+  struct TargetOrder_
+  {
+    TargetOrder_(const std::vector<index>& gids) : gids_(gids) {}
+    bool operator()(index a, index b) const { return gids_[a] < gids_[b]; }
+    const std::vector<index>& gids_;
+  };
+
+  /**
+   * Pack delay (in steps) and receiver port into one word.
+   * @throws BadDelay, BadProperty if they do not fit.
+   */
+  static uint_t pack_(long_t delay, rport receptor);
+
+  /**
+   * Sort the connections by target GID, if they were added out of order.
+   */
+  void sort_connections_() const;
+
+  /**
+   * Return the target of connection p.
+   */
+  Node* get_target_(index p) const;
+
+  mutable std::vector<uint_t> targets_;      //!< Target indices in the target table
+  mutable std::vector<uint_t> delay_rport_;  //!< Delays in steps and receiver ports
+  mutable std::vector<double_t> weights_;    //!< Weights
+  mutable bool sorted_;                      //!< True if the connections are sorted by target GID
+
+  thread thread_;                            //!< Thread of all targets of this connector
+  ConnectorModelT &connector_model_;
+};
+
+template< typename ConnectionT >
+CompactConnector< ConnectionT >::CompactConnector(ConnectorModelT &cm)
+  : sorted_(true),
+    thread_(0),
+    connector_model_(cm)
+{}
+
+template< typename ConnectionT >
+void CompactConnector< ConnectionT >::register_connection(Node& s, Node& r, bool count_connections)
+{
+  ConnectionT cn = ConnectionT( connector_model_.get_default_connection() );
+  connector_model_.used_default_delay();
+
+  register_connection(s, r, cn, connector_model_.get_receptor_type(), count_connections);
+}
+
+template< typename ConnectionT >
+void CompactConnector< ConnectionT >::register_connection(Node& s, Node& r, double_t w, double_t d, bool count_connections)
+{
+  // see GenericConnectorBase::register_connection() and bug #217
+  if ( !connector_model_.check_delay( Time(Time::step(Time(Time::ms(d)).get_steps())).get_ms() ) )
+      throw BadDelay(d);
+
+  ConnectionT cn = ConnectionT( connector_model_.get_default_connection() );
+  cn.set_weight(w);
+  cn.set_delay(d);
+
+  register_connection(s, r, cn, connector_model_.get_receptor_type(), count_connections);
+}
+
+template< typename ConnectionT >
+void CompactConnector< ConnectionT >::register_connection(Node& s, Node& r, DictionaryDatum& d, bool count_connections)
+{
+  double_t delay = 0.0;
+  if ( updateValue<double_t>(d, names::delay, delay) )
+  {
+    if ( !connector_model_.check_delay( Time(Time::step(Time(Time::ms(delay)).get_steps())).get_ms() ) )
+      throw BadDelay(delay);
+  }
+  else
+    connector_model_.used_default_delay();
+
+  ConnectionT cn = ConnectionT( connector_model_.get_default_connection() );
+  cn.set_status(d, connector_model_);
+
+  port receptor_type = connector_model_.get_receptor_type();
+
+#ifdef HAVE_MUSIC
+  // We allow music_channel as alias for receptor_type during connection setup
+  updateValue<long_t>(d, names::music_channel, receptor_type);
+#endif
+  updateValue<long_t>(d, names::receptor_type, receptor_type);
+
+  register_connection(s, r, cn, receptor_type, count_connections);
+}
+
+template< typename ConnectionT >
+void CompactConnector< ConnectionT >::register_connection(Node& s, Node& r, double_t w, double_t d, long_t receptor_type, DictionaryDatum& p, bool count_connections)
+{
+  ConnectionT cn = ConnectionT( connector_model_.get_default_connection() );
+  cn.set_weight(w);
+  cn.set_delay(d);
+  if ( !p->empty() )
+    cn.set_status(p, connector_model_);
+
+  register_connection(s, r, cn, receptor_type, count_connections);
+}
+
+template< typename ConnectionT >
+void CompactConnector< ConnectionT >::register_connection(Node& s, Node& r, ConnectionT &cn, port receptor_type, bool count_connections)
+{
+  cn.check_connection(s, r, receptor_type, 0.0);
+  const uint_t delay_rport = pack_(cn.get_delay_steps(), cn.get_rport());
+  const uint_t target = connector_model_.network().get_target_index(r);
+
+  if ( targets_.empty() )
+    thread_ = r.get_thread();
+  else if ( r.get_gid() < get_target_(targets_.size() - 1)->get_gid() )
+    sorted_ = false;
+
+  targets_.push_back(target);
+  delay_rport_.push_back(delay_rport);
+  weights_.push_back(cn.get_weight());
+
+  if (count_connections)
+    connector_model_.increment_num_connections();
+}
+
+template< typename ConnectionT >
+std::vector<long>* CompactConnector< ConnectionT >::find_connections(DictionaryDatum params) const
+{
+  sort_connections_();
+
+  long postgid = -1;
+  bool use_postgid = updateValue<long>(params, names::target, postgid);
+
+  std::vector<long>* p  = new std::vector<long>;
+  for (size_t i = 0; i < targets_.size(); ++i)
+    if (!use_postgid || get_target_(i)->get_gid() == static_cast<index>(postgid))
+      p->push_back(i);
+  return p;
+}
+
+template< typename ConnectionT >
+void CompactConnector< ConnectionT >::get_connections(size_t source_gid, size_t thrd, size_t synapse_id, ArrayDatum &conns) const
+{
+  sort_connections_();
+
+  for (size_t prt = 0; prt < targets_.size(); ++prt)
+    conns.push_back(new ConnectionDatum(ConnectionID(source_gid, get_target_(prt)->get_gid(), thrd, synapse_id, prt)));
+}
+
+template< typename ConnectionT >
+void CompactConnector< ConnectionT >::get_connections(size_t source_gid, size_t target_gid, size_t thrd, size_t synapse_id, ArrayDatum &conns) const
+{
+  sort_connections_();
+
+  for (size_t prt = 0; prt < targets_.size(); ++prt)
+    if (get_target_(prt)->get_gid() == target_gid)
+      conns.push_back(new ConnectionDatum(ConnectionID(source_gid, target_gid, thrd, synapse_id, prt)));
+}
+
+template< typename ConnectionT >
+void CompactConnector< ConnectionT >::get_status(DictionaryDatum & d) const
+{
+  sort_connections_();
+
+  initialize_property_array(d, names::targets);
+  initialize_property_array(d, names::rports);
+  initialize_property_array(d, names::weights);
+  initialize_property_array(d, names::delays);
+
+  for (size_t i = 0; i < targets_.size(); ++i)
+  {
+    append_property<index>(d, names::targets, get_target_(i)->get_gid());
+    append_property<long_t>(d, names::rports, delay_rport_[i] >> delay_bits_);
+    append_property<double_t>(d, names::weights, weights_[i]);
+    append_property<double_t>(d, names::delays, Time(Time::step(delay_rport_[i] & delay_mask_)).get_ms());
+  }
+}
+
+template< typename ConnectionT >
+void CompactConnector< ConnectionT >::set_status(const DictionaryDatum & d)
+{
+  sort_connections_();
+
+  // all arrays in the dictionary must have one entry per connection
+  TokenMap::iterator iter;
+  for (iter = d->begin(); iter != d->end(); ++iter)
+  {
+    ArrayDatum* ad = dynamic_cast<ArrayDatum*>((iter->second).datum());
+    if (ad != 0)
+      if (ad->size() != targets_.size())
+        throw DimensionMismatch(targets_.size(), ad->size());
+  }
+
+  for (size_t i = 0; i < targets_.size(); ++i)
+  {
+    double_t delay;
+    if ( set_property<double_t>(d, names::delays, i, delay) )
+    {
+      if (!connector_model_.check_delay(delay))
+        throw BadDelay(delay);
+      delay_rport_[i] = pack_(Time(Time::ms(delay)).get_steps(), delay_rport_[i] >> delay_bits_);
+    }
+    set_property<double_t>(d, names::weights, i, weights_[i]);
+  }
+}
+
+template< typename ConnectionT >
+void CompactConnector< ConnectionT >::get_synapse_status(DictionaryDatum & d, port p) const
+{
+  assert (p >= 0 && static_cast<size_t>(p) < targets_.size());
+  sort_connections_();
+
+  def<long>(d, names::rport, delay_rport_[p] >> delay_bits_);
+  def<long>(d, names::target, get_target_(p)->get_gid());
+  (*d)[names::type] = LiteralDatum(names::synapse);
+  def<double_t>(d, names::weight, weights_[p]);
+  def<double_t>(d, names::delay, Time(Time::step(delay_rport_[p] & delay_mask_)).get_ms());
+}
+
+template< typename ConnectionT >
+void CompactConnector< ConnectionT >::set_synapse_status(const DictionaryDatum & d, port p)
+{
+  assert (p >= 0 && static_cast<size_t>(p) < targets_.size());
+  sort_connections_();
+
+  double_t delay;
+  if (updateValue<double_t>(d, names::delay, delay))
+  {
+    if (!connector_model_.check_delay(delay))
+      throw BadDelay(delay);
+    delay_rport_[p] = pack_(Time(Time::ms(delay)).get_steps(), delay_rport_[p] >> delay_bits_);
+  }
+  updateValue<double_t>(d, names::weight, weights_[p]);
+}
+
+template< typename ConnectionT >
+void CompactConnector< ConnectionT >::send(Event& e)
+{
+  sort_connections_();
+
+  const std::vector<Node*>& targets = connector_model_.network().get_targets(thread_);
+  const size_t n = targets_.size();
+  for (size_t i = 0; i < n; ++i)
+  {
+    const uint_t delay_rport = delay_rport_[i];
+    e.set_port(i);
+    e.set_weight(weights_[i]);
+    e.set_delay(delay_rport & delay_mask_);
+    e.set_receiver(*targets[targets_[i]]);
+    e.set_rport(delay_rport >> delay_bits_);
+    e();
+  }
+}
+
+template< typename ConnectionT >
+void CompactConnector< ConnectionT >::calibrate(const TimeConverter &tc)
+{
+  for (size_t i = 0; i < delay_rport_.size(); ++i)
+  {
+    long_t delay = tc.from_old_steps(delay_rport_[i] & delay_mask_).get_steps();
+    if (delay == 0)
+      delay = 1;
+    delay_rport_[i] = pack_(delay, delay_rport_[i] >> delay_bits_);
+  }
+}
+
+template< typename ConnectionT >
+uint_t CompactConnector< ConnectionT >::pack_(long_t delay, rport receptor)
+{
+  if (delay < 0 || static_cast<ulong_t>(delay) > delay_mask_)
+    throw BadDelay(Time(Time::step(delay)).get_ms());
+
+  if (receptor < 0 || static_cast<ulong_t>(receptor) > max_rport_)
+    throw BadProperty("The receiver port of a compact connection must be in [0, 255].");
+
+  return static_cast<uint_t>(delay) | (static_cast<uint_t>(receptor) << delay_bits_);
+}
+
+template< typename ConnectionT >
+void CompactConnector< ConnectionT >::sort_connections_() const
+{
+  if (sorted_)
+    return;
+
+  std::vector<index> gids(targets_.size());
+  std::vector<index> order(targets_.size());
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    gids[i] = get_target_(i)->get_gid();
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), TargetOrder_(gids));
+
+  std::vector<uint_t> targets(order.size());
+  std::vector<uint_t> delay_rport(order.size());
+  std::vector<double_t> weights(order.size());
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    targets[i] = targets_[order[i]];
+    delay_rport[i] = delay_rport_[order[i]];
+    weights[i] = weights_[order[i]];
+  }
+
+  targets_.swap(targets);
+  delay_rport_.swap(delay_rport);
+  weights_.swap(weights);
+  sorted_ = true;
+}
+
+template< typename ConnectionT >
+inline
+Node* CompactConnector< ConnectionT >::get_target_(index p) const
+{
+  return connector_model_.network().get_targets(thread_)[targets_[p]];
+}
+
+/**
+ * Register a static synapse that uses the CompactConnector.
+ */
+template <class ConnectionT>
+index register_prototype_connection_compact(Network& net, const std::string &name)
+{
+  ConnectorModel* prototype = new GenericConnectorModel < ConnectionT,
+                                                          CommonSynapseProperties,
+                                                          CompactConnector < ConnectionT >
+                                                        > (net, name);
+
+  return net.register_synapse_prototype(prototype);
+}
+
+} // namespace
+
+#endif /* #ifndef COMPACTCONNECTOR_H */
@@ -97,6 +97,16 @@ class ConnectionHetWD : public Connection
    */
   double_t get_delay() const;
 
+  /**
+   * Return the delay of the connection in steps
+   */
+  long_t get_delay_steps() const;
+
+  /**
+   * Return the weight of the connection
+   */
+  double_t get_weight() const;
+
   /**
    * Set the delay of the connection
    */
@@ -120,6 +130,18 @@ double_t ConnectionHetWD::get_delay() const
   return Time(Time::step(delay_)).get_ms();
 }
 
+inline
+long_t ConnectionHetWD::get_delay_steps() const
+{
+  return delay_;
+}
+
+inline
+double_t ConnectionHetWD::get_weight() const
+{
+  return weight_;
+}
+
 inline
 void ConnectionHetWD::set_delay(const double_t delay)
 {
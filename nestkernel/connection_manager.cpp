@@ -34,8 +34,11 @@
 namespace nest
 {
 
+const uint_t ConnectionManager::no_target_index_ = std::numeric_limits<uint_t>::max();
+
 ConnectionManager::ConnectionManager(Network& net)
-        : net_(net)
+        : net_(net),
+          record_new_sources_(false)
 {}
 
 ConnectionManager::~ConnectionManager()
@@ -67,18 +70,18 @@ void ConnectionManager::init_()
       synapsedict_->insert(name, prototypes_.size() - 1);
     }
 
-  std::vector< google::sparsetable< std::vector< syn_id_connector > > > tmp(
-  net_.get_num_threads(), google::sparsetable< std::vector< syn_id_connector > >());
+  std::vector<SourceTable>(net_.get_num_threads()).swap(connections_);
 
-  connections_.swap(tmp);
+  std::vector< std::vector<Node*> >(net_.get_num_threads()).swap(targets_);
+  std::vector< std::vector<uint_t> >(net_.get_num_threads()).swap(target_index_);
+  std::vector< std::vector<index> >(net_.get_num_threads()).swap(new_sources_);
 }
 
 void ConnectionManager::delete_connections_()
 {
-  for (tVVVConnector::iterator it = connections_.begin(); it != connections_.end(); ++it)
-    for (tVVConnector::nonempty_iterator iit = it->nonempty_begin(); iit != it->nonempty_end(); ++iit)
-      for ( tVConnector::iterator iiit = iit->begin(); iiit != iit->end(); ++iiit)
-	delete (*iiit).connector;
+  for (std::vector<SourceTable>::iterator it = connections_.begin(); it != connections_.end(); ++it)
+    for (std::vector<Connector*>::const_iterator c = it->get_connectors().begin(); c != it->get_connectors().end(); ++c)
+      delete *c;
 }
 
 void ConnectionManager::clear_prototypes_()
@@ -198,22 +201,55 @@ bool ConnectionManager::get_user_set_delay_extrema() const
   return user_set_delay_extrema;
 }
 
-index ConnectionManager::validate_connector(thread tid, index gid, index syn_id)
+Connector* ConnectionManager::validate_connector(thread tid, index gid, index syn_id)
 {
   assert_valid_syn_id(syn_id);
 
-  if (connections_[tid].size() < net_.size())
-    connections_[tid].resize(net_.size());
-
-  int syn_vec_index = get_syn_vec_index(tid, gid, syn_id);
-  if ( syn_vec_index == -1 )
+  Connector* c = get_connector_(tid, gid, syn_id);
+  if ( c == 0 )
   {
-    struct syn_id_connector sc = {syn_id, prototypes_[syn_id]->get_connector()};
+    c = prototypes_[syn_id]->get_connector();
+    if ( connections_[tid].insert(gid, syn_id, c) && record_new_sources_ )
+      new_sources_[tid].push_back(gid);
+  }
+  return c;
+}
 
-    connections_[tid].mutating_get(gid).push_back(sc);
-    syn_vec_index = connections_[tid].get(gid).size() - 1;
+void ConnectionManager::take_new_sources(std::vector<index>& gids)
+{
+  gids.clear();
+  for (size_t t = 0; t < new_sources_.size(); ++t)
+  {
+    gids.insert(gids.end(), new_sources_[t].begin(), new_sources_[t].end());
+    std::vector<index>().swap(new_sources_[t]);
   }
-  return static_cast<index>(syn_vec_index);
+
+  std::sort(gids.begin(), gids.end());
+  gids.erase(std::unique(gids.begin(), gids.end()), gids.end());
+}
+
+void ConnectionManager::get_sources(std::vector<index>& gids) const
+{
+  gids.clear();
+  for (size_t t = 0; t < connections_.size(); ++t)
+    for (size_t r = 0; r < connections_[t].get_num_rows(); ++r)
+      gids.push_back(connections_[t].get_gid(r));
+
+  std::sort(gids.begin(), gids.end());
+  gids.erase(std::unique(gids.begin(), gids.end()), gids.end());
+}
+
+void ConnectionManager::set_record_new_sources(bool record)
+{
+  record_new_sources_ = record;
+  for (size_t t = 0; t < new_sources_.size(); ++t)
+    std::vector<index>().swap(new_sources_[t]);
+}
+
+void ConnectionManager::compress_sources()
+{
+  for (size_t t = 0; t < connections_.size(); ++t)
+    connections_[t].compress();
 }
 
 index ConnectionManager::copy_synapse_prototype(index old_id, std::string new_name)
@@ -231,6 +267,16 @@ index ConnectionManager::copy_synapse_prototype(index old_id, std::string new_na
 void ConnectionManager::get_status(DictionaryDatum& d) const
 {
   def<long>(d, "num_connections", get_num_connections());
+
+  size_t num_sources = 0;
+  size_t memory = 0;
+  for (size_t t = 0; t < connections_.size(); ++t)
+  {
+    num_sources += connections_[t].get_num_rows();
+    memory += connections_[t].get_memory();
+  }
+  def<long>(d, "num_connected_sources", num_sources);
+  def<long>(d, "connection_table_bytes", memory);
 }
 
 void ConnectionManager::set_prototype_status(index syn_id, const DictionaryDatum& d)
@@ -250,10 +296,9 @@ DictionaryDatum ConnectionManager::get_prototype_status(index syn_id) const
 
 DictionaryDatum ConnectionManager::get_synapse_status(index gid, index syn_id, port p, thread tid)
 {
-  int syn_vec_index = get_syn_vec_index (tid,gid,syn_id);
   assert_valid_syn_id(syn_id);
   DictionaryDatum dict(new Dictionary);
-  connections_[tid].get(gid)[syn_vec_index].connector->get_synapse_status(dict, p);
+  get_connector_(tid, gid, syn_id)->get_synapse_status(dict, p);
   (*dict)[names::source] = gid;
   (*dict)[names::synapse_model] = LiteralDatum(get_synapse_prototype(syn_id).get_name());
 
@@ -263,8 +308,7 @@ DictionaryDatum ConnectionManager::get_synapse_status(index gid, index syn_id, p
 void ConnectionManager::set_synapse_status(index gid, index syn_id, port p, thread tid, const DictionaryDatum& dict)
 {
   assert_valid_syn_id(syn_id);
-  int syn_vec_index = get_syn_vec_index (tid,gid,syn_id);
-  connections_[tid].get(gid)[syn_vec_index].connector->set_synapse_status(dict, p);
+  get_connector_(tid, gid, syn_id)->set_synapse_status(dict, p);
 }
 
 
@@ -276,8 +320,7 @@ DictionaryDatum ConnectionManager::get_connector_status(const Node& node, index
   index gid = node.get_gid();
   for (thread tid = 0; tid < net_.get_num_threads(); tid++)
   {
-    index syn_vec_index = validate_connector(tid, gid, syn_id);
-    connections_[tid].get(gid)[syn_vec_index].connector->get_status(dict);
+    validate_connector(tid, gid, syn_id)->get_status(dict);
   }
   return dict;
 }
@@ -289,8 +332,7 @@ DictionaryDatum ConnectionManager::get_connector_status(index gid, index syn_id)
   DictionaryDatum dict(new Dictionary);
   for (thread tid = 0; tid < net_.get_num_threads(); tid++)
   {
-    index syn_vec_index = validate_connector(tid, gid, syn_id);
-    connections_[tid].get(gid)[syn_vec_index].connector->get_status(dict);
+    validate_connector(tid, gid, syn_id)->get_status(dict);
   }
   return dict;
 }
@@ -300,8 +342,7 @@ void ConnectionManager::set_connector_status(Node& node, index syn_id, thread ti
   assert_valid_syn_id(syn_id);
 
   index gid = node.get_gid();
-  index syn_vec_index = validate_connector(tid, gid, syn_id);
-  connections_[tid].get(gid)[syn_vec_index].connector->set_status(dict);
+  validate_connector(tid, gid, syn_id)->set_status(dict);
 }
 
 ArrayDatum ConnectionManager::find_connections(DictionaryDatum params)
@@ -336,28 +377,23 @@ ArrayDatum ConnectionManager::find_connections(DictionaryDatum params)
   {
     if (have_synmodel)
     {
-      int syn_vec_index = get_syn_vec_index(t, source, syn_id);
-      if (source < connections_[t].size() && syn_vec_index != -1)
-        find_connections(connectome, t, source, syn_vec_index, syn_id, params);
+      if (get_connector_(t, source, syn_id) != 0)
+        find_connections(connectome, t, source, syn_id, params);
     }
     else
     {
-      if (static_cast<size_t>(source) < connections_[t].size())
-        for (syn_id = 0; syn_id < prototypes_.size(); ++syn_id)
-        {
-          int syn_vec_index = get_syn_vec_index(t, source, syn_id);
-          if (syn_vec_index != -1)
-            find_connections(connectome, t, source, syn_vec_index, syn_id, params);
-        }
+      for (syn_id = 0; syn_id < prototypes_.size(); ++syn_id)
+        if (get_connector_(t, source, syn_id) != 0)
+          find_connections(connectome, t, source, syn_id, params);
     }
   }
   
   return connectome;
 }
 
-void ConnectionManager::find_connections(ArrayDatum& connectome, thread t, index source, int syn_vec_index, index syn_id, DictionaryDatum params)
+void ConnectionManager::find_connections(ArrayDatum& connectome, thread t, index source, index syn_id, DictionaryDatum params)
 {
-  std::vector<long>* p = connections_[t].get(source)[syn_vec_index].connector->find_connections(params);
+  std::vector<long>* p = get_connector_(t, source, syn_id)->find_connections(params);
   for (size_t i = 0; i < p->size(); ++i)
     connectome.push_back(ConnectionDatum(ConnectionID(source, 0, t, syn_id, (*p)[i])));
   delete p;
@@ -431,22 +467,25 @@ void ConnectionManager::get_connections(ArrayDatum& connectome, TokenArray const
 	    ArrayDatum conns_in_thread;
 	    size_t num_connections_in_thread=0;
 	    // Count how many connections we will have.
-	    for(index source_id=1; source_id< connections_[t].size();++source_id)
+	    const SourceTable& table = connections_[t];
+	    for (size_t r = 0; r < table.get_num_rows(); ++r)
 	    {
-              int syn_vec_index = get_syn_vec_index(t, source_id, syn_id);
-              if(syn_vec_index > -1)
-                num_connections_in_thread += connections_[t].get(source_id)[syn_vec_index].connector->get_num_connections();
+              Connector* c = table.get(r, syn_id);
+              if (c != 0)
+                num_connections_in_thread += c->get_num_connections();
 	    }
 		
 #ifdef _OPENMP
 #pragma omp critical
 #endif
 	    conns_in_thread.reserve(num_connections_in_thread);
-	    for (index source_id=1; source_id< connections_[t].size(); ++source_id)
+	    std::vector<long_t> rows;
+	    table.get_rows_ordered(rows);
+	    for (size_t i = 0; i < rows.size(); ++i)
 	    {
-              int syn_vec_index = get_syn_vec_index(t, source_id, syn_id);
-              if(syn_vec_index > -1)
-                get_connections(conns_in_thread, source_id, t, syn_id);
+              Connector* c = table.get(rows[i], syn_id);
+              if (c != 0)
+                c->get_connections(table.get_gid(rows[i]), t, syn_id, conns_in_thread);
 	    }
 	    if (conns_in_thread.size()>0)
 	    {
@@ -472,11 +511,12 @@ void ConnectionManager::get_connections(ArrayDatum& connectome, TokenArray const
 	    ArrayDatum conns_in_thread;
 	    size_t num_connections_in_thread=0;
 	    // Count how many connections we will have maximally.
-	    for(index source_id=1; source_id< connections_[t].size();++source_id)
+	    const SourceTable& table = connections_[t];
+	    for (size_t r = 0; r < table.get_num_rows(); ++r)
 	    {
-              int syn_vec_index = get_syn_vec_index(t, source_id, syn_id);
-              if(syn_vec_index > -1)
-                num_connections_in_thread += connections_[t].get(source_id)[syn_vec_index].connector->get_num_connections();
+              Connector* c = table.get(r, syn_id);
+              if (c != 0)
+                num_connections_in_thread += c->get_num_connections();
 	    }
 		
 #ifdef _OPENMP
@@ -484,15 +524,18 @@ void ConnectionManager::get_connections(ArrayDatum& connectome, TokenArray const
 #endif
 	    conns_in_thread.reserve(num_connections_in_thread);
 
-	    for (index source_id=1; source_id< connections_[t].size(); ++source_id)
+	    std::vector<long_t> rows;
+	    table.get_rows_ordered(rows);
+	    for (size_t i = 0; i < rows.size(); ++i)
 	    {
-              int syn_vec_index = get_syn_vec_index(t, source_id, syn_id);
-              if(syn_vec_index > -1)
+              Connector* c = table.get(rows[i], syn_id);
+              if (c != 0)
               {
+                const index source_id = table.get_gid(rows[i]);
                 for (index t_id=0; t_id< target->size(); ++t_id)
                 {
                   size_t target_id = target->get(t_id);
-                  connections_[t].get(source_id)[syn_vec_index].connector->get_connections(source_id, target_id, t, syn_id, conns_in_thread);
+                  c->get_connections(source_id, target_id, t, syn_id, conns_in_thread);
                 }
               }
 	    }
@@ -519,11 +562,12 @@ void ConnectionManager::get_connections(ArrayDatum& connectome, TokenArray const
 	      ArrayDatum conns_in_thread;
 	      size_t num_connections_in_thread=0;
 	      // Count how many connections we will have.
-	      for(index source_id=1; source_id< connections_[t].size();++source_id)
+	      const SourceTable& table = connections_[t];
+	      for (size_t r = 0; r < table.get_num_rows(); ++r)
 	      {
-                int syn_vec_index = get_syn_vec_index(t, source_id, syn_id);
-                if(syn_vec_index > -1)
-                  num_connections_in_thread += connections_[t].get(source_id)[syn_vec_index].connector->get_num_connections();
+                Connector* c = table.get(r, syn_id);
+                if (c != 0)
+                  num_connections_in_thread += c->get_num_connections();
 	      }
 		
 #ifdef _OPENMP
@@ -533,8 +577,8 @@ void ConnectionManager::get_connections(ArrayDatum& connectome, TokenArray const
 	      for( index s=0; s< source->size(); ++s)
 	      {
 		  size_t source_id= source->get(s);
-                  int syn_vec_index = get_syn_vec_index(t, source_id, syn_id);
-                  if (source_id < connections_[t].size() && syn_vec_index > -1)
+                  Connector* c = get_connector_(t, source_id, syn_id);
+                  if (c != 0)
 		  {
                     if (target == 0)
                     {
@@ -545,7 +589,7 @@ void ConnectionManager::get_connections(ArrayDatum& connectome, TokenArray const
                       for (index t_id=0; t_id< target->size(); ++t_id)
                       {
                         size_t target_id = target->get(t_id);
-                        connections_[t].get(source_id)[syn_vec_index].connector->get_connections(source_id, target_id, t, syn_id, conns_in_thread );
+                        c->get_connections(source_id, target_id, t, syn_id, conns_in_thread );
                       }
                     }
 		  }
@@ -567,28 +611,42 @@ void ConnectionManager::get_connections(ArrayDatum& connectome, TokenArray const
 // Return connections to all targets 
 void ConnectionManager::get_connections(ArrayDatum& connectome, index source, thread t, index syn_id) const
 {
-  int syn_vec_index = get_syn_vec_index(t, source, syn_id);
-  size_t n_ports=connections_[t].get(source)[syn_vec_index].connector->get_num_connections(); 
+  Connector* c = get_connector_(t, source, syn_id);
+  size_t n_ports=c->get_num_connections(); 
   connectome.reserve(n_ports);
-  connections_[t].get(source)[syn_vec_index].connector->get_connections(source,t,syn_id,connectome);
+  c->get_connections(source,t,syn_id,connectome);
 }
 
 void ConnectionManager::connect(Node& s, Node& r, index s_gid, thread tid, index syn, bool count_connections)
 {
-  index syn_vec_index = validate_connector(tid, s_gid, syn);
-  connections_[tid].get(s_gid)[syn_vec_index].connector->register_connection(s, r, count_connections);
+  validate_connector(tid, s_gid, syn)->register_connection(s, r, count_connections);
 }
 
 void ConnectionManager::connect(Node& s, Node& r, index s_gid, thread tid, double_t w, double_t d, index syn, bool count_connections)
 {
-  index syn_vec_index = validate_connector(tid, s_gid, syn);
-  connections_[tid].get(s_gid)[syn_vec_index].connector->register_connection(s, r, w, d, count_connections);
+  validate_connector(tid, s_gid, syn)->register_connection(s, r, w, d, count_connections);
 }
 
 void ConnectionManager::connect(Node& s, Node& r, index s_gid, thread tid, DictionaryDatum& p, index syn, bool count_connections)
 {
-  index syn_vec_index = validate_connector(tid, s_gid, syn);
-  connections_[tid].get(s_gid)[syn_vec_index].connector->register_connection(s, r, p, count_connections);
+  validate_connector(tid, s_gid, syn)->register_connection(s, r, p, count_connections);
+}
+
+void ConnectionManager::connect(Node& s, Node& r, index s_gid, thread tid, double_t w, double_t d, long_t receptor_type,
+                                DictionaryDatum& p, index syn, bool count_connections)
+{
+  validate_connector(tid, s_gid, syn)->register_connection(s, r, w, d, receptor_type, p, count_connections);
+}
+
+bool ConnectionManager::check_delay(index syn, double_t d)
+{
+  assert_valid_syn_id(syn);
+  return prototypes_[syn]->check_delay(d);
+}
+
+void ConnectionManager::reserve_connections(thread tid, index s_gid, index syn, size_t n)
+{
+  validate_connector(tid, s_gid, syn)->reserve(n);
 }
 
 
@@ -643,9 +701,38 @@ bool ConnectionManager::connect(ArrayDatum& conns)
 
 void ConnectionManager::send(thread t, index sgid, Event& e)
 {
-  if (sgid < connections_[t].size())
-    for (size_t i = 0; i < connections_[t].get(sgid).size(); ++i)
-      connections_[t].get(sgid)[i].connector->send(e);
+  const SourceTable& table = connections_[t];
+  const long_t r = table.find(sgid);
+  if (r < 0)
+    return;
+
+  for (size_t s = 0; s < table.get_num_slots(); ++s)
+  {
+    Connector* c = table.get_slot(r, s);
+    if (c != 0)
+      c->send(e);
+  }
+}
+
+index ConnectionManager::get_target_index(Node& r)
+{
+  const thread t = r.get_thread();
+  const index gid = r.get_gid();
+
+  // the index is sized for all existing nodes on first use and at
+  // least doubled afterwards, so that interleaved Create and Connect
+  // calls do not resize it for each new target
+  std::vector<uint_t>& target_index = target_index_[t];
+  if (target_index.size() <= gid)
+    target_index.resize(std::max(net_.size(), 2 * target_index.size()), no_target_index_);
+
+  if (target_index[gid] == no_target_index_)
+  {
+    target_index[gid] = targets_[t].size();
+    targets_[t].push_back(&r);
+  }
+
+  return target_index[gid];
 }
 
 size_t ConnectionManager::get_num_connections() const
@@ -658,6 +745,24 @@ size_t ConnectionManager::get_num_connections() const
   return num_connections;
 } 
 
+size_t ConnectionManager::get_num_connections(thread t, index sgid) const
+{
+  const SourceTable& table = connections_[t];
+  const long_t r = table.find(sgid);
+  if (r < 0)
+    return 0;
+
+  size_t num_connections = 0;
+  for (size_t s = 0; s < table.get_num_slots(); ++s)
+  {
+    const Connector* c = table.get_slot(r, s);
+    if (c != 0)
+      num_connections += c->get_num_connections();
+  }
+
+  return num_connections;
+}
+
 void ConnectionManager::increment_num_connections(index syn_id, size_t num)
 {
   assert_valid_syn_id(syn_id);
@@ -35,6 +35,7 @@
 #include "arraydatum.h"
 
 #include "sparsetable.h"
+#include "source_table.h"
 
 namespace nest
 {
@@ -48,16 +49,6 @@ class ConnectorModel;
  */
 class ConnectionManager
 {
-  struct syn_id_connector
-  {
-    index syn_id;
-    Connector* connector;
-  };
-
-  typedef std::vector< syn_id_connector > tVConnector;
-  typedef google::sparsetable< tVConnector > tVVConnector;
-  typedef std::vector< tVVConnector > tVVVConnector;
-
 public:
   ConnectionManager(Network& net);
   ~ConnectionManager();
@@ -107,8 +98,7 @@ public:
   void set_connector_status(Node& node, index syn_id, thread tid, const DictionaryDatum& d);
   
   ArrayDatum find_connections(DictionaryDatum params);
-//   void find_connections(ArrayDatum& connectome, thread t, index source, index syn_id, DictionaryDatum params);
-  void find_connections(ArrayDatum& connectome, thread t, index source, int syn_vec_index, index syn_id, DictionaryDatum params);
+  void find_connections(ArrayDatum& connectome, thread t, index source, index syn_id, DictionaryDatum params);
   /**
    * Return connections between pairs of neurons.
    * The params dictionary can have the following entries:
@@ -137,6 +127,13 @@ public:
   
   size_t get_num_connections() const;
 
+  /**
+   * Return the number of connections from the source with GID sgid to
+   * nodes on thread t. These are the connections send() delivers an
+   * event to, in the order in which it delivers it.
+   */
+  size_t get_num_connections(thread t, index sgid) const;
+
   const Time get_min_delay() const;
   const Time get_max_delay() const;
 
@@ -153,6 +150,26 @@ public:
   void connect(Node& s, Node& r, index s_gid, thread tid, double_t w, double_t d, index syn, bool count_connections = true);
   void connect(Node& s, Node& r, index s_gid, thread tid, DictionaryDatum& p, index syn, bool count_connections = true);
 
+  /**
+   * Connect with given weight, delay and receptor type and further
+   * parameters in p. The delay is not checked, see Network::data_connect().
+   */
+  void connect(Node& s, Node& r, index s_gid, thread tid, double_t w, double_t d, long_t receptor_type,
+               DictionaryDatum& p, index syn, bool count_connections = true);
+
+  /**
+   * Reserve memory for n further connections of type syn from the
+   * source with GID s_gid to targets on thread tid.
+   */
+  void reserve_connections(thread tid, index s_gid, index syn, size_t n);
+
+  /**
+   * Check that delay d is valid for synapse type syn, updating its
+   * delay extrema if necessary.
+   * @see ConnectorModel::check_delay()
+   */
+  bool check_delay(index syn, double_t d);
+
   /** 
    * Experimental bulk connector. See documentation in network.h
    */
@@ -162,6 +179,49 @@ public:
 
   void send(thread t, index sgid, Event& e);
 
+  /**
+   * Return the index of node r in the table of connection targets of
+   * its thread, entering r into the table if it is not yet there.
+   * Connectors that store this index instead of a pointer to the
+   * target (see CompactConnector) look the target up in the table
+   * returned by get_targets() when they deliver an event.
+   */
+  index get_target_index(Node& r);
+
+  /**
+   * Return the table of connection targets of thread t.
+   */
+  const std::vector<Node*>& get_targets(thread t) const;
+
+  /**
+   * Move the GIDs of all sources that have received their first
+   * outgoing connection on this process since the last call into
+   * gids, sorted and without duplicates. The Scheduler uses this to
+   * tell the owners of these sources that their spikes are needed
+   * here (see Scheduler::build_spike_routes_()).
+   */
+  void take_new_sources(std::vector<index>& gids);
+
+  /**
+   * Store the GIDs of all sources with connections on this process in
+   * gids, sorted and without duplicates.
+   */
+  void get_sources(std::vector<index>& gids) const;
+
+  /**
+   * Set whether sources that receive their first outgoing connection
+   * are recorded for take_new_sources(). Only the targeted exchange
+   * needs them. Switching the recording drops the recorded sources.
+   */
+  void set_record_new_sources(bool);
+
+  /**
+   * Merge the sources added to the connection tables during the
+   * construction into their sorted parts. Called by the Scheduler
+   * before each simulation.
+   */
+  void compress_sources();
+
   /**
    * Resize the structures for the Connector objects if necessary.
    * This function should be called after number of threads, min_delay, max_delay, 
@@ -181,19 +241,38 @@ private:
   Dictionary* synapsedict_; //!< The synapsedict (owned by the network)
 
   /**
-   * A 3-dim structure to hold the Connector objects which in turn hold the connection
-   * information.
-   * - First dim: A std::vector for each local thread
-   * - Second dim: A std::vector for each node on each thread
-   * - Third dim: A std::vector for each synapse prototype, holding the Connector objects
+   * The Connector objects, which in turn hold the connection
+   * information, in one SourceTable for each local thread. A table
+   * only holds the sources with connections on its thread.
+   */
+  std::vector<SourceTable> connections_;
+
+  /**
+   * The table of connection targets for each thread and the position
+   * of each node in the table of its thread. The positions are only
+   * kept for threads with CompactConnector targets, by GID, and hold
+   * no_target_index_ for nodes that are not in the table.
    */
-  tVVVConnector connections_;
+  std::vector< std::vector<Node*> > targets_;
+  std::vector< std::vector<uint_t> > target_index_;
+  static const uint_t no_target_index_;
+
+  /**
+   * The sources that got their first connector on each thread since
+   * the last call to take_new_sources().
+   */
+  std::vector< std::vector<index> > new_sources_;
+  bool record_new_sources_; //!< Whether new_sources_ is filled
   
   void init_();
   void delete_connections_();
   void clear_prototypes_();
   
-  index validate_connector(thread tid, index gid, index syn_id);
+  /**
+   * Return the connector of source gid for synapse type syn_id on
+   * thread tid and create it if it does not exist.
+   */
+  Connector* validate_connector(thread tid, index gid, index syn_id);
 
   /**
    * Return pointer to protoype for given synapse id.
@@ -208,15 +287,11 @@ private:
   void assert_valid_syn_id(index syn_id) const;
 
   /**
-   * For a given thread, source gid and synapse id, return the correct
-   * index (syn_vec_index) into the connection store, so that one can
-   * access the corresponding connector using
-   * \code
-       connections_[tid][gid][syn_vec_index].
-     \endcode
-   * @returns the index of the Connector or -1 if it does not exist.
-   */  
-  int get_syn_vec_index(thread tid, index gid, index syn_id) const;
+   * For a given thread, source gid and synapse id, return the
+   * connector in the connection store.
+   * @returns the Connector or 0 if it does not exist.
+   */
+  Connector* get_connector_(thread tid, index gid, index syn_id) const;
 };
 
 inline
@@ -233,6 +308,12 @@ void ConnectionManager::assert_valid_syn_id(index syn_id) const
     throw UnknownSynapseType(syn_id);
 }
 
+inline
+const std::vector<Node*>& ConnectionManager::get_targets(thread t) const
+{
+  return targets_[t];
+}
+
 inline
 bool ConnectionManager::has_user_prototypes() const
 {
@@ -240,19 +321,16 @@ bool ConnectionManager::has_user_prototypes() const
 }
 
 inline
-int ConnectionManager::get_syn_vec_index(thread tid, index gid, index syn_id) const
+Connector* ConnectionManager::get_connector_(thread tid, index gid, index syn_id) const
 {
-  if (static_cast<size_t>(tid) >= connections_.size() || gid >= connections_[tid].size() || connections_[tid][gid].size() == 0)
-    return -1;
+  if (static_cast<size_t>(tid) >= connections_.size())
+    return 0;
 
-  index syn_vec_index = 0;
-  while ( syn_vec_index < connections_[tid][gid].size() && connections_[tid][gid][syn_vec_index].syn_id != syn_id )
-    syn_vec_index++;
+  const long_t r = connections_[tid].find(gid);
+  if (r < 0)
+    return 0;
 
-  if (syn_vec_index == connections_[tid][gid].size())
-    return -1;
-  
-  return syn_vec_index;  
+  return connections_[tid].get(r, syn_id);
 }
 
 } // namespace
@@ -27,6 +27,8 @@
 #include "event.h"
 #include "exceptions.h"
 #include "spikecounter.h"
+#include "dictutils.h"
+#include "nest_names.h"
 
 class Dictionary;
 
@@ -46,6 +48,22 @@ class Connector
   virtual void register_connection(Node&, Node&, bool) = 0;
   virtual void register_connection(Node&, Node&, double_t, double_t, bool) = 0;
   virtual void register_connection(Node&, Node&, DictionaryDatum&, bool) = 0;
+
+  /**
+   * Register a new connection with the given weight, delay in ms and
+   * receptor type. The delay must have been checked against the delay
+   * extrema of the connector model before, see Network::data_connect().
+   * Further parameters of the connection are taken from p, which may be
+   * empty. The default implementation creates a parameter dictionary and
+   * is only meant for connectors that do not support bulk creation.
+   */
+  virtual void register_connection(Node&, Node&, double_t, double_t, long_t, DictionaryDatum&, bool);
+
+  /**
+   * Reserve memory for n further connections.
+   */
+  virtual void reserve(size_t) {}
+
   virtual std::vector<long>* find_connections(DictionaryDatum) const = 0;
   /**
    * Return a list of all connections. 
@@ -68,6 +86,17 @@ class Connector
   virtual void calibrate(const TimeConverter &) = 0;
   virtual void trigger_update_weight(const std::vector<spikecounter> &){};
 };
+
+inline
+void Connector::register_connection(Node& s, Node& r, double_t w, double_t d, long_t receptor_type,
+                                    DictionaryDatum& p, bool count_connections)
+{
+  DictionaryDatum pd(new Dictionary(*p));
+  def<double_t>(pd, names::weight, w);
+  def<double_t>(pd, names::delay, d);
+  def<long_t>(pd, names::receptor_type, receptor_type);
+  register_connection(s, r, pd, count_connections);
+}
  
 
 }
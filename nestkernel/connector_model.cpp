@@ -60,64 +60,36 @@ ConnectorModel::ConnectorModel(const ConnectorModel &cm, std::string name) :
 
 bool ConnectorModel::check_delay(double_t new_delay)
 {
-
-  if (new_delay < Time::get_resolution().get_ms())
-  {
-    net_.message(SLIInterpreter::M_ERROR, "check_delay()", "Delay must be greater than or equal to resolution");
-    return false;
-  }
-
-  // if already simulated, the new delay has to be checked against the
-  // min_delay and the max_delay which have been used during simulation
-  if (net_.get_simulated())
-  {
-    Time sim_min_delay = Time::step(net_.get_min_delay());
-    Time sim_max_delay = Time::step(net_.get_max_delay());
-    bool bad_min_delay = new_delay < sim_min_delay.get_ms();
-    bool bad_max_delay = new_delay > sim_max_delay.get_ms();
- 
-    if (bad_min_delay || bad_max_delay)
-      {
-	net_.message(SLIInterpreter::M_ERROR, "check_delay()", "Delay cannot be set: Simulate has been called already");
-	return false;
-      }
-  }
-  
-  bool bad_min_delay = new_delay < min_delay_.get_ms();
-  bool bad_max_delay = new_delay > max_delay_.get_ms();
-
-  if (!bad_min_delay && !bad_max_delay)
-    return true;
-
-  if (user_set_delay_extrema_)
-    {
-      if (bad_min_delay)
-	net_.message(SLIInterpreter::M_ERROR, "check_delay()", "Delay must be greater than or equal to min_delay");
-      if (bad_max_delay)
-	net_.message(SLIInterpreter::M_ERROR, "check_delay()", "Delay must be smaller than or equal to max_delay");
-      return false;    
-    }
-
-  if (bad_min_delay)
-    update_delay_extrema(new_delay, max_delay_.get_ms());
-
-  if (bad_max_delay)
-    update_delay_extrema(min_delay_.get_ms(), new_delay);
-
-  return true;
+  return check_delays(new_delay, new_delay);
 }
 
 bool ConnectorModel::check_delays(double_t new_delay1, double_t new_delay2)
 {
-  double_t ldelay = new_delay1 < new_delay2 ? new_delay1 : new_delay2;
-  double_t hdelay = new_delay1 < new_delay2 ? new_delay2 : new_delay1;
+  const double_t ldelay = new_delay1 < new_delay2 ? new_delay1 : new_delay2;
+  const double_t hdelay = new_delay1 < new_delay2 ? new_delay2 : new_delay1;
+
+  // Connections may be created by several threads at once, which all
+  // read and update the extrema, so the whole check is one critical
+  // section. This also keeps the error messages of the threads apart.
+  bool valid;
+#ifdef _OPENMP
+#pragma omp critical (delay_extrema)
+#endif
+  valid = check_delays_(ldelay, hdelay);
+
+  return valid;
+}
 
+bool ConnectorModel::check_delays_(double_t ldelay, double_t hdelay)
+{
   if (ldelay < Time::get_resolution().get_ms())
   {
     net_.message(SLIInterpreter::M_ERROR, "check_delay()", "Delay must be greater than or equal to resolution");
     return false;
   }
  
+  // if already simulated, the new delay has to be checked against the
+  // min_delay and the max_delay which have been used during simulation
   if (net_.get_simulated())
   {
     Time sim_min_delay = Time::step(net_.get_min_delay());
@@ -147,18 +119,22 @@ bool ConnectorModel::check_delays(double_t new_delay1, double_t new_delay2)
       return false;    
     }
 
-  if (bad_min_delay)
-    update_delay_extrema(ldelay, max_delay_.get_ms());
-  
-  if (bad_max_delay)
-    update_delay_extrema(min_delay_.get_ms(), hdelay);
+  update_delay_extrema_(ldelay, hdelay);
 
   return true;
-
 }
 
 void ConnectorModel::update_delay_extrema(const double_t mindelay_cand, 
 					  const double_t maxdelay_cand )
+{ 
+#ifdef _OPENMP
+#pragma omp critical (delay_extrema)
+#endif
+  update_delay_extrema_(mindelay_cand, maxdelay_cand);
+}
+
+void ConnectorModel::update_delay_extrema_(const double_t mindelay_cand, 
+					   const double_t maxdelay_cand )
 { 
   if (mindelay_cand < min_delay_.get_ms())
     min_delay_ = Time(Time::ms(mindelay_cand));
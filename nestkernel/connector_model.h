@@ -74,6 +74,7 @@ class ConnectorModel
 
   /**
    * Check, if delay is in agreement with min_delay, max_delay and resolution.
+   * Several threads may check delays at once.
    */
   bool check_delay(double_t new_delay);
   bool check_delays(double_t delay1, double_t delay2);
@@ -101,6 +102,12 @@ class ConnectorModel
   bool user_set_delay_extrema_;     //!< Flag indicating if the user set the delay extrema.
 
  private:
+  //! Check the delays with the lock on the extrema held.
+  bool check_delays_(double_t ldelay, double_t hdelay);
+
+  //! Update the extrema with the lock on them held.
+  void update_delay_extrema_(const double_t mindelay, const double_t maxdelay);
+
   std::string name_;
 };
 
@@ -138,6 +145,10 @@ void ConnectorModel::set_max_delay(const Time &max_delay)
 inline
 void ConnectorModel::increment_num_connections(size_t num)
 {
+  // connections may be created by several threads at once
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
   num_connections_ += num;
 }
 
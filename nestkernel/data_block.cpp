@@ -0,0 +1,97 @@
+/*
+ *  data_block.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "data_block.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+nest::DataBlock::DataBlock()
+  : gids_(),
+    n_vars_(0),
+    first_step_(0),
+    interval_(1),
+    n_times_(0),
+    data_()
+{}
+
+size_t nest::DataBlock::add_node(index gid, size_t n_vars)
+{
+  // all nodes record the same variables
+  assert(gids_.empty() || n_vars == n_vars_);
+  n_vars_ = n_vars;
+
+  const size_t old_size = row_size_();
+  gids_.push_back(gid);
+
+  if ( n_times_ > 0 )
+  {
+    // move the rows apart from the last one, making room for the new column
+    data_.resize(n_times_ * row_size_(), std::numeric_limits<double_t>::max());
+    for ( size_t r = n_times_ ; r-- > 0 ; )
+    {
+      std::copy_backward(data_.begin() + r * old_size,
+                         data_.begin() + ( r + 1 ) * old_size,
+                         data_.begin() + r * row_size_() + old_size);
+      std::fill(data_.begin() + r * row_size_() + old_size,
+                data_.begin() + ( r + 1 ) * row_size_(),
+                std::numeric_limits<double_t>::max());
+    }
+  }
+
+  return gids_.size() - 1;
+}
+
+void nest::DataBlock::extend(long_t first_step, long_t last_step,
+                             long_t interval, long_t max_step)
+{
+  assert(interval > 0);
+
+  if ( n_times_ == 0 )
+  {
+    first_step_ = first_step;
+    interval_ = interval;
+  }
+  assert(interval == interval_);
+
+  if ( last_step < first_step_ )
+    return;
+
+  // reserve the whole recording window at once, so that the block
+  // is not copied when it grows during later simulations
+  if ( max_step >= last_step )
+    data_.reserve(( ( max_step - first_step_ ) / interval_ + 1 ) * row_size_());
+
+  const size_t n_times = ( last_step - first_step_ ) / interval_ + 1;
+  if ( n_times <= n_times_ )
+    return;
+
+  data_.resize(n_times * row_size_(), std::numeric_limits<double_t>::max());
+  n_times_ = n_times;
+}
+
+void nest::DataBlock::clear()
+{
+  data_.clear();
+  n_times_ = 0;
+}
@@ -0,0 +1,165 @@
+/*
+ *  data_block.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef DATA_BLOCK_H
+#define DATA_BLOCK_H
+
+#include "nest.h"
+
+#include <vector>
+
+namespace nest
+{
+
+  /**
+   * Contiguous block of analog data, recorded by a multimeter.
+   *
+   * The block holds one row per recording time, and each row holds one
+   * column per recorded node with one entry per recorded variable, so
+   * that the data form a [time x nodes x variables] array in row-major
+   * order. The recording times are the multiples of the recording
+   * interval from the first step on.
+   *
+   * The data loggers of the recorded nodes write their values directly
+   * into their column, see UniversalDataLogger. Rows are added before
+   * the nodes record into them, so that the block does not grow while
+   * the nodes are updated. Entries that no node has written hold
+   * std::numeric_limits<double_t>::max(), as in DataLoggingReply.
+   *
+   * @ingroup Devices
+   */
+  class DataBlock
+  {
+  public:
+    DataBlock();
+
+    /**
+     * Add a column for a node and return its index. Rows that exist
+     * already get the new column.
+     */
+    size_t add_node(index gid, size_t n_vars);
+
+    /**
+     * Add rows for all multiples of interval up to last_step, starting
+     * at first_step if the block is empty. Memory for all rows up to
+     * max_step is reserved; max_step is negative if the end of the
+     * recording window is not known.
+     */
+    void extend(long_t first_step, long_t last_step, long_t interval, long_t max_step);
+
+    /**
+     * Remove all rows, keeping the columns.
+     */
+    void clear();
+
+    /**
+     * Return the entries of the given node at the given recording step,
+     * or 0 if the block has no row for the step.
+     */
+    double_t* get_entry(long_t step, size_t column);
+
+    size_t get_num_times() const;
+    size_t get_num_nodes() const;
+    size_t get_num_vars() const;
+
+    /**
+     * Return the step of the given row.
+     */
+    long_t get_step(size_t row) const;
+
+    const std::vector<index>& get_gids() const;
+
+    /**
+     * Return the data of the given row, get_num_nodes() * get_num_vars()
+     * entries.
+     */
+    const double_t* get_row(size_t row) const;
+
+  private:
+    size_t row_size_() const;
+
+    std::vector<index> gids_;     //!< GIDs of the columns
+    size_t n_vars_;               //!< variables per node
+    long_t first_step_;           //!< step of the first row
+    long_t interval_;             //!< steps between rows
+    size_t n_times_;              //!< number of rows
+    std::vector<double_t> data_;  //!< the rows
+  };
+
+  inline
+  size_t DataBlock::row_size_() const
+  {
+    return gids_.size() * n_vars_;
+  }
+
+  inline
+  double_t* DataBlock::get_entry(long_t step, size_t column)
+  {
+    if ( step < first_step_ )
+      return 0;
+
+    const size_t row = ( step - first_step_ ) / interval_;
+    if ( row >= n_times_ )
+      return 0;
+
+    return &data_[row * row_size_() + column * n_vars_];
+  }
+
+  inline
+  size_t DataBlock::get_num_times() const
+  {
+    return n_times_;
+  }
+
+  inline
+  size_t DataBlock::get_num_nodes() const
+  {
+    return gids_.size();
+  }
+
+  inline
+  size_t DataBlock::get_num_vars() const
+  {
+    return n_vars_;
+  }
+
+  inline
+  long_t DataBlock::get_step(size_t row) const
+  {
+    return first_step_ + row * interval_;
+  }
+
+  inline
+  const std::vector<index>& DataBlock::get_gids() const
+  {
+    return gids_;
+  }
+
+  inline
+  const double_t* DataBlock::get_row(size_t row) const
+  {
+    return &data_[0] + row * row_size_();
+  }
+
+} // namespace
+
+#endif
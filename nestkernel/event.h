@@ -32,6 +32,7 @@
 namespace nest{
 
   class Node;
+  class DataBlock;
 
 /**
  * Encapsulates information which is sent between Nodes.
@@ -490,6 +491,13 @@ namespace nest{
     /** Create event for given time stamp and vector of recordables. */
     DataLoggingRequest(const Time&, const std::vector<Name>&);
 
+    /**
+     * Create event for given time stamp and vector of recordables,
+     * asking the node to write its data to the given column of a block.
+     */
+    DataLoggingRequest(const Time&, const std::vector<Name>&,
+                       DataBlock&, size_t);
+
     DataLoggingRequest* clone() const;
 
     void operator()();
@@ -499,6 +507,12 @@ namespace nest{
 
     /** Access to vector of recordables. */
     const std::vector<Name>& record_from() const;
+
+    /** Block to record to, or NULL if data are to be sent in replies. */
+    DataBlock* get_block() const;
+
+    /** Column of the recorded node in the block. */
+    size_t get_block_column() const;
     
   private:
     
@@ -510,13 +524,18 @@ namespace nest{
      * @note This pointer shall be NULL unless the event is sent by a connection routine.
      */
     std::vector<Name> const * const record_from_;
+
+    DataBlock* block_;     //!< block to record to, NULL unless set on connection
+    size_t block_column_;  //!< column in block_
   };
 
   inline
   DataLoggingRequest::DataLoggingRequest()
     : Event(), 
       recording_interval_(Time::neg_inf()),
-      record_from_(0)
+      record_from_(0),
+      block_(0),
+      block_column_(0)
   {}
 
   inline
@@ -524,7 +543,20 @@ namespace nest{
 					 const std::vector<Name>& recs)
     : Event(), 
       recording_interval_(rec_int),
-      record_from_(&recs)
+      record_from_(&recs),
+      block_(0),
+      block_column_(0)
+  {}
+
+  inline
+  DataLoggingRequest::DataLoggingRequest(const Time& rec_int,
+					 const std::vector<Name>& recs,
+					 DataBlock& block, size_t column)
+    : Event(), 
+      recording_interval_(rec_int),
+      record_from_(&recs),
+      block_(&block),
+      block_column_(column)
   {}
 
   inline
@@ -553,6 +585,18 @@ namespace nest{
     return *record_from_;
   }
 
+  inline
+  DataBlock* DataLoggingRequest::get_block() const
+  {
+    return block_;
+  }
+
+  inline
+  size_t DataLoggingRequest::get_block_column() const
+  {
+    return block_column_;
+  }
+
   /**
    * Provide logged data through request transmitting reference.
    * @see DataLoggingRequest
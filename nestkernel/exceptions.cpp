@@ -333,3 +333,13 @@ std::string nest::NumericalInstability::message()
       << "gsl_error_tol for the model.";
   return msg.str();
 }
+
+nest::WrappedThreadException::WrappedThreadException(std::exception& exc)
+  : SLIException(exc.what())
+{
+  SLIException* se = dynamic_cast<SLIException*>(&exc);
+  if ( se )
+    message_ = se->message();
+  else
+    message_ = std::string("C++ exception: ") + exc.what();
+}
@@ -707,6 +707,26 @@ namespace nest {
       const std::string model_;
   };
 
+  /**
+   * Exception to carry an exception raised in one thread of a
+   * parallel section to the code after the section, where it can be
+   * thrown again. It keeps the name and message of the original
+   * exception, so the SLI error is the same as if the exception had
+   * been raised outside the parallel section.
+   * @ingroup KernelExceptions
+   */
+  class WrappedThreadException: public SLIException
+  {
+  public:
+    WrappedThreadException(std::exception& exc);
+    ~WrappedThreadException() throw() {}
+
+    std::string message() { return message_; }
+
+    private:
+      std::string message_;
+  };
+
 #ifdef HAVE_MUSIC
   /**
    * Exception to be thrown if a music_event_out_proxy is generated, but the music port is unmapped.
@@ -97,6 +97,21 @@ class GenericConnectorBase : public Connector
    * Register a new connection at the sender side.
    */ 
   void register_connection(Node&, Node&, ConnectionT&, port, bool);
+
+  /**
+   * Register a new connection at the sender side.
+   * Use given weight, delay and receptor type and the parameters in the
+   * given dictionary. The delay is not checked.
+   */
+  void register_connection(Node&, Node&, double_t, double_t, long_t, DictionaryDatum&, bool);
+
+  /**
+   * Reserve memory for n further connections.
+   */
+  void reserve(size_t n)
+  {
+    connections_.reserve(connections_.size() + n);
+  }
  
  /**
    * Register many connections in bulk. 
@@ -269,6 +284,35 @@ void GenericConnectorBase< ConnectionT, CommonPropertiesT, ConnectorModelT >::re
     connector_model_.increment_num_connections();
 }
 
+template< typename ConnectionT, typename CommonPropertiesT, typename ConnectorModelT > 
+void GenericConnectorBase< ConnectionT, CommonPropertiesT, ConnectorModelT >::register_connection(Node& s, Node& r, double_t w, double_t d, long_t receptor_type, DictionaryDatum& p, bool count_connections)
+{
+  // The connection is set up in place to avoid copying the default
+  // connection twice. It is removed again if it cannot be established.
+  connections_.push_back(connector_model_.get_default_connection());
+  ConnectionT &cn = connections_.back();
+  try
+  {
+    cn.set_weight(w);
+    cn.set_delay(d);
+    if ( !p->empty() )
+      cn.set_status(p, connector_model_);
+    cn.check_connection(s, r, receptor_type, t_lastspike_);
+  }
+  catch (...)
+  {
+    connections_.pop_back();
+    throw;
+  }
+
+  Node* n = connector_model_.get_registering_node();
+  if(n!=0 && connections_.size()==1)
+    n->register_connector(*this);
+
+  if (count_connections)
+    connector_model_.increment_num_connections();
+}
+
 template< typename ConnectionT, typename CommonPropertiesT, typename ConnectorModelT > 
 std::vector<long>* GenericConnectorBase< ConnectionT, CommonPropertiesT, ConnectorModelT >::find_connections(DictionaryDatum params) const
 {
@@ -280,6 +280,9 @@ void GenericConnectorModelBase< ConnectionT, CommonPropertiesT, ConnectorT >::se
 template< typename ConnectionT, typename CommonPropertiesT, typename ConnectorT >
 ConnectorT * GenericConnectorModelBase< ConnectionT, CommonPropertiesT, ConnectorT >::get_connector()
 {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
   num_connectors_++;
   return new ConnectorT(*this);
 }
@@ -339,13 +342,21 @@ void GenericConnectorModelBase< ConnectionT, CommonPropertiesT, ConnectorT >::us
   // replaces whole delay checking for the default delay, see bug #217, MH 08-04-24
   // get_default_delay_ must be overridded by derived class to return the correct default delay
   // (either from commonprops or default connection)
+  // the flag is shared by all threads creating connections; the
+  // exception must be thrown outside of the critical section
+  bool valid = true;
+#ifdef _OPENMP
+#pragma omp critical (default_delay)
+#endif
   if (default_delay_needs_check_)
     {
-      if ( !check_delay( get_default_delay_() ) ) 
-	throw BadDelay(get_default_delay_());
-      default_delay_needs_check_ = false;
+      valid = check_delay( get_default_delay_() );
+      default_delay_needs_check_ = !valid;
     }
 
+  if ( !valid )
+    throw BadDelay(get_default_delay_());
+
 }
 
 
@@ -123,6 +123,7 @@ namespace nest
       proto_(oldmod.proto_)
   {
     set_type_id(oldmod.get_type_id());
+    set_update_cost(oldmod.get_update_cost(), oldmod.update_cost_measured());
     set_threads();
   }
 
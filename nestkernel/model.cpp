@@ -31,7 +31,9 @@ namespace nest
 
   Model::Model(const std::string& name)
     : name_(name),
-      memory_()
+      memory_(),
+      update_cost_(0.0),
+      update_cost_measured_(false)
   {}
   
   void Model::set_threads()
@@ -85,6 +87,14 @@ namespace nest
 
   void Model::set_status(DictionaryDatum d)
   {
+    double_t cost;
+    if ( updateValue<double_t>(d, "update_cost", cost) )
+    {
+      if ( cost <= 0 )
+        throw BadProperty("update_cost must be positive.");
+      set_update_cost(cost, false);
+    }
+
     set_status_(d);
   }
 
@@ -110,6 +120,8 @@ namespace nest
     (*d)["available"]= Token(tmp);
 
     (*d)["model"]=LiteralDatum(get_name());
+    def<double>(d, "update_cost", Node::network()->get_update_cost(*this));
+    def<bool>(d, "update_cost_measured", update_cost_measured_);
     return d;
   }
 
@@ -53,7 +53,9 @@ namespace nest
       Model(const Model& m):
       name_(m.name_),
       type_id_(m.type_id_),
-      memory_(m.memory_)
+      memory_(m.memory_),
+      update_cost_(m.update_cost_),
+      update_cost_measured_(m.update_cost_measured_)
 	  {}
     
       virtual ~Model(){}
@@ -148,6 +150,45 @@ namespace nest
 
     virtual port check_connection(Connection&, port)=0;
 
+    /**
+     * Return the cost of updating one node of this model by one time
+     * step, or 0 if it is not known. The cost is set by the user via
+     * the model property /update_cost, or measured in a simulation
+     * with the kernel property /profile_update_cost, in which case it
+     * is the wall-clock time in microseconds. It is used to balance
+     * the load of the virtual processes with /node_placement /cost,
+     * see Network::get_update_cost().
+     */
+    double_t get_update_cost() const
+    {
+      return update_cost_;
+    }
+
+    /**
+     * Return true if the update cost was set or measured.
+     */
+    bool has_update_cost() const
+    {
+      return update_cost_ > 0;
+    }
+
+    /**
+     * Return true if the update cost was measured.
+     */
+    bool update_cost_measured() const
+    {
+      return update_cost_measured_;
+    }
+
+    /**
+     * Set the update cost, see get_update_cost().
+     */
+    void set_update_cost(double_t cost, bool measured)
+    {
+      update_cost_ = cost;
+      update_cost_measured_ = measured;
+    }
+
     /**
      * Return the size of the prototype.
      */
@@ -226,6 +267,9 @@ namespace nest
      */
     std::vector<sli::pool> memory_;
 
+    double_t update_cost_;        //!< Cost of updating one node by one step, see get_update_cost()
+    bool update_cost_measured_;   //!< update_cost_ was measured rather than set by the user
+
   };
 
 
@@ -253,7 +253,11 @@ namespace nest
     const Name precision("precision");
     const Name scientific("scientific");
     const Name binary("binary");
+    const Name columnar("columnar");
     const Name fbuffer_size("fbuffer_size");
+    const Name async_io("async_io");
+    const Name io_buffer_budget("io_buffer_budget");
+    const Name io_stall_time("io_stall_time");
     const Name flush_records("flush_records");
     const Name close_after_simulate("close_after_simulate");
     const Name flush_after_simulate("flush_after_simulate");
@@ -261,11 +265,14 @@ namespace nest
     const Name filename("filename");
     const Name filenames("filenames");
     const Name record_from("record_from");
+    const Name to_block("to_block");
 
     const Name senders("senders");
     const Name times("times");
     const Name offsets("offsets");
     const Name n_events("n_events");
+    const Name block("block");
+    const Name data("data");
     const Name interval("interval");
     const Name events("events");
     const Name potentials("potentials");
@@ -299,6 +306,10 @@ namespace nest
     const Name dead_time("dead_time");
     const Name gamma_shape("gamma_shape");
 
+    // Specific to poisson_generator
+    const Name batch("batch");
+    const Name batch_identical("batch_identical");
+
     // Miscellaneous parameters
     const Name label("label");
     const Name mean("mean");
@@ -257,7 +257,11 @@ namespace nest
     extern const Name precision;
     extern const Name scientific;
     extern const Name binary;
+    extern const Name columnar;
     extern const Name fbuffer_size;
+    extern const Name async_io;
+    extern const Name io_buffer_budget;
+    extern const Name io_stall_time;
     extern const Name flush_records;
     extern const Name close_after_simulate;
     extern const Name flush_after_simulate;
@@ -265,11 +269,14 @@ namespace nest
     extern const Name filename;
     extern const Name filenames;
     extern const Name record_from;
+    extern const Name to_block;
 
     extern const Name senders;
     extern const Name times;
     extern const Name offsets;
     extern const Name n_events;
+    extern const Name block;
+    extern const Name data;
 
     extern const Name interval;
     extern const Name events;
@@ -305,6 +312,10 @@ namespace nest
     extern const Name dead_time;
     extern const Name gamma_shape;
 
+    // Specific to poisson_generator
+    extern const Name batch;
+    extern const Name batch_identical;
+
     // Miscellaneous parameters
     extern const Name label;
     extern const Name mean;
@@ -1035,6 +1035,49 @@ namespace nest
     i->EStack.pop();
   }
 
+   /* BeginDocumentation
+     Name: DataConnect_dict_s - Connect many pairs of neurons from arrays.
+
+     Synopsis: 
+     dict model  DataConnect_dict_s -> -
+
+     dict   - dictionary with one array per connection parameter
+     model  - the synapse model as string or literal
+
+     Description:
+     Creates one connection for each index into the arrays of dict, using the synapse 'model'.
+
+     The dictionary must contain at least the fields:
+     /source <. gid_1 ... gid_n .>
+     /target <. gid_1 ... gid_n .>
+     /weight <. w_1 ... w_n .>
+     /delay  <. d_1 ... d_n .>
+     It may further contain /receptor_type and the parameters of the synapse model.
+     All of these must be arrays of the same length, preferably DoubleVectors.
+
+     In contrast to DataConnect_i_dict_s, no parameter dictionary is set up for
+     each connection unless the synapse model has parameters besides weight and
+     delay. The delays are checked once for all connections.
+     SeeAlso: DataConnect_i_dict_s, DataConnect
+     FirstVersion: October 2026
+   */
+  void NestModule::DataConnect_dict_sFunction::execute(SLIInterpreter *i) const
+  {
+    i->assert_stack_load(2);
+
+    DictionaryDatum params = getValue<DictionaryDatum>(i->OStack.pick(1));
+    const Name synmodel_name = getValue<std::string>(i->OStack.pick(0));
+    const Token synmodel = get_network().get_synapsedict().lookup(synmodel_name);
+    if ( synmodel.empty() )
+      throw UnknownSynapseType(synmodel_name.toString());
+    const index synmodel_id = static_cast<index>(synmodel);
+
+    get_network().data_connect(params, synmodel_id);
+
+    i->OStack.pop(2);
+    i->EStack.pop();
+  }
+
  /* BeginDocumentation
      Name: DataConnect_a - Connect many neurons from a list of synapse status dictionaries.
 
@@ -1548,6 +1591,46 @@ namespace nest
     i->EStack.pop(); 
   } 
 
+  /* BeginDocumentation
+     Name: TimeSpikeCodec - time the encoder and decoder of the compressed exchange
+     Synopsis:
+     dict TimeSpikeCodec -> dict
+     Description:
+     Encodes a synthetic spike buffer in the wire format of the
+     /compressed_exchange and decodes it again, each /samples times. The
+     buffer holds /segments runs of /segment_size spikes, each run
+     followed by a lag marker. The GIDs in a run increase by random
+     steps of 1 to /max_gap. With /offgrid true, the spikes carry random
+     offsets. The values in brackets are the defaults.
+
+     The dictionary is returned with the following entries added:
+     /entries       - number of entries in the buffer, including markers
+     /bytes         - size of the buffer in the raw exchange
+     /encoded_bytes - size of the encoded buffer
+     /encode_time   - time in s to encode one entry
+     /decode_time   - time in s to decode one entry
+     /max_error     - largest difference between a decoded offset and the
+                      original, 0 for on-grid spikes
+     Parameters:
+     /samples      [1000]
+     /segments     [120]
+     /segment_size [40]
+     /max_gap      [50]
+     /offgrid      [false]
+     Availability: only with MPI
+     FirstVersion: October 2026
+     SeeAlso: TimeCommunication
+  */
+  void NestModule::TimeSpikeCodec_DFunction::execute(SLIInterpreter *i) const
+  {
+    i->assert_stack_load(1);
+    DictionaryDatum d = getValue<DictionaryDatum>(i->OStack.pick(0));
+
+    Communicator::time_spike_codec(d);
+
+    i->EStack.pop();
+  }
+
   /* BeginDocumentation
      Name: ProcessorName - Returns a unique specifier for the actual node.
      Synopsis: ProcessorName -> string
@@ -1762,6 +1845,10 @@ namespace nest
       throw UnknownSynapseType(synmodel_name.toString());
     const index synmodel_id = static_cast<index>(synmodel);
 
+    // the distribution of the targets is derived from their gids
+    if ( !get_network().round_robin_placement() )
+      throw KernelException("RandomPopulationConnectD requires the round-robin placement of nodes.");
+
     int_t M = Communicator::get_num_virtual_processes();
     int_t proc = Communicator::get_rank();
 
@@ -2386,6 +2473,7 @@ namespace nest
     i->createcommand("Connect_i_i_D_l", &connect_i_i_D_lfunction);
     i->createcommand("Connect_i_D_i", &connect_i_D_ifunction);
     i->createcommand("DataConnect_i_dict_s", &dataconnect_i_dict_sfunction);
+    i->createcommand("DataConnect_dict_s", &dataconnect_dict_sfunction);
     i->createcommand("DataConnect_a", &dataconnect_afunction);
 
     i->createcommand("DivergentConnect_i_ia_a_a_l", &divergentconnect_i_ia_a_a_lfunction);
@@ -2415,6 +2503,7 @@ namespace nest
     i->createcommand("SetFakeNumProcesses", &setfakenumprocesses_ifunction);
     i->createcommand("SyncProcesses", &syncprocessesfunction);
     i->createcommand("TimeCommunication_i_i_b", &timecommunication_i_i_bfunction); 
+    i->createcommand("TimeSpikeCodec", &timespikecodec_dfunction);
     i->createcommand("ProcessorName", &processornamefunction);
 #ifdef HAVE_MPI
     i->createcommand("MPI_Abort", &mpiabort_ifunction);
@@ -297,6 +297,12 @@ namespace nest
        void execute(SLIInterpreter *) const;
      } dataconnect_i_dict_sfunction;
 
+     class DataConnect_dict_sFunction: public SLIFunction
+     {
+      public:
+       void execute(SLIInterpreter *) const;
+     } dataconnect_dict_sfunction;
+
      class DataConnect_aFunction: public SLIFunction
      {
       public:
@@ -432,6 +438,11 @@ namespace nest
        void execute(SLIInterpreter *) const; 
      } timecommunication_i_i_bfunction; 
 
+     class TimeSpikeCodec_DFunction : public SLIFunction
+     {
+       void execute(SLIInterpreter *) const;
+     } timespikecodec_dfunction;
+
      class ProcessorNameFunction : public SLIFunction
      {
        void execute(SLIInterpreter *) const;
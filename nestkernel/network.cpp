@@ -44,6 +44,7 @@
 
 #include <cmath>
 #include <set>
+#include <algorithm>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -60,7 +61,9 @@ Network::Network(SLIInterpreter &i)
   data_path_(),
   data_prefix_(),
   overwrite_files_(false),
-  dict_miss_is_error_(true)
+  dict_miss_is_error_(true),
+  parallel_construction_(true),
+  construction_warnings_()
 {
   Node::net_ = this;
   Communicator::net_ = this;
@@ -242,6 +245,7 @@ void Network::reset_kernel()
   data_prefix_ = "";
   overwrite_files_ = false;
   dict_miss_is_error_ = true;
+  parallel_construction_ = true;
 
   reset();
 }
@@ -359,9 +363,17 @@ index Network::add_node(index mod, long_t n)   //no_p
     for(thread t = 0; t < n_threads; ++t)
       model->reserve(t, n_per_thread); // Model::reserve() reserves memory for n ADDITIONAL nodes on thread t
 
+    const double_t cost = get_update_cost(*model);
     for(size_t gid = min_gid; gid < max_gid; ++gid)
     {
-      thread vp = (current_->get_children_on_same_vp()) ? current_->get_children_vp() : suggest_vp(gid);
+      thread vp;
+      if (current_->get_children_on_same_vp())
+      {
+        vp = current_->get_children_vp();
+        scheduler_.add_vp_load(vp, cost);
+      }
+      else
+        vp = scheduler_.place_node(gid, cost);
       thread t = vp_to_thread(vp);
 
       if(is_local_vp(vp))
@@ -530,6 +542,23 @@ index Network::add_node(index mod, long_t n)   //no_p
 	current_=root;
     }
     
+double_t Network::get_update_cost(const Model& m) const
+{
+  if ( m.has_update_cost() )
+    return m.get_update_cost();
+
+  double_t total = 0.0;
+  size_t n_measured = 0;
+  for ( std::vector<Model*>::const_iterator it = models_.begin(); it != models_.end(); ++it )
+    if ( *it != 0 && (*it)->update_cost_measured() )
+    {
+      total += (*it)->get_update_cost();
+      ++n_measured;
+    }
+
+  return n_measured > 0 ? total / n_measured : 1.0;
+}
+
 void Network::init_state(index GID)
 {
   Node *n= get_node(GID);
@@ -679,6 +708,7 @@ void Network::set_status(index gid, const DictionaryDatum& d)
   set_data_path_prefix_(d);
   updateValue<bool>(d, "overwrite_files", overwrite_files_);
   updateValue<bool>(d, "dict_miss_is_error", dict_miss_is_error_);
+  updateValue<bool>(d, "parallel_construction", parallel_construction_);
 
   std::string tmp;
   if ( !d->all_accessed(tmp) )  // proceed only if there are unaccessed items left
@@ -776,6 +806,7 @@ DictionaryDatum Network::get_status(index idx)
     (*d)["data_prefix"] = data_prefix_;
     (*d)["overwrite_files"] = overwrite_files_;
     (*d)["dict_miss_is_error"] = dict_miss_is_error_;
+    (*d)["parallel_construction"] = parallel_construction_;
   }
 
   return d;
@@ -1029,39 +1060,9 @@ void Network::divergent_connect(index source_id, DictionaryDatum pars, index syn
   // We can the later use iterators to change the values inside the parameter dictionary,
   // rather than using the lookup operator.
   // We also do the parameter checking here so that we can later use unsafe operations.
+  to_double_vectors_(pars, "DivergentConnect");
   for(di_s=(*pars).begin(); di_s !=(*pars).end();++di_s)
-  {
     par_i->insert(di_s->first,Token(new DoubleDatum()));
-    DoubleVectorDatum const* tmp = dynamic_cast<DoubleVectorDatum*>(di_s->second.datum());
-    if(tmp==0)
-    {
-        
-        std::string msg=String::compose("Parameter '%1' must be a DoubleVectorArray or numpy.array. ",di_s->first.toString());
-        message(SLIInterpreter::M_DEBUG, "DivergentConnect",msg);
-        message(SLIInterpreter::M_DEBUG, "DivergentConnect", "Trying to convert, but this takes time.");
-        
-        IntVectorDatum const* tmpint = dynamic_cast<IntVectorDatum*>(di_s->second.datum());
-        if(tmpint){
-        std::vector<double> *data=new std::vector<double>((*tmpint)->begin(),(*tmpint)->end());
-        DoubleVectorDatum *dvd= new DoubleVectorDatum(data);
-        di_s->second= dvd;
-        continue;
-      }
-      ArrayDatum *ad= dynamic_cast<ArrayDatum *>(di_s->second.datum());
-      if ( ad )
-      {
-        std::vector<double> *data=new std::vector<double>;
-        ad->toVector(*data);
-        DoubleVectorDatum *dvd= new DoubleVectorDatum(data);
-        di_s->second= dvd;
-      }
-      else
-        throw TypeMismatch(DoubleVectorDatum().gettypename().toString()
-            + " or " + ArrayDatum().gettypename().toString(),
-            di_s->second.datum()->gettypename().toString());
-
-    }
-  }
 
   const Token target_t=pars->lookup2(names::target);
   DoubleVectorDatum const* ptarget_ids = static_cast<DoubleVectorDatum*>(target_t.datum());
@@ -1161,6 +1162,193 @@ void Network::divergent_connect(index source_id, DictionaryDatum pars, index syn
 }
 
 
+void Network::data_connect(DictionaryDatum pars, index syn)
+{
+  to_double_vectors_(pars, "DataConnect");
+
+  // Sort the columns into those known to the kernel and the parameters
+  // of the synapse type. The parameters are passed to the connectors in
+  // one dictionary, whose values are overwritten for each connection.
+  const std::vector<double> *sources = 0, *targets = 0, *weights = 0, *delays = 0, *receptor_types = 0;
+  std::vector<const std::vector<double>*> param_values;
+  std::vector<DoubleDatum*> param_i;
+  DictionaryDatum par_i(new Dictionary());
+
+  for (Dictionary::iterator di = pars->begin(); di != pars->end(); ++di)
+  {
+    const std::vector<double>* column = &**static_cast<DoubleVectorDatum*>(di->second.datum());
+    if (di->first == names::source)
+      sources = column;
+    else if (di->first == names::target)
+      targets = column;
+    else if (di->first == names::weight)
+      weights = column;
+    else if (di->first == names::delay)
+      delays = column;
+    else if (di->first == names::receptor_type)
+      receptor_types = column;
+    else
+    {
+      // the dictionary stores a copy of the token inserted
+      Token& value = par_i->insert(di->first, Token(new DoubleDatum()));
+      param_i.push_back(static_cast<DoubleDatum*>(value.datum()));
+      value.clear_access_flag();
+      param_values.push_back(column);
+    }
+  }
+
+  if (sources == 0)
+    throw UndefinedName(names::source.toString());
+  if (targets == 0)
+    throw UndefinedName(names::target.toString());
+  if (weights == 0)
+    throw UndefinedName(names::weight.toString());
+  if (delays == 0)
+    throw UndefinedName(names::delay.toString());
+
+  const size_t n = sources->size();
+  for (Dictionary::iterator di = pars->begin(); di != pars->end(); ++di)
+    if ((*static_cast<DoubleVectorDatum*>(di->second.datum()))->size() != n)
+    {
+      message(SLIInterpreter::M_ERROR, "DataConnect", "All arrays in the parameter dictionary must be of equal size.");
+      throw DimensionMismatch(n, (*static_cast<DoubleVectorDatum*>(di->second.datum()))->size());
+    }
+
+  if (n == 0)
+    return;
+
+  // If the smallest and the largest delay are valid, so are all others.
+  // See GenericConnectorBase::register_connection() and bug #217 for
+  // the conversion to steps and back.
+  double_t min_delay = (*delays)[0];
+  double_t max_delay = (*delays)[0];
+  for (size_t i = 1; i < n; ++i)
+  {
+    if ((*delays)[i] < min_delay)
+      min_delay = (*delays)[i];
+    else if ((*delays)[i] > max_delay)
+      max_delay = (*delays)[i];
+  }
+  if (!connection_manager_.check_delay(syn, Time(Time::step(Time(Time::ms(min_delay)).get_steps())).get_ms()))
+    throw BadDelay(min_delay);
+  if (!connection_manager_.check_delay(syn, Time(Time::step(Time(Time::ms(max_delay)).get_steps())).get_ms()))
+    throw BadDelay(max_delay);
+
+  const long_t default_receptor_type = getValue<long>((*get_connector_defaults(syn))[names::receptor_type]);
+
+  // Look up all nodes and count the connections of each source on each
+  // thread. Connections are usually given ordered by source, so the
+  // counts are collected as runs of equal sources, which are merged
+  // below. Remote targets are skipped.
+  std::vector<Node*> source_nodes(n, 0);
+  std::vector<Node*> target_nodes(n, 0);
+  std::vector< std::vector< std::pair<index, size_t> > > runs(get_num_threads());
+  for (size_t i = 0; i < n; ++i)
+  {
+    const index sgid = static_cast<index>((*sources)[i]);
+    const index tgid = static_cast<index>((*targets)[i]);
+    if (!is_local_gid(tgid))
+      continue;
+
+    target_nodes[i] = get_node(tgid);
+    if (!target_nodes[i]->has_proxies())
+      continue;
+
+    const thread t = target_nodes[i]->get_thread();
+    source_nodes[i] = get_node(sgid, t);
+    if (runs[t].empty() || runs[t].back().first != sgid)
+      runs[t].push_back(std::make_pair(sgid, 0));
+    ++runs[t].back().second;
+  }
+
+  for (thread t = 0; t < get_num_threads(); ++t)
+  {
+    std::sort(runs[t].begin(), runs[t].end());
+    for (size_t r = 0; r < runs[t].size(); )
+    {
+      const index sgid = runs[t][r].first;
+      size_t n_conns = 0;
+      for ( ; r < runs[t].size() && runs[t][r].first == sgid; ++r)
+        n_conns += runs[t][r].second;
+      connection_manager_.reserve_connections(t, sgid, syn, n_conns);
+    }
+  }
+
+  size_t conn_count = 0;
+  try
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      Node* target = target_nodes[i];
+      if (target == 0)
+        continue;
+
+      for (size_t k = 0; k < param_i.size(); ++k)
+        *param_i[k] = (*param_values[k])[i];
+
+      const index sgid = static_cast<index>((*sources)[i]);
+      const long_t receptor_type = receptor_types == 0 ? default_receptor_type
+                                                       : static_cast<long_t>((*receptor_types)[i]);
+
+      try
+      {
+        if (target->has_proxies())
+        {
+          connection_manager_.connect(*source_nodes[i], *target, sgid, target->get_thread(),
+                                      (*weights)[i], (*delays)[i], receptor_type, par_i, syn, false);
+          ++conn_count;
+        }
+        else
+        {
+          // Devices are rare, they are connected with a dictionary.
+          DictionaryDatum dev_par(new Dictionary(*par_i));
+          def<double_t>(dev_par, names::weight, (*weights)[i]);
+          def<double_t>(dev_par, names::delay, (*delays)[i]);
+          def<long_t>(dev_par, names::receptor_type, receptor_type);
+          connect(sgid, target->get_gid(), dev_par, syn);
+        }
+      }
+      catch (IllegalConnection& e)
+      {
+        std::string msg
+          = String::compose("Target with ID %1 does not support the connection. "
+                            "The connection will be ignored.", target->get_gid());
+        if ( ! e.message().empty() )
+          msg += "\nDetails: " + e.message();
+        message(SLIInterpreter::M_WARNING, "DataConnect", msg.c_str());
+      }
+      catch (UnknownReceptorType& e)
+      {
+        std::string msg
+          = String::compose("In Connection from global source ID %1 to target ID %2: "
+                            "Target does not support requested receptor type. "
+                            "The connection will be ignored",
+                            sgid, target->get_gid());
+        if ( ! e.message().empty() )
+          msg += "\nDetails: " + e.message();
+        message(SLIInterpreter::M_WARNING, "DataConnect", msg.c_str());
+      }
+    }
+  }
+  catch (...)
+  {
+    connection_manager_.increment_num_connections(syn, conn_count);
+    throw;
+  }
+  connection_manager_.increment_num_connections(syn, conn_count);
+
+  // dict access control only if we actually made a connection
+  std::string missed;
+  if ( conn_count > 0 && !par_i->all_accessed(missed) )
+  {
+    if ( dict_miss_is_error_ )
+      throw UnaccessedDictionaryEntry(missed);
+    else
+      message(SLIInterpreter::M_WARNING, "DataConnect",
+              ("The following synapse parameters are unused: " + missed).c_str());
+  }
+}
+
 void Network::random_divergent_connect(index source_id, const TokenArray target_ids, index n, const TokenArray weights, const TokenArray delays, bool allow_multapses, bool allow_autapses, index syn)
 {
   Node *source = get_node(source_id);
@@ -1225,12 +1413,7 @@ void Network::convergent_connect(const TokenArray source_ids, index target_id, c
   bool no_wd_lists = (weights.size() == 0 && delays.size() == 0);
 
   // check if we have consistent lists for weights and delays
-  if (! (complete_wd_lists || short_wd_lists || no_wd_lists))
-  {
-    message(SLIInterpreter::M_ERROR, "ConvergentConnect", "weights and delays must be either doubles or lists of equal size. "
-        "If given as lists, their size must be 1 or the same size as sources.");
-    throw DimensionMismatch();
-  }
+  check_wd_lists_(source_ids.size(), weights, delays);
 
   if (!is_local_gid(target_id))
     return;
@@ -1244,8 +1427,21 @@ void Network::convergent_connect(const TokenArray source_ids, index target_id, c
 
     // we only iterate over local leaves, as remote targets are ignored anyways
     LocalLeafList target_nodes(*target_comp);
+    std::vector<Node*> targets;
     for ( LocalLeafList::iterator tgt = target_nodes.begin(); tgt != target_nodes.end(); ++tgt)
-      convergent_connect(source_ids, (*tgt)->get_gid(), weights, delays, syn);
+      targets.push_back(*tgt);
+
+    if ( targets_have_proxies_(targets) )
+    {
+      std::vector<index> vsource_ids;
+      std::vector<Node*> sources;
+      get_source_nodes_(source_ids, vsource_ids, sources);
+      parallel_convergent_connect_(vsource_ids, sources, targets, weights, delays, syn);
+      return;
+    }
+
+    for (size_t i = 0; i < targets.size(); ++i)
+      convergent_connect(source_ids, targets[i]->get_gid(), weights, delays, syn);
 
     return;
   }
@@ -1321,18 +1517,8 @@ size_t Network::convergent_connect(const std::vector<index> & source_ids, const
   bool short_wd_lists = (sources.size() != weights.size() && weights.size() == 1 && delays.size() == 1);
   bool no_wd_lists = (weights.size() == 0 && delays.size() == 0);
 
-  // Check if we have consistent lists for weights and delays
-
-  // TODO: This check should already be performed outside the parallel
-  // section of the threadedrandom_convergent_connect(). Throwing an
-  // exception inside a parallel section is not allowed.
-  if (! (complete_wd_lists || short_wd_lists || no_wd_lists))
-  {
-    message(SLIInterpreter::M_ERROR, "ConvergentConnect",
-            "weights and delays must be either doubles or lists of equal size. "
-            "If given as lists, their size must be 1 or the same size as sources.");
-    throw DimensionMismatch();
-  }
+  // the callers check the lists before their parallel sections
+  assert(complete_wd_lists || short_wd_lists || no_wd_lists);
 
   size_t num_connections = 0;
 
@@ -1372,7 +1558,7 @@ size_t Network::convergent_connect(const std::vector<index> & source_ids, const
 			  "The connection will be ignored.", target->get_gid());
       if ( ! e.message().empty() )
 	msg += "\nDetails: " + e.message();
-      message(SLIInterpreter::M_WARNING, "ConvergentConnect", msg.c_str());
+      construction_warning_(target->get_thread(), msg);
       continue;
     }
     catch (UnknownReceptorType& e)
@@ -1383,7 +1569,7 @@ size_t Network::convergent_connect(const std::vector<index> & source_ids, const
                                         source->get_gid(), target->get_gid());
       if (!e.message().empty())
 	msg += "\nDetails: " + e.message();
-      message(SLIInterpreter::M_WARNING, "ConvergentConnect", msg.c_str());
+      construction_warning_(target->get_thread(), msg);
       continue;
     }
   }
@@ -1414,8 +1600,23 @@ void Network::random_convergent_connect(const TokenArray source_ids, index targe
 
     // we only consider local leaves as targets,
     LocalLeafList target_nodes(*target_comp);
+    std::vector<Node*> targets;
     for ( LocalLeafList::iterator tgt = target_nodes.begin(); tgt != target_nodes.end(); ++tgt)
-      random_convergent_connect(source_ids, (*tgt)->get_gid(), n, weights, delays,
+      targets.push_back(*tgt);
+
+    if ( targets_have_proxies_(targets) )
+    {
+      std::vector<index> vsource_ids;
+      std::vector<Node*> sources;
+      get_source_nodes_(source_ids, vsource_ids, sources);
+      check_wd_lists_(n, weights, delays);
+      parallel_random_convergent_connect_(vsource_ids, sources, targets, n, weights, delays,
+                                          allow_multapses, allow_autapses, syn);
+      return;
+    }
+
+    for (size_t i = 0; i < targets.size(); ++i)
+      random_convergent_connect(source_ids, targets[i]->get_gid(), n, weights, delays,
           allow_multapses, allow_autapses, syn);
 
     return;
@@ -1454,141 +1655,338 @@ void Network::random_convergent_connect(TokenArray source_ids, TokenArray target
   // This function loops over all targets, with every thread taking
   // care only of his own target nodes
 
-#ifndef _OPENMP
-  // It only makes sense to call this function if we have openmp
-  message(SLIInterpreter::M_ERROR, "ConvergentConnect", "This function can only be called using OpenMP threading.");
-  throw KernelException();
-#endif
+  // Check if we have consistent lists for weights and delays
+  if (! (weights.size() == ns.size() || weights.size() == 0) && (weights.size() == delays.size()))
+  {
+    message(SLIInterpreter::M_ERROR, "ConvergentConnect", "weights, delays and ns must be same size.");
+    throw DimensionMismatch();
+  }
+
+  // Collect the local targets together with their position in
+  // target_ids. The number of connections and the lists of weights
+  // and delays of all targets are checked here, as exceptions must
+  // not be thrown inside the parallel section.
+  std::vector<Node*> targets;
+  std::vector<index> target_pos;
+  for (index i = 0; i < target_ids.size(); ++i)
+  {
+    const index target_id = getValue<long>(target_ids.get(i));
+
+    // This is true for neurons on remote processes
+    if ( !is_local_gid(target_id) )
+      continue;
+
+    targets.push_back(get_node(target_id));
+    target_pos.push_back(i);
+
+    const size_t n = getValue<long>(ns.get(i));
+    if (weights.size() > 0)
+    {
+      const size_t n_weights = getValue<TokenArray>(weights.get(i)).size();
+      const size_t n_delays = getValue<TokenArray>(delays.get(i)).size();
+      if (! ((n_weights == n || n_weights == 0) && n_weights == n_delays))
+      {
+        message(SLIInterpreter::M_ERROR, "ConvergentConnect", "weights and delays must be lists of size n.");
+        throw DimensionMismatch();
+      }
+    }
+  }
+
+  if ( !targets_have_proxies_(targets) )
+  {
+    for (size_t k = 0; k < targets.size(); ++k)
+    {
+      const index i = target_pos[k];
+      TokenArray ws;
+      TokenArray ds;
+      if (weights.size() > 0)
+      {
+        ws = getValue<TokenArray>(weights.get(i));
+        ds = getValue<TokenArray>(delays.get(i));
+      }
+      random_convergent_connect(source_ids, targets[k]->get_gid(), getValue<long>(ns.get(i)), ws, ds,
+                                allow_multapses, allow_autapses, syn);
+    }
+    return;
+  }
 
-  // Collect all nodes on this process and convert the TokenArray with
-  // the sources to a std::vector<Node*>. This is needed, because
+  // Convert the TokenArray with the sources to a std::vector<Node*>.
+  // This is needed, because
   // 1. We don't want to call get_node() within the loop for many
   //    neurons several times
   // 2. The function token_array::operator[]() is not thread-safe, so
   //    the threads will possibly access the same element at the same
   //    time, causing segfaults
+  std::vector<Node*> sources;
+  std::vector<index> vsource_ids;
+  get_source_nodes_(source_ids, vsource_ids, sources);
 
-  std::vector<Node*> sources(source_ids.size());
-  std::vector<index> vsource_ids(source_ids.size());
-  for (index i = 0; i < source_ids.size(); ++i)
+  const thread n_threads = get_num_threads();
+  std::vector<size_t> conn_count(n_threads, 0);
+  std::vector< lockPTR<WrappedThreadException> > exceptions_raised(n_threads);
+  construction_warnings_.assign(n_threads, std::vector<std::string>());
+
+#pragma omp parallel if (parallel_construction_)
   {
-    index sid = getValue<long>(source_ids.get(i));
-    sources[i] = get_node(sid);
-    vsource_ids[i] = sid;
-  }
+    thread first = 0;
+    thread stride = 1;
+#ifdef _OPENMP
+    first = omp_get_thread_num();
+    stride = omp_get_num_threads();
+#endif
 
-  // Check if we have consistent lists for weights and delays
-  if (! (weights.size() == ns.size() || weights.size() == 0) && (weights.size() == delays.size()))
+    for (thread tid = first; tid < n_threads; tid += stride)
+    {
+      try
+      {
+        librandom::RngPtr rng = get_rng(tid);
+
+        for (size_t k = 0; k < targets.size(); ++k)
+        {
+          if ( targets[k]->get_thread() != tid )
+            continue;
+
+          // Only the thread of the target reads its entries, so the
+          // reference counts of the lists are not modified concurrently.
+          const index i = target_pos[k];
+          TokenArray ws;
+          TokenArray ds;
+          if (weights.size() > 0)
+          {
+            ws = getValue<TokenArray>(weights.get(i));
+            ds = getValue<TokenArray>(delays.get(i));
+          }
+
+          conn_count[tid] += random_convergent_connect_(rng, vsource_ids, sources, targets[k]->get_gid(),
+                                                        getValue<long>(ns.get(i)), ws, ds,
+                                                        allow_multapses, allow_autapses, syn);
+        }
+      }
+      catch (std::exception& e)
+      {
+        exceptions_raised[tid] = lockPTR<WrappedThreadException>(new WrappedThreadException(e));
+      }
+    }
+  } // of omp parallel
+
+  finish_parallel_construction_(syn, conn_count, exceptions_raised);
+}
+
+void Network::check_wd_lists_(size_t n, const TokenArray& weights, const TokenArray& delays)
+{
+  const bool complete_wd_lists = (n == weights.size() && weights.size() != 0 && weights.size() == delays.size());
+  const bool short_wd_lists = (n != weights.size() && weights.size() == 1 && delays.size() == 1);
+  const bool no_wd_lists = (weights.size() == 0 && delays.size() == 0);
+
+  if (! (complete_wd_lists || short_wd_lists || no_wd_lists))
   {
-    message(SLIInterpreter::M_ERROR, "ConvergentConnect", "weights, delays and ns must be same size.");
+    message(SLIInterpreter::M_ERROR, "ConvergentConnect", "weights and delays must be either doubles or lists of equal size. "
+        "If given as lists, their size must be 1 or the same size as sources.");
     throw DimensionMismatch();
   }
+}
 
-  bool abort = false;
+void Network::construction_warning_(thread t, const std::string& msg)
+{
+  // outside of the parallel construction, the warning is printed at once
+  if (construction_warnings_.empty())
+    message(SLIInterpreter::M_WARNING, "ConvergentConnect", msg.c_str());
+  else
+    construction_warnings_[t].push_back(msg);
+}
 
-  // We set up vector of connection counters with one entry per
-  // thread. The entries are only written at the end of the
-  // loops. Intermediate values are maintained in threadlocal counters
-  // by each thread during the loops. This should minimize cache
-  // thrashing and at the same time guarantee thread-safe counting.
-  std::vector<size_t> conn_count(get_num_threads(), 0);
+bool Network::parallel_construction_possible(const std::vector<Node*>& targets) const
+{
+  return parallel_construction_ && targets_have_proxies_(targets);
+}
 
-#pragma omp parallel
-  {
-    int nrn_counter = 0;
-    int tid = 0;
+bool Network::targets_have_proxies_(const std::vector<Node*>& targets) const
+{
+  for (size_t i = 0; i < targets.size(); ++i)
+    if ( !targets[i]->has_proxies() )
+      return false;
 
-#ifdef _OPENMP
-    tid = omp_get_thread_num();
-#endif
+  return true;
+}
 
-    librandom::RngPtr rng = get_rng(tid);
+void Network::get_source_nodes_(const TokenArray& source_ids, std::vector<index>& vsource_ids, std::vector<Node*>& sources)
+{
+  vsource_ids.resize(source_ids.size());
+  sources.resize(source_ids.size());
+  for (index i = 0; i < source_ids.size(); ++i)
+  {
+    vsource_ids[i] = getValue<long>(source_ids.get(i));
+    sources[i] = get_node(vsource_ids[i]);
+  }
+}
 
-    for (size_t i=0; i < target_ids.size() && !abort; i++)
-    {      
-      index target_id = target_ids.get(i);
+void Network::to_double_vectors_(DictionaryDatum& d, const char* caller)
+{
+  for(Dictionary::iterator di = d->begin(); di != d->end(); ++di)
+  {
+    if ( dynamic_cast<DoubleVectorDatum*>(di->second.datum()) != 0 )
+      continue;
 
-      // This is true for neurons on remote processes
-      if ( !is_local_gid(target_id) )
-        continue;
+    std::string msg=String::compose("Parameter '%1' must be a DoubleVectorArray or numpy.array. ",di->first.toString());
+    message(SLIInterpreter::M_DEBUG, caller, msg);
+    message(SLIInterpreter::M_DEBUG, caller, "Trying to convert, but this takes time.");
 
-      Node* target = get_node(target_id, tid);
+    IntVectorDatum const* tmpint = dynamic_cast<IntVectorDatum*>(di->second.datum());
+    if ( tmpint )
+    {
+      std::vector<double> *data=new std::vector<double>((*tmpint)->begin(),(*tmpint)->end());
+      di->second = new DoubleVectorDatum(data);
+      continue;
+    }
 
-      // Check, if target is on our thread
-      if (target->get_thread() != tid)
-        continue;
+    ArrayDatum *ad= dynamic_cast<ArrayDatum *>(di->second.datum());
+    if ( ad )
+    {
+      std::vector<double> *data=new std::vector<double>;
+      ad->toVector(*data);
+      di->second = new DoubleVectorDatum(data);
+    }
+    else
+      throw TypeMismatch(DoubleVectorDatum().gettypename().toString()
+                         + " or " + ArrayDatum().gettypename().toString(),
+                         di->second.datum()->gettypename().toString());
+  }
+}
 
-      nrn_counter++;
+void Network::parallel_convergent_connect_(const std::vector<index>& source_ids, const std::vector<Node*>& sources,
+                                           const std::vector<Node*>& targets,
+                                           const TokenArray& weights, const TokenArray& delays, index syn)
+{
+  const thread n_threads = get_num_threads();
+  std::vector<size_t> conn_count(n_threads, 0);
+  std::vector< lockPTR<WrappedThreadException> > exceptions_raised(n_threads);
+  construction_warnings_.assign(n_threads, std::vector<std::string>());
 
-      // TODO: This throws std::bad_cast if the dynamic_cast goes
-      // wrong. Throwing in a parallel section is not allowed. This
-      // could be solved by only accepting IntVectorDatums for the ns.
-      const IntegerDatum& nid = dynamic_cast<const IntegerDatum&>(*ns.get(i));
-      const size_t n = nid.get();
+#pragma omp parallel if (parallel_construction_)
+  {
+    // If OpenMP provides fewer threads than the kernel uses, an OpenMP
+    // thread takes care of the targets of several kernel threads.
+    thread first = 0;
+    thread stride = 1;
+#ifdef _OPENMP
+    first = omp_get_thread_num();
+    stride = omp_get_num_threads();
+#endif
 
-      TokenArray ws;
-      TokenArray ds;      
-      if (weights.size() > 0)
+    for (thread tid = first; tid < n_threads; tid += stride)
+    {
+      try
       {
-        ws = getValue<TokenArray>(weights.get(i));
-        ds = getValue<TokenArray>(delays.get(i));
+        for (size_t i = 0; i < targets.size(); ++i)
+          if ( targets[i]->get_thread() == tid )
+            conn_count[tid] += convergent_connect(source_ids, sources, targets[i]->get_gid(), weights, delays, syn);
+      }
+      catch (std::exception& e)
+      {
+        exceptions_raised[tid] = lockPTR<WrappedThreadException>(new WrappedThreadException(e));
       }
+    }
+  } // of omp parallel
 
-      // Check if we have consistent lists for weights and delays
-      // We don't use omp flush here, as that would be a performance
-      // problem. As we just toggle a boolean variable, it does not
-      // matter in which order this happens and if multiple threads
-      // are doing this concurrently.
-      // TODO: Check the dimensions of all parameters already before
-      // the beginning of the parallel section
-      if (! (ws.size() == n || ws.size() == 0) && (ws.size() == ds.size()) && !abort)
-        abort = true;
+  finish_parallel_construction_(syn, conn_count, exceptions_raised);
+}
 
-      vector<Node*> chosen_sources(n);
-      vector<index> chosen_source_ids(n);
-      std::set<long> ch_ids;
+void Network::parallel_random_convergent_connect_(const std::vector<index>& source_ids, const std::vector<Node*>& sources,
+                                                  const std::vector<Node*>& targets, index n,
+                                                  const TokenArray& weights, const TokenArray& delays,
+                                                  bool allow_multapses, bool allow_autapses, index syn)
+{
+  const thread n_threads = get_num_threads();
+  std::vector<size_t> conn_count(n_threads, 0);
+  std::vector< lockPTR<WrappedThreadException> > exceptions_raised(n_threads);
+  construction_warnings_.assign(n_threads, std::vector<std::string>());
 
-      long n_rnd = vsource_ids.size();
+#pragma omp parallel if (parallel_construction_)
+  {
+    thread first = 0;
+    thread stride = 1;
+#ifdef _OPENMP
+    first = omp_get_thread_num();
+    stride = omp_get_num_threads();
+#endif
 
-      for (size_t j = 0; j < n; ++j)
+    for (thread tid = first; tid < n_threads; tid += stride)
+    {
+      try
+      {
+        // The draws are the same as in the serial random_convergent_connect(),
+        // which takes the generator of the virtual process of each target.
+        librandom::RngPtr rng = get_rng(tid);
+
+        for (size_t i = 0; i < targets.size(); ++i)
+          if ( targets[i]->get_thread() == tid )
+            conn_count[tid] += random_convergent_connect_(rng, source_ids, sources, targets[i]->get_gid(), n,
+                                                          weights, delays, allow_multapses, allow_autapses, syn);
+      }
+      catch (std::exception& e)
       {
-        long s_id;
+        exceptions_raised[tid] = lockPTR<WrappedThreadException>(new WrappedThreadException(e));
+      }
+    }
+  } // of omp parallel
 
-        do
-        {
-          s_id  = rng->ulrand(n_rnd);
-        }
-        while ( ( !allow_autapses && ((index)vsource_ids[s_id]) == target_id )
-            || ( !allow_multapses && ch_ids.find( s_id ) != ch_ids.end() ) );
+  finish_parallel_construction_(syn, conn_count, exceptions_raised);
+}
 
-        if (!allow_multapses)
-          ch_ids.insert(s_id);
+size_t Network::random_convergent_connect_(librandom::RngPtr& rng,
+                                          const std::vector<index>& source_ids, const std::vector<Node*>& sources,
+                                          index target_id, index n,
+                                          const TokenArray& weights, const TokenArray& delays,
+                                          bool allow_multapses, bool allow_autapses, index syn)
+{
+  std::vector<Node*> chosen_sources(n);
+  std::vector<index> chosen_source_ids(n);
+  std::set<long> ch_ids;
 
-        chosen_sources[j] = sources[s_id];
-        chosen_source_ids[j] = vsource_ids[s_id];
-      }
+  const long n_rnd = source_ids.size();
+
+  for (size_t j = 0; j < n; ++j)
+  {
+    long s_id;
 
-      conn_count[tid] += convergent_connect(chosen_source_ids, chosen_sources, target_id, ws, ds, syn);
+    do
+    {
+      s_id  = rng->ulrand(n_rnd);
+    }
+    while ( ( !allow_autapses && source_ids[s_id] == target_id )
+        || ( !allow_multapses && ch_ids.find( s_id ) != ch_ids.end() ) );
 
-    } // of for all targets
-  } // of omp parallel
+    if (!allow_multapses)
+      ch_ids.insert(s_id);
 
-  // TODO: Move this exception throwing block and the check for
-  // consistent weight and delay lists above from inside the parallel
-  // section to outside.
-  if (abort)
-  {
-    message(SLIInterpreter::M_ERROR, "ConvergentConnect", "weights and delays must be lists of size n.");
-    throw DimensionMismatch();
+    chosen_sources[j] = sources[s_id];
+    chosen_source_ids[j] = source_ids[s_id];
   }
 
-  // We calculate the total number of connections established and
-  // increase the connection count of the corresponding prototype in
-  // the ConnectionManager.
+  return convergent_connect(chosen_source_ids, chosen_sources, target_id, weights, delays, syn);
+}
+
+void Network::finish_parallel_construction_(index syn, const std::vector<size_t>& conn_count,
+                                            const std::vector< lockPTR<WrappedThreadException> >& exceptions_raised)
+{
   size_t total_num_conn = 0;
-  for (thread t = 0; t < get_num_threads(); ++t)
+  for (size_t t = 0; t < conn_count.size(); ++t)
     total_num_conn += conn_count[t];
-  connection_manager_.increment_num_connections(syn, total_num_conn);  
+  connection_manager_.increment_num_connections(syn, total_num_conn);
+
+  // The interpreter is not thread-safe, so the warnings of the threads
+  // are printed here, in the order of the threads.
+  std::vector< std::vector<std::string> > warnings;
+  warnings.swap(construction_warnings_);
+  for (size_t t = 0; t < warnings.size(); ++t)
+    for (size_t i = 0; i < warnings[t].size(); ++i)
+      message(SLIInterpreter::M_WARNING, "ConvergentConnect", warnings[t][i].c_str());
+
+  // Raise the exception of the first thread that failed, so that the
+  // error does not depend on the timing of the threads.
+  for (size_t t = 0; t < exceptions_raised.size(); ++t)
+    if ( exceptions_raised[t].valid() )
+      throw WrappedThreadException(*(exceptions_raised[t]));
 }
 
 
@@ -110,6 +110,7 @@ Parameters:
   num_processes            integertype - The number of MPI processes
   off_grid_spiking         booltype    - Whether to transmit precise spike times in MPI communicatio
   overwrite_files          booltype    - Whether to overwrite existing data files
+  parallel_construction    booltype    - Whether each thread creates the connections of its own targets
   print_time               booltype    - Whether to print progress information during the simulation
   resolution               doubletype  - The resolution of the simulation (in ms)
   rng_buffsize             integertype - The buffer size of the random number generators
@@ -230,6 +231,14 @@ SeeAlso: Simulate, Node
      */
     Model * get_model_of_gid(index);
 
+    /**
+     * Return the cost of updating one node of model m by one step,
+     * which is used to place the nodes by cost. Models whose cost was
+     * neither set nor measured get the mean of the measured costs, so
+     * that they are on the same scale, or 1 if no cost was measured.
+     */
+    double_t get_update_cost(const Model& m) const;
+
     /**
      * Return the Model ID for a given GID.
      */
@@ -327,6 +336,16 @@ SeeAlso: Simulate, Node
      */
 
     void divergent_connect(index s,  DictionaryDatum d, index syn);
+
+    /**
+     * Create the connections given column-wise in d, one connection per
+     * row. d must contain the arrays /source, /target, /weight and
+     * /delay and may contain /receptor_type. Any further array holds a
+     * parameter of synapse type syn. All arrays must have the same size.
+     * The delays are checked once for the whole batch and the memory for
+     * the connections of each source is reserved up front.
+     */
+    void data_connect(DictionaryDatum d, index syn);
     void random_divergent_connect(index s, const TokenArray r, index n, const TokenArray w, const TokenArray d, bool, bool, index syn);
     
     void convergent_connect(const TokenArray s, index r, const TokenArray weights, const TokenArray delays, index syn);
@@ -337,8 +356,9 @@ SeeAlso: Simulate, Node
     void random_convergent_connect(const TokenArray s, index t, index n, const TokenArray w, const TokenArray d, bool, bool, index syn);
 
     /**
-     * Use openmp threaded parallelization to speed up connection.
-     * Parallelize over target list. 
+     * Connect n[i] randomly chosen sources to the i-th target. Every
+     * thread creates the connections of its own targets.
+     * @see parallel_construction_possible()
      */
     void random_convergent_connect(TokenArray s, TokenArray t, TokenArray n, TokenArray w, TokenArray d, bool, bool, index syn);
  
@@ -352,6 +372,17 @@ SeeAlso: Simulate, Node
     DictionaryDatum get_connector_status(index gid, index sc);
     void set_connector_status(Node& node, index sc, thread tid, DictionaryDatum& d);
 
+    /**
+     * Return the index of node r in the table of connection targets of
+     * its thread. See ConnectionManager::get_target_index().
+     */
+    index get_target_index(Node& r);
+
+    /**
+     * Return the table of connection targets of thread t.
+     */
+    const std::vector<Node*>& get_targets(thread t) const;
+
     ArrayDatum find_connections(DictionaryDatum dict);
     ArrayDatum get_connections(DictionaryDatum dict);
 
@@ -409,6 +440,13 @@ SeeAlso: Simulate, Node
      */
     void send_local(thread t, Node& source, Event& e);
 
+    /**
+     * Return the number of connections from node source to nodes on
+     * its thread, i.e., the number of targets send_local() delivers an
+     * event from source to.
+     */
+    size_t get_num_local_connections(const Node& source) const;
+
     /**
      * Send event e directly to its target node. This should be
      * used only where necessary, e.g. if a node wants to reply
@@ -442,6 +480,12 @@ SeeAlso: Simulate, Node
      */
     Time const get_time() const;
 
+    /**
+     * Get the number of steps left to simulate in the current call
+     * to Simulate.
+     */
+    long_t get_to_do() const;
+
     /**
      * Get random number client of a thread.
      * Defaults to thread 0 to allow use in non-threaded
@@ -497,6 +541,11 @@ SeeAlso: Simulate, Node
      */
     bool is_local_vp(thread) const;
 
+    /**
+     * See Scheduler::round_robin_placement()
+     */
+    bool round_robin_placement() const;
+
     /**
      * See Scheduler::get_simulated()
      */
@@ -659,6 +708,21 @@ SeeAlso: Simulate, Node
      */
     bool dict_miss_is_error() const;
 
+    /**
+     * Returns true if connection routines let each thread create the
+     * connections of its own targets.
+     */
+    bool parallel_construction() const;
+
+    /**
+     * Returns true if the connections to the given targets can be
+     * created by the threads in parallel. This requires that
+     * parallel_construction is set and that all targets have proxies,
+     * i.e. are owned by exactly one thread. Devices are connected on
+     * the thread of the source and are thus always connected serially.
+     */
+    bool parallel_construction_possible(const std::vector<Node*>& targets) const;
+
 #ifdef HAVE_MUSIC
   public:  
     /**
@@ -724,6 +788,87 @@ SeeAlso: Simulate, Node
     void connect(Node& s, Node& r, index sgid, thread t, double_t w, double_t d, index syn, bool count_connections = true);
     void connect(Node& s, Node& r, index sgid, thread t, DictionaryDatum& d, index syn, bool count_connections = true);
 
+    /**
+     * Connect the sources to each of the targets, with every thread
+     * creating the connections of its own targets. Without
+     * parallel_construction, a single thread visits the targets of all
+     * threads in turn. The targets must have proxies.
+     * @see targets_have_proxies_()
+     */
+    void parallel_convergent_connect_(const std::vector<index>& source_ids, const std::vector<Node*>& sources,
+                                      const std::vector<Node*>& targets,
+                                      const TokenArray& weights, const TokenArray& delays, index syn);
+
+    /**
+     * Connect n randomly chosen sources to each of the targets, with
+     * every thread creating the connections of its own targets. Each
+     * thread draws from the random number generator of its virtual
+     * process and visits its targets in the order given, so the
+     * connections are the same as those created by the serial
+     * random_convergent_connect() for the same number of virtual
+     * processes. Without parallel_construction, a single thread visits
+     * the targets of all threads in turn. The targets must have proxies.
+     * @see targets_have_proxies_()
+     */
+    void parallel_random_convergent_connect_(const std::vector<index>& source_ids, const std::vector<Node*>& sources,
+                                             const std::vector<Node*>& targets, index n,
+                                             const TokenArray& weights, const TokenArray& delays,
+                                             bool allow_multapses, bool allow_autapses, index syn);
+
+    /**
+     * Connect n sources, chosen at random from source_ids with rng, to
+     * the target, which must be owned by the calling thread.
+     * @returns the number of connections created.
+     */
+    size_t random_convergent_connect_(librandom::RngPtr& rng,
+                                      const std::vector<index>& source_ids, const std::vector<Node*>& sources,
+                                      index target_id, index n,
+                                      const TokenArray& weights, const TokenArray& delays,
+                                      bool allow_multapses, bool allow_autapses, index syn);
+
+    /**
+     * Add the connections counted by the threads in a parallel section
+     * to the number of connections of synapse type syn, print the
+     * warnings collected by the threads and throw the first exception
+     * raised in the section again, if any.
+     */
+    void finish_parallel_construction_(index syn, const std::vector<size_t>& conn_count,
+                                       const std::vector< lockPTR<WrappedThreadException> >& exceptions_raised);
+
+    /**
+     * Convert the GIDs in source_ids to a vector of GIDs and a vector of
+     * the corresponding nodes, which can be read safely by several
+     * threads.
+     */
+    void get_source_nodes_(const TokenArray& source_ids, std::vector<index>& vsource_ids, std::vector<Node*>& sources);
+
+    /**
+     * Check that weights and delays are both empty, both of size 1 or
+     * both of size n, as convergent_connect() requires for n sources.
+     * @throws DimensionMismatch otherwise.
+     */
+    void check_wd_lists_(size_t n, const TokenArray& weights, const TokenArray& delays);
+
+    /**
+     * Issue a warning of the connection routines on thread t. In a
+     * parallel construction, the warning is stored and printed by
+     * finish_parallel_construction_().
+     */
+    void construction_warning_(thread t, const std::string& msg);
+
+    /**
+     * Returns true if all targets have proxies, so that the connections
+     * to them can be created from vectors of sources, with or without
+     * parallel_construction.
+     */
+    bool targets_have_proxies_(const std::vector<Node*>& targets) const;
+
+    /**
+     * Convert all entries of d to DoubleVectorDatum in place.
+     * @throws TypeMismatch if an entry is no IntVectorDatum or ArrayDatum.
+     */
+    void to_double_vectors_(DictionaryDatum& d, const char* caller);
+
     /**
      * Initialize the network data structures.
      * init_() is used by the constructor and by reset().
@@ -793,6 +938,8 @@ SeeAlso: Simulate, Node
     Modelrangemanager node_model_ids_;   //!< Records the model id of each neuron in the network
 
     bool dict_miss_is_error_;  //!< whether to throw exception on missed dictionary entries
+    bool parallel_construction_; //!< whether threads create the connections of their own targets
+    std::vector< std::vector<std::string> > construction_warnings_; //!< warnings of each thread in a parallel construction
   };
 
   inline 
@@ -880,6 +1027,18 @@ SeeAlso: Simulate, Node
     connection_manager_.set_connector_status(node, sc, tid, d);
   }
 
+  inline
+  index Network::get_target_index(Node& r)
+  {
+    return connection_manager_.get_target_index(r);
+  }
+
+  inline
+  const std::vector<Node*>& Network::get_targets(thread t) const
+  {
+    return connection_manager_.get_targets(t);
+  }
+
   inline
   ArrayDatum Network::find_connections(DictionaryDatum params)
   {
@@ -946,6 +1105,18 @@ SeeAlso: Simulate, Node
     return scheduler_.get_time();
   }
 
+  inline
+  size_t Network::get_num_local_connections(const Node& source) const
+  {
+    return connection_manager_.get_num_connections(source.get_thread(), source.get_gid());
+  }
+
+  inline
+  long_t Network::get_to_do() const
+  {
+    return scheduler_.get_to_do();
+  }
+
   inline
   Subnet * Network::get_root() const
   {
@@ -993,6 +1164,12 @@ SeeAlso: Simulate, Node
     return scheduler_.is_local_vp(t);
   }
 
+  inline
+  bool Network::round_robin_placement() const
+  {
+    return scheduler_.round_robin_placement();
+  }
+
   inline
   int Network::suggest_vp(index gid) const
   {
@@ -1212,6 +1389,12 @@ SeeAlso: Simulate, Node
     return dict_miss_is_error_;
   }
 
+  inline
+  bool Network::parallel_construction() const
+  {
+    return parallel_construction_;
+  }
+
   typedef lockPTR<Network> NetPtr;
 
   //!< Functor to compare Models by their name.
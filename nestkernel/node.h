@@ -177,6 +177,14 @@ namespace nest {
 
     virtual bool is_off_grid() const;
 
+    /**
+     * Returns true if the node may be updated by any thread in the
+     * work-stealing update. This holds only for nodes whose update()
+     * touches nothing but their own state, in particular no random
+     * number generator of their thread. Models must be checked before
+     * they opt in; all other nodes are updated by their own thread.
+     */
+    virtual bool supports_stealing() const;
 
     /**
      * Returns true if the node is a proxy node. This is implemented because
@@ -865,6 +873,12 @@ namespace nest {
     return false;
   }
 
+  inline
+  bool Node::supports_stealing() const
+  {
+    return false;
+  }
+
   inline
   bool Node::is_proxy() const
   {
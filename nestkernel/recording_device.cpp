@@ -30,6 +30,7 @@
 #include "sliexceptions.h"
 #include <iostream> // using cerr for error message.
 #include <iomanip>
+#include <sstream>
 #include "fdstream.h"
 
 // nestmodule provides global access to the network, so we can
@@ -55,7 +56,10 @@ nest::RecordingDevice::Parameters_::Parameters_(const std::string& file_ext,
     precision_(3),
     scientific_(false),
     binary_(false),
+    columnar_(false),
     fbuffer_size_(BUFSIZ), // default buffer size as defined in <cstdio>
+    async_io_(false),
+    io_buffer_budget_(4194304),
     label_(),
     file_ext_(file_ext),
     filename_(),
@@ -65,6 +69,24 @@ nest::RecordingDevice::Parameters_::Parameters_(const std::string& file_ext,
     close_on_reset_(true)
 {}
 
+nest::RecordingDevice::Column_::Column_(const std::string& name, bool is_double)
+  : name_(name),
+    is_double_(is_double),
+    ints_(),
+    doubles_()
+{}
+
+nest::RecordingDevice::Buffers_::Buffers_()
+  : fs_(),
+    async_(),
+    columns_(),
+    value_names_(),
+    columnar_open_(false),
+    next_column_(0),
+    n_rows_(0),
+    chunk_slice_(0)
+{}
+
 nest::RecordingDevice::State_::State_()
   : events_(0),
     event_senders_(),
@@ -111,7 +133,10 @@ void nest::RecordingDevice::Parameters_::get(const RecordingDevice& rd,
   (*d)[names::scientific] = scientific_;
 
   (*d)[names::binary] = binary_;
+  (*d)[names::columnar] = columnar_;
   (*d)[names::fbuffer_size] = fbuffer_size_;
+  (*d)[names::async_io] = async_io_;
+  (*d)[names::io_buffer_budget] = io_buffer_budget_;
 
   (*d)[names::close_after_simulate] = close_after_simulate_;
   (*d)[names::flush_after_simulate] = flush_after_simulate_;
@@ -141,6 +166,7 @@ void nest::RecordingDevice::Parameters_::set(const RecordingDevice& rd,
   updateValue<bool>(d, names::scientific, scientific_);
 
   updateValue<bool>(d, names::binary, binary_);
+  updateValue<bool>(d, names::columnar, columnar_);
 
   long fbuffer_size;
   if (updateValue<long>(d, names::fbuffer_size, fbuffer_size))
@@ -154,6 +180,15 @@ void nest::RecordingDevice::Parameters_::set(const RecordingDevice& rd,
     }
   }
   
+  updateValue<bool>(d, names::async_io, async_io_);
+  long io_buffer_budget = io_buffer_budget_;
+  if ( updateValue<long>(d, names::io_buffer_budget, io_buffer_budget) )
+  {
+    if ( io_buffer_budget <= 0 )
+      throw BadProperty("/io_buffer_budget must be > 0");
+    io_buffer_budget_ = io_buffer_budget;
+  }
+
   updateValue<bool>(d, names::close_after_simulate, close_after_simulate_);
   updateValue<bool>(d, names::flush_after_simulate, flush_after_simulate_);
   updateValue<bool>(d, names::flush_records, flush_records_);
@@ -335,7 +370,7 @@ nest::RecordingDevice::RecordingDevice(const Node& n, Mode mode, const std::stri
    // we only close files here, opening is left to calibrate()
    if ( P_.close_on_reset_ && B_.fs_.is_open() )
    {
-     B_.fs_.close();
+     close_file_();
      P_.filename_.clear();  // filename_ only visible while file open
    }
 
@@ -353,11 +388,11 @@ nest::RecordingDevice::RecordingDevice(const Node& n, Mode mode, const std::stri
      if ( !B_.fs_.is_open() )
      {
        newfile = true;   // no file from before
-       P_.filename_ = build_filename_();
+       P_.filename_ = build_filename_(P_);
      }
      else
      {
-       std::string newname = build_filename_();
+       std::string newname = build_filename_(P_);
        if ( newname != P_.filename_ )
        {
          Node::network()->message(SLIInterpreter::M_INFO,
@@ -365,7 +400,7 @@ nest::RecordingDevice::RecordingDevice(const Node& n, Mode mode, const std::stri
 				  "Closing file " + P_.filename_ +
 				  ", opening file " + newname);
 
-         B_.fs_.close(); // close old file
+         close_file_(); // close old file
          P_.filename_ = newname;
          newfile = true;
        }
@@ -377,7 +412,7 @@ nest::RecordingDevice::RecordingDevice(const Node& n, Mode mode, const std::stri
 
        if ( Node::network()->overwrite_files() )
        {
-         if ( P_.binary_ )
+         if ( P_.binary_ || P_.columnar_ )
            B_.fs_.open(P_.filename_.c_str(), std::ios::out | std::ios::binary);
          else
            B_.fs_.open(P_.filename_.c_str());
@@ -397,7 +432,7 @@ nest::RecordingDevice::RecordingDevice(const Node& n, Mode mode, const std::stri
            test.close();
 
          // file does not exist, so we can open
-         if ( P_.binary_ )
+         if ( P_.binary_ || P_.columnar_ )
            B_.fs_.open(P_.filename_.c_str(), std::ios::out | std::ios::binary);
          else
            B_.fs_.open(P_.filename_.c_str());
@@ -427,6 +462,29 @@ nest::RecordingDevice::RecordingDevice(const Node& n, Mode mode, const std::stri
        throw IOError();
      }
 
+     // /async_io may also be switched for an open file
+     if ( P_.async_io_ && !B_.async_.is_open() )
+     {
+       B_.async_.open(B_.fs_.rdbuf(), P_.io_buffer_budget_);
+       B_.fs_.std::ios::rdbuf(&B_.async_);
+     }
+     else if ( !P_.async_io_ && B_.async_.is_open() )
+       detach_async_();
+
+     if ( newfile )
+     {
+       B_.columnar_open_ = P_.columnar_;
+       if ( P_.columnar_ )
+         write_header_();
+     }
+     else if ( !has_open_columns_(P_) )
+     {
+       Node::network()->message(SLIInterpreter::M_ERROR, "RecordingDevice::calibrate()",
+                                "Cannot change the format or the columns of the open file " +
+                                P_.filename_ + ". Please close the file first.");
+       throw IOError();
+     }
+
      /* Set formatting
         Formatting is not applied to std::cout for screen output,
         since different devices may have different settings and
@@ -457,11 +515,20 @@ nest::RecordingDevice::RecordingDevice(const Node& n, Mode mode, const std::stri
    {
      if ( P_.close_after_simulate_ )
      {
-       B_.fs_.close();
+       close_file_();
        return;
      }
 
-     if ( P_.flush_after_simulate_ )
+     if ( B_.columnar_open_ )
+       write_chunk_();
+
+     // the I/O thread must not hold data when Simulate returns
+     if ( B_.async_.is_open() )
+     {
+       if ( !B_.async_.drain() )
+         B_.fs_.setstate(std::ios::badbit);
+     }
+     else if ( P_.flush_after_simulate_ )
        B_.fs_.flush();
 
      if ( !B_.fs_.good() )
@@ -484,6 +551,12 @@ void nest::RecordingDevice::set_status(const DictionaryDatum &d)
   State_      stmp = S_;
   stmp.set(d);
 
+  // calibrate() would keep writing to the open file
+  if ( B_.fs_.is_open() && ptmp.to_file_ && build_filename_(ptmp) == P_.filename_
+       && !has_open_columns_(ptmp) )
+    throw BadProperty("Cannot change the format or the columns of the open file " +
+                      P_.filename_ + ". Please close the file first.");
+
   // We now know that (ptmp, stmp) are consistent. We do not
   // write them back to (P_, S_) before we are also sure that
   // the properties to be set in the parent class are internally
@@ -496,7 +569,7 @@ void nest::RecordingDevice::set_status(const DictionaryDatum &d)
 
   if ( !P_.to_file_ && B_.fs_.is_open() )
   {
-    B_.fs_.close();
+    close_file_();
     P_.filename_.clear();
   }
 
@@ -524,11 +597,32 @@ void nest::RecordingDevice::record_event(const Event& event, bool endrecord)
       std::cout << '\n';
   }
 
-  if ( P_.to_file_ )
+  if ( P_.to_file_ && P_.columnar_ )
+  {
+    start_row_();
+    if ( P_.withgid_ )
+      store_column_(static_cast<long long>(sender));
+    if ( P_.withtime_ )
+    {
+      if ( P_.time_in_steps_ )
+      {
+        store_column_(static_cast<long long>(stamp.get_steps()));
+        if ( P_.precise_times_ )
+          store_column_(offset);
+      }
+      else if ( P_.precise_times_ )
+        store_column_(stamp.get_ms() - offset);
+      else
+        store_column_(stamp.get_ms());
+    }
+    if ( P_.withweight_ )
+      store_column_(weight);
+  }
+  else if ( P_.to_file_ )
   {
     print_id_(B_.fs_, sender);
     print_time_(B_.fs_, stamp, offset);
-    print_weight_(std::cout, weight);
+    print_weight_(B_.fs_, weight);
     if ( endrecord )
     {
       B_.fs_ << '\n';
@@ -543,6 +637,76 @@ void nest::RecordingDevice::record_event(const Event& event, bool endrecord)
       store_data_(sender, stamp, offset, weight);
 }
 
+void nest::RecordingDevice::record_events(const EventColumns& events)
+{
+  S_.events_ += events.size();
+
+  const bool to_text_file = P_.to_file_ && !P_.columnar_;
+  if ( P_.to_file_ && P_.columnar_ && !events.empty() )
+  {
+    start_row_();
+    B_.n_rows_ += events.size() - 1;
+
+    size_t c = 0;
+    if ( P_.withgid_ )
+    {
+      std::vector<long long>& senders = B_.columns_[c++].ints_;
+      senders.insert(senders.end(), events.senders.begin(), events.senders.end());
+    }
+    if ( P_.withtime_ && P_.time_in_steps_ )
+    {
+      std::vector<long long>& steps = B_.columns_[c++].ints_;
+      steps.insert(steps.end(), events.steps.begin(), events.steps.end());
+      if ( P_.precise_times_ )
+      {
+        std::vector<double_t>& offsets = B_.columns_[c++].doubles_;
+        offsets.insert(offsets.end(), events.offsets.begin(), events.offsets.end());
+      }
+    }
+    else if ( P_.withtime_ )
+    {
+      std::vector<double_t>& times = B_.columns_[c++].doubles_;
+      for ( size_t i = 0; i < events.size(); ++i )
+      {
+        const double_t t = Time(Time::step(events.steps[i])).get_ms();
+        times.push_back(P_.precise_times_ ? t - events.offsets[i] : t);
+      }
+    }
+    if ( P_.withweight_ )
+    {
+      std::vector<double_t>& weights = B_.columns_[c++].doubles_;
+      weights.insert(weights.end(), events.weights.begin(), events.weights.end());
+    }
+  }
+
+  if ( P_.to_screen_ || to_text_file )
+    for ( size_t i = 0; i < events.size(); ++i )
+    {
+      const Time stamp = Time(Time::step(events.steps[i]));
+
+      if ( P_.to_screen_ )
+      {
+        print_id_(std::cout, events.senders[i]);
+        print_time_(std::cout, stamp, events.offsets[i]);
+        print_weight_(std::cout, events.weights[i]);
+        std::cout << '\n';
+      }
+
+      if ( to_text_file )
+      {
+        print_id_(B_.fs_, events.senders[i]);
+        print_time_(B_.fs_, stamp, events.offsets[i]);
+        print_weight_(B_.fs_, events.weights[i]);
+        B_.fs_ << '\n';
+        if ( P_.flush_records_ )
+          B_.fs_.flush();
+      }
+    }
+
+  if ( P_.to_memory_ || P_.to_accumulator_ )
+    store_data_(events);
+}
+
 void nest::RecordingDevice::print_id_(std::ostream& os, index gid)
 {
   if ( P_.withgid_ )
@@ -596,7 +760,38 @@ void nest::RecordingDevice::store_data_(index sender, const Time& t, double offs
     S_.event_weights_.push_back(weight);
 }
 
-const std::string nest::RecordingDevice::build_filename_() const
+void nest::RecordingDevice::store_data_(const EventColumns& events)
+{
+  if ( P_.withgid_ )
+    S_.event_senders_.insert(S_.event_senders_.end(), events.senders.begin(), events.senders.end());
+
+  if ( P_.withtime_ )
+  {
+    if ( P_.time_in_steps_ )
+    {
+      S_.event_times_steps_.insert(S_.event_times_steps_.end(), events.steps.begin(), events.steps.end());
+      if ( P_.precise_times_ )
+        S_.event_times_offsets_.insert(S_.event_times_offsets_.end(),
+                                       events.offsets.begin(), events.offsets.end());
+    }
+    else
+    {
+      std::vector<double_t>& times = S_.event_times_ms_;
+      const size_t n = times.size();
+      times.resize(n + events.size());
+      for ( size_t i = 0; i < events.size(); ++i )
+        times[n + i] = Time(Time::step(events.steps[i])).get_ms();
+      if ( P_.precise_times_ )
+        for ( size_t i = 0; i < events.size(); ++i )
+          times[n + i] -= events.offsets[i];
+    }
+  }
+
+  if ( P_.withweight_ )
+    S_.event_weights_.insert(S_.event_weights_.end(), events.weights.begin(), events.weights.end());
+}
+
+const std::string nest::RecordingDevice::build_filename_(const Parameters_& p) const
 {
   // number of digits in number of virtual processes
   const int vpdigits = static_cast<int>(std::floor(std::log10(static_cast<float>(Communicator::get_num_virtual_processes()))) + 1);
@@ -609,14 +804,204 @@ const std::string nest::RecordingDevice::build_filename_() const
   basename << Node::network()->get_data_prefix();
 
 
-  if ( !P_.label_.empty() )
-    basename << P_.label_;
+  if ( !p.label_.empty() )
+    basename << p.label_;
   else
     basename << node_.get_name();
 
   basename << "-" << std::setfill('0') << std::setw(gidigits) << node_.get_gid()
            << "-" << std::setfill('0') << std::setw(vpdigits) << node_.get_vp();
-  return basename.str() + '.' + P_.file_ext_;
+  return basename.str() + '.' + p.file_ext_;
+}
+
+void nest::RecordingDevice::set_value_names(const std::vector<std::string>& names)
+{
+  B_.value_names_ = names;
+}
+
+std::vector<std::string> nest::RecordingDevice::get_column_names_(const Parameters_& p) const
+{
+  std::vector<std::string> names;
+  if ( p.withgid_ )
+    names.push_back("sender");
+  if ( p.withtime_ )
+  {
+    if ( p.time_in_steps_ )
+    {
+      names.push_back("step");
+      if ( p.precise_times_ )
+        names.push_back("offset");
+    }
+    else
+      names.push_back("time");
+  }
+  if ( p.withweight_ )
+    names.push_back("weight");
+
+  names.insert(names.end(), B_.value_names_.begin(), B_.value_names_.end());
+  return names;
+}
+
+bool nest::RecordingDevice::has_open_columns_(const Parameters_& p) const
+{
+  if ( p.columnar_ != B_.columnar_open_ )
+    return false;
+  if ( !p.columnar_ )
+    return true;
+
+  const std::vector<std::string> names = get_column_names_(p);
+  if ( names.size() != B_.columns_.size() )
+    return false;
+  for ( size_t j = 0; j < names.size(); ++j )
+    if ( names[j] != B_.columns_[j].name_ )
+      return false;
+  return true;
+}
+
+void nest::RecordingDevice::write_header_()
+{
+  const std::vector<std::string> names = get_column_names_(P_);
+  B_.columns_.clear();
+  for ( size_t j = 0; j < names.size(); ++j )
+    B_.columns_.push_back(Column_(names[j], names[j] != "sender" && names[j] != "step"));
+  B_.next_column_ = 0;
+  B_.n_rows_ = 0;
+
+  const long long version = 1;
+  const long long n_columns = names.size();
+  const long long header_size = 64 + 32 * n_columns;
+  const long long chunk_header_size = 3 * sizeof(long long);
+  const double_t resolution = Time::get_resolution().get_ms();
+  const long long gid = node_.get_gid();
+  const long long vp = node_.get_vp();
+
+  B_.fs_.write("NESTCOLS", 8);
+  B_.fs_.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  B_.fs_.write(reinterpret_cast<const char*>(&header_size), sizeof(header_size));
+  B_.fs_.write(reinterpret_cast<const char*>(&n_columns), sizeof(n_columns));
+  B_.fs_.write(reinterpret_cast<const char*>(&chunk_header_size), sizeof(chunk_header_size));
+  B_.fs_.write(reinterpret_cast<const char*>(&resolution), sizeof(resolution));
+  B_.fs_.write(reinterpret_cast<const char*>(&gid), sizeof(gid));
+  B_.fs_.write(reinterpret_cast<const char*>(&vp), sizeof(vp));
+
+  // NumPy type strings, e.g. <i8 for little-endian 64-bit integers
+  const long long one = 1;
+  const char byte_order = *reinterpret_cast<const char*>(&one) == 1 ? '<' : '>';
+  for ( size_t j = 0; j < B_.columns_.size(); ++j )
+  {
+    std::ostringstream type;
+    if ( B_.columns_[j].is_double_ )
+      type << byte_order << 'f' << sizeof(double_t);
+    else
+      type << byte_order << 'i' << sizeof(long long);
+
+    char description[32] = { 0 };
+    B_.columns_[j].name_.copy(description, 23);
+    type.str().copy(description + 24, 7);
+    B_.fs_.write(description, sizeof(description));
+  }
+}
+
+void nest::RecordingDevice::start_row_()
+{
+  const long long slice = Node::network()->get_slice_origin().get_steps();
+  if ( slice != B_.chunk_slice_ )
+  {
+    write_chunk_();
+    B_.chunk_slice_ = slice;
+  }
+
+  B_.next_column_ = 0;
+  ++B_.n_rows_;
+}
+
+void nest::RecordingDevice::store_column_(double_t value)
+{
+  if ( B_.next_column_ >= B_.columns_.size() )
+    return;
+
+  Column_& c = B_.columns_[B_.next_column_++];
+  if ( c.is_double_ )
+    c.doubles_.push_back(value);
+  else
+    c.ints_.push_back(static_cast<long long>(value));
+}
+
+void nest::RecordingDevice::store_column_(long long value)
+{
+  if ( B_.next_column_ >= B_.columns_.size() )
+    return;
+
+  Column_& c = B_.columns_[B_.next_column_++];
+  if ( c.is_double_ )
+    c.doubles_.push_back(value);
+  else
+    c.ints_.push_back(value);
+}
+
+void nest::RecordingDevice::write_chunk_()
+{
+  if ( B_.n_rows_ == 0 )
+    return;
+
+  const long long n_rows = B_.n_rows_;
+  long long chunk_size = 3 * sizeof(long long);
+  for ( size_t j = 0; j < B_.columns_.size(); ++j )
+    chunk_size += n_rows * ( B_.columns_[j].is_double_ ? sizeof(double_t) : sizeof(long long) );
+
+  const long long header[3] = { B_.chunk_slice_, n_rows, chunk_size };
+  B_.fs_.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+  for ( size_t j = 0; j < B_.columns_.size(); ++j )
+  {
+    Column_& c = B_.columns_[j];
+
+    // rows with missing values are completed with zeros
+    if ( c.is_double_ )
+    {
+      c.doubles_.resize(n_rows, 0.0);
+      B_.fs_.write(reinterpret_cast<const char*>(&c.doubles_[0]), n_rows * sizeof(double_t));
+      c.doubles_.clear();
+    }
+    else
+    {
+      c.ints_.resize(n_rows, 0);
+      B_.fs_.write(reinterpret_cast<const char*>(&c.ints_[0]), n_rows * sizeof(long long));
+      c.ints_.clear();
+    }
+  }
+
+  B_.n_rows_ = 0;
+  B_.next_column_ = 0;
+
+  if ( P_.flush_records_ )
+    B_.fs_.flush();
+}
+
+void nest::RecordingDevice::close_file_()
+{
+  if ( B_.columnar_open_ )
+    write_chunk_();
+
+  if ( B_.async_.is_open() )
+    detach_async_();
+
+  B_.fs_.close();
+  B_.columnar_open_ = false;
+  B_.columns_.clear();
+}
+
+void nest::RecordingDevice::detach_async_()
+{
+  const bool ok = B_.async_.close();
+  B_.fs_.std::ios::rdbuf(B_.fs_.rdbuf());
+
+  if ( !ok )
+  {
+    Node::network()->message(SLIInterpreter::M_ERROR, "RecordingDevice::detach_async_()",
+                             "I/O error while writing to file " + P_.filename_);
+    B_.fs_.setstate(std::ios::badbit);
+  }
 }
 
 void nest::RecordingDevice::State_::clear_events()
@@ -28,6 +28,7 @@
 #include "dictutils.h"
 #include "lockptr.h"
 #include "device.h"
+#include "async_writer.h"
 
 #include <vector>
 #include <fstream>
@@ -152,9 +153,23 @@ namespace nest {
     /precision     - number of digits to use in output of doubles to file (default: 3)
     /binary        - if set to true, data is written in binary mode to files instead of ASCII.
                      This setting affects file output only, not screen output (default: false)
+    /columnar      - if set to true, data is written to files in the columnar binary format
+                     described below instead of text. /precision, /scientific and /binary
+                     have no effect then. The columns of a file are fixed when it is
+                     opened (default: false)
     /fbuffer_size  - the size of the buffer to use for writing to files. The default size is
                      determined by the implementation of the C++ standard library. To obtain an
                      unbuffered file stream, use a buffer size of 0.
+    /async_io      - if set to true, files are written by a background I/O thread, so that
+                     slow disks do not stall the simulation. The data are handed to the
+                     thread in blocks, and flushed when Simulate returns. /flush_records
+                     then flushes the file after each block (default: false)
+    /io_buffer_budget - the number of bytes each thread of the device may hold in blocks
+                     for the I/O thread. If all of them wait to be written, the device
+                     waits for the I/O thread. A new budget applies to the next file
+                     (default: 4194304)
+    /io_stall_time - time in seconds the device has waited for the I/O thread, summed
+                     over threads (read only)
 
     Data recorded in memory is available through the following parameter:
     /n_events      - Number of events collected or sampled. n_events can be set to 0, but
@@ -166,6 +181,37 @@ namespace nest {
                      /precise_times and /withtime are true). All data stored in memory
                      is erased when /n_events is set to 0. 
                                           
+    Columnar files:
+    Each thread of a device writes its own file, named as above. All
+    numbers are written in the byte order of the machine, integers as
+    64-bit signed integers and doubles as 64-bit IEEE floating point. A
+    file starts with a header of 64 bytes:
+      8 bytes  magic (NESTCOLS)
+      int      version (1)
+      int      size of the whole header in bytes
+      int      number of columns
+      int      size of a chunk header in bytes (24)
+      double   resolution in ms
+      int      GID of the device
+      int      virtual process of the file
+    followed by one description of 32 bytes per column: the name (24
+    bytes) and a NumPy type string such as <i8 or <f8 (8 bytes), both
+    padded with zeros. The columns are, if selected:
+      sender   GID of the sender (/withgid)
+      step     time stamp in steps (/withtime and /time_in_steps)
+      offset   offset of precise times (additionally /precise_times)
+      time     time in ms (/withtime without /time_in_steps)
+      weight   weight of the event (/withweight)
+    and one double column per recorded quantity of a multimeter.
+
+    After the header, the file holds one chunk for each time slice in
+    which data were recorded. A chunk header holds the first step of the
+    slice, the number of rows and the size of the chunk in bytes,
+    including the chunk header, as integers. It is followed by the
+    columns of the chunk, one after the other, so that each column of a
+    chunk can be read or memory-mapped as an array. The chunk headers
+    thus form an index of the file by time slice.
+
     SeeAlso: Device, StimulatingDevice
   */
 
@@ -220,6 +266,27 @@ namespace nest {
      */
     enum Mode { SPIKE_DETECTOR, MULTIMETER };
 
+    /**
+     * Events buffered column by column for record_events().
+     *
+     * Each event is stored as sender, time stamp in steps, offset and
+     * weight in four arrays. clear() keeps the capacity of the arrays,
+     * so that a buffer that is reused in every time slice stops
+     * allocating once it has reached the largest number of events per
+     * slice.
+     */
+    struct EventColumns {
+      std::vector<index>    senders;  //!< GID of the sender of each event
+      std::vector<long_t>   steps;    //!< Time stamp of each event in steps
+      std::vector<double_t> offsets;  //!< Offset of each event
+      std::vector<double_t> weights;  //!< Weight of each event
+
+      void push_back(index sender, long_t step, double_t offset, double_t weight);
+      size_t size() const { return senders.size(); }
+      bool empty() const { return senders.empty(); }
+      void clear();
+    };
+
     /**
      * Create recording device information.
      * @param Node of which the device is member.
@@ -273,6 +340,13 @@ namespace nest {
      * @param endrecord pass false if more data is to come on same line
      */
     void record_event(const Event&, bool endrecord = true);
+
+    /**
+     * Record all events in the given columns, as record_event() does
+     * for each of them. Data recorded to memory are appended column
+     * by column.
+     */
+    void record_events(const EventColumns&);
     
     /**
      * Print single item of type ValueT.
@@ -282,6 +356,12 @@ namespace nest {
     template <typename ValueT>
     void print_value(const ValueT&, bool endrecord = true);
 
+    /**
+     * Set the names of the values passed to print_value() for each
+     * event. They name the value columns of columnar files.
+     */
+    void set_value_names(const std::vector<std::string>&);
+
     /** Indicate if recording device is active.
      *  The argument is the time stamp of the event, and the
      *  device is active if start_ < T <= stop_.
@@ -327,6 +407,8 @@ namespace nest {
 
   private:
 
+    struct Parameters_;
+
     /** 
      * Print the time-stamp according to the recorder's flags.
      *
@@ -352,6 +434,11 @@ namespace nest {
      * Store data in internal structure.
      */  
     void store_data_(index, const Time&, double, double);
+
+    /**
+     * Store all events of the given columns in internal structure.
+     */
+    void store_data_(const EventColumns&);
     
     /**
      * Clear data in internal structure, and call clear_data_hook().
@@ -369,12 +456,80 @@ namespace nest {
      * @note This function returns the filename, it does not manipulate
      *       any data member.
      */
-    const std::string build_filename_() const;
- 
+    const std::string build_filename_(const Parameters_&) const;
+
+    /**
+     * Return the columns a columnar file gets with the given
+     * parameters, without data.
+     */
+    std::vector<std::string> get_column_names_(const Parameters_&) const;
+
+    /**
+     * Return true if the given parameters write the format and the
+     * columns of the open file.
+     */
+    bool has_open_columns_(const Parameters_&) const;
+
+    /**
+     * Set up the columns of a new columnar file and write its header.
+     */
+    void write_header_();
+
+    /**
+     * Start a new row of the columnar file, writing the data of the
+     * previous slice first if the slice has changed.
+     */
+    void start_row_();
+
+    /**
+     * Append value to the next column of the current row.
+     */
+    void store_column_(double_t value);
+    void store_column_(long long value);
+
+    /**
+     * Write the rows of the current slice to the columnar file.
+     */
+    void write_chunk_();
+
+    /**
+     * Write pending rows and close the file.
+     */
+    void close_file_();
+
+    /**
+     * Wait for the I/O thread to write all data and write to the file
+     * directly again.
+     */
+    void detach_async_();
+
     // ------------------------------------------------------------------
-    
+
+    /**
+     * Column of a columnar file, holding the data of the current chunk.
+     */
+    struct Column_ {
+      std::string name_;               //!< name in the header
+      bool is_double_;                 //!< true for doubles, false for integers
+      std::vector<long long> ints_;    //!< data of an integer column
+      std::vector<double_t> doubles_;  //!< data of a double column
+
+      Column_(const std::string&, bool);
+      size_t size() const { return is_double_ ? doubles_.size() : ints_.size(); }
+    };
+
     struct Buffers_ {
       std::ofstream fs_; //!< the file to write the recorded data to
+      AsyncStreambuf async_; //!< hands the output of fs_ to the I/O thread if /async_io
+
+      std::vector<Column_> columns_;  //!< columns of the open columnar file
+      std::vector<std::string> value_names_; //!< names of the values of each event
+      bool columnar_open_;            //!< true if the open file is a columnar file
+      size_t next_column_;            //!< column of the current row to fill next
+      size_t n_rows_;                 //!< rows in the current chunk
+      long long chunk_slice_;         //!< first step of the slice of the current chunk
+
+      Buffers_();
     };
 
     // ------------------------------------------------------------------
@@ -394,8 +549,11 @@ namespace nest {
       bool scientific_;    //!< use scientific format if true, else fixed
 
       bool binary_;            //!< true if to write files in binary mode instead of ASCII   
+      bool columnar_;          //!< true if to write files in the columnar binary format
       long fbuffer_size_;      //!< the buffer size to use when writing to file
       long fbuffer_size_old_;  //!< the buffer size to use when writing to file (old)
+      bool async_io_;          //!< true if files are written by the I/O thread
+      long io_buffer_budget_;  //!< bytes for blocks waiting for the I/O thread
 
       std::string label_;    //!< a user-defined label for symbolic device names.
       std::string file_ext_; //!< the file name extension to use, without .
@@ -445,6 +603,24 @@ namespace nest {
 };
 
 
+inline
+void RecordingDevice::EventColumns::push_back(index sender, long_t step, double_t offset, double_t weight)
+{
+  senders.push_back(sender);
+  steps.push_back(step);
+  offsets.push_back(offset);
+  weights.push_back(weight);
+}
+
+inline
+void RecordingDevice::EventColumns::clear()
+{
+  senders.clear();
+  steps.clear();
+  offsets.clear();
+  weights.clear();
+}
+
 inline
 bool RecordingDevice::is_active(Time const & T) const
 {
@@ -459,6 +635,12 @@ void RecordingDevice::get_status(DictionaryDatum &d) const
   P_.get(*this, d);
   S_.get(d, P_);
   Device::get_status(d);
+
+  // summed over the threads, like n_events
+  double stall_time = B_.async_.get_stall_time();
+  if ( d->known(names::io_stall_time) )
+    stall_time += getValue<double>(d, names::io_stall_time);
+  (*d)[names::io_stall_time] = stall_time;
     
   (*d)[names::type] = LiteralDatum(names::recorder);
 }
@@ -484,9 +666,14 @@ void RecordingDevice::print_value(const ValueT& value, bool endrecord)
 
   if ( P_.to_file_ )
   {
-    B_.fs_ << value << '\t';
-    if ( endrecord )
-      B_.fs_ << '\n';
+    if ( P_.columnar_ )
+      store_column_(value);
+    else
+    {
+      B_.fs_ << value << '\t';
+      if ( endrecord )
+        B_.fs_ << '\n';
+    }
   }
 }
 
@@ -24,6 +24,8 @@
 #include <iostream>
 #include <sstream>
 #include <set>
+#include <algorithm>
+#include <numeric>
 
 #include "config.h"
 #include "compose.hpp"
@@ -53,6 +55,7 @@
 #include "doubledatum.h"
 #include "dictutils.h"
 #include "arraydatum.h"
+#include "namedatum.h"
 #include "randomgen.h"
 #include "random_datums.h"
 #include "gslrandomgen.h"
@@ -74,6 +77,22 @@ nest::delay nest::Scheduler::min_delay_ = 1;
 
 const nest::delay nest::Scheduler::comm_marker_ = 0;
 
+namespace
+{
+  // wall-clock time in seconds for measuring the idle time of threads
+  inline
+  double wall_time_()
+  {
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+#endif
+  }
+}
+
 nest::Scheduler::Scheduler(Network &net)
         : initialized_(false),
           simulating_(false),
@@ -82,6 +101,11 @@ nest::Scheduler::Scheduler(Network &net)
 	  n_nodes_(0),
           entry_counter_(0),
           exit_counter_(0),
+          work_stealing_(false),
+          update_chunk_size_(64),
+          cost_placement_(false),
+          measured_imbalance_(0.0),
+          profile_update_cost_(false),
           net_(net),
           clock_(Time::tic(0L)),
           slice_(0L),
@@ -93,7 +117,9 @@ nest::Scheduler::Scheduler(Network &net)
           terminate_(false),
           off_grid_spiking_(false),
           print_time_(false),
-          rng_()
+          rng_(),
+          targeted_exchange_(false),
+          pipelined_exchange_(false)
 {
   init_();
 }
@@ -164,6 +190,29 @@ void nest::Scheduler::init_()
 #endif
 
   set_num_threads(n_threads_);
+  idle_time_.assign(n_threads_, 0.0);
+  update_time_.assign(n_threads_, 0.0);
+  num_exchanges_ = 0;
+  exchange_time_ = 0.0;
+  exchange_bytes_ = 0;
+  last_exchange_time_ = 0.0;
+  last_exchange_bytes_ = 0;
+  spikes_routed_ = false;
+  spike_routes_.clear();
+  spike_routes_built_ = false;
+  pipeline_split_ = 0;
+  exchange_pending_ = false;
+  exchange_received_ = false;
+  exchange_overlap_time_ = 0.0;
+  exchange_wait_time_ = 0.0;
+
+  // the loads of the VPs restart with the network
+  cost_placed_ = false;
+  vp_load_.assign(Communicator::get_num_virtual_processes(), 0.0);
+  vp_by_load_.clear();
+  for ( thread vp = 0; vp < static_cast<thread>(vp_load_.size()); ++vp )
+    vp_by_load_.insert(std::make_pair(0.0, vp));
+  measured_imbalance_ = 0.0;
 
   create_rngs_(true);  // flag that this is a call from the ctr
   create_grng_(true);  // flag that this is a call from the ctr
@@ -191,6 +240,13 @@ void nest::Scheduler::finalize_()
   }
 #endif
 
+#ifdef _OPENMP
+  for ( index t = 0; t < chunk_locks_.size(); ++t )
+    omp_destroy_lock(&chunk_locks_[t]);
+  chunk_locks_.clear();
+#endif
+  update_chunks_.clear();
+
   // clear the buffers
   local_grid_spikes_.clear();
   global_grid_spikes_.clear();
@@ -309,6 +365,17 @@ void nest::Scheduler::configure_spike_buffers_()
 
   displacements_.clear();
   displacements_.resize(Communicator::get_num_processes(), 0);
+  spikes_routed_ = false;
+  collocate_offsets_.assign(n_threads_ + 1, 0);
+
+  pending_grid_spikes_.clear();
+  pending_grid_spikes_.resize(recv_buffer_size, 0U);
+  pending_offgrid_spikes_.clear();
+  pending_offgrid_spikes_.resize(recv_buffer_size, OffGridSpike(0,0.0));
+  pending_displacements_.clear();
+  pending_displacements_.resize(Communicator::get_num_processes(), 0);
+  pending_routed_ = false;
+  exchange_received_ = false;
 }
 
 void nest::Scheduler::clear_nodes_vec_()
@@ -346,6 +413,11 @@ void nest::Scheduler::simulate(Time const & t)
         throw KernelException();
       }
 
+  net_.connection_manager_.compress_sources();
+
+  if (targeted_exchange_)
+    build_spike_routes_();
+
   // As default, we have to place the iterator at the
   // leftmost node of the tree.
   // If the iteration process was suspended, we leave the
@@ -391,6 +463,13 @@ void nest::Scheduler::simulate(Time const & t)
   // find shortest and longest delay across all MPI processes
   // this call sets the member variables
   compute_delay_extrema_(min_delay_, max_delay_);
+  pipeline_split_ = pipelined_exchange_ ? min_delay_ / 2 : 0;
+
+  // a slice of one step cannot be split
+  if ( pipelined_exchange_ && pipeline_split_ == 0 )
+    net_.message(SLIInterpreter::M_WARNING, "Scheduler::simulate",
+                 "The pipelined exchange needs a minimal delay of at least two time steps. "
+                 "The spike exchange is not overlapped with the update.");
 
   // Warn about possible inconsistencies, see #504.
   // This test cannot come any earlier, because we first need to compute min_delay_
@@ -405,13 +484,8 @@ void nest::Scheduler::simulate(Time const & t)
   // from_step_ is not touched here.  If we are at the beginning
   // of a simulation, it has been reset properly elsewhere.  If
   // a simulation was ended and is now continued, from_step_ will
-  // have the proper value.  to_step_ is set as in advance_time().
-  ulong_t end_sim = from_step_ + to_do_;
-  if (min_delay_ < end_sim)
-    to_step_ = min_delay_;    // update to end of time slice
-  else
-    to_step_ = end_sim;       // update to end of simulation time
-
+  // have the proper value.
+  set_to_step_();
 
   resume();
   simulated_ = true;
@@ -503,8 +577,17 @@ void nest::Scheduler::resume()
 #endif
   }
   simulating_ = false;
+
+  // no exchange is left in progress between calls to Simulate
+  finish_exchange_();
+
   finalize_nodes();
 
+  // collecting the times needs collective communication, which only
+  // profiling runs should pay for
+  if ( profile_update_cost_ )
+    collect_update_times_();
+
   if (print_time_)
     std::cout << std::endl;
 
@@ -557,11 +640,14 @@ void nest::Scheduler::serial_update()
       net_.update_music_event_handlers_(clock_, from_step_, to_step_);
 #endif
     }
+    else if ( from_step_ == static_cast<long_t>(pipeline_split_) ) // pipelined exchange
+      deliver_events_(0);
 
-    for (i = nodes_vec_[0].begin(); i != nodes_vec_[0].end(); ++i)
-      update_(*i);
+    const double_t update_begin = wall_time_();
+    update_nodes_(0, nodes_vec_[0], 0, nodes_vec_[0].size());
+    update_time_[0] += wall_time_() - update_begin;
 
-    if ( static_cast<ulong_t>(to_step_) == min_delay_ ) // gather only at end of slice
+    if ( exchange_due_() ) // gather only at end of slice or interval
       gather_events_();
 
     advance_time_();
@@ -590,6 +676,7 @@ void nest::Scheduler::threaded_update_openmp()
 #pragma omp parallel
   {
     int t = 0;
+    double idle_begin = 0.0;
 #ifdef _OPENMP
     t = omp_get_thread_num(); // which thread am I
 #endif
@@ -612,19 +699,59 @@ void nest::Scheduler::threaded_update_openmp()
 	  net_.update_music_event_handlers_(clock_, from_step_, to_step_);
 #endif
 	}
+      else if ( from_step_ == static_cast<long_t>(pipeline_split_) ) // pipelined exchange
+        deliver_events_(t);
+
+      // a thread must not steal nodes whose thread is still delivering
+      // events to them
+      if ( work_stealing_ && ( from_step_ == 0 || from_step_ == static_cast<long_t>(pipeline_split_) ) )
+      {
+        idle_begin = wall_time_();
+#pragma omp barrier
+        idle_time_[t] += wall_time_() - idle_begin;
+      }
 
-      for (std::vector<Node*>::iterator i = nodes_vec_[t].begin(); i != nodes_vec_[t].end(); ++i)
-	update_(*i);
+      const double_t update_begin = wall_time_();
+      if ( work_stealing_ )
+        work_stealing_update_(t);
+      else
+        update_nodes_(t, nodes_vec_[t], 0, nodes_vec_[t].size());
 
       // parallel section ends, wait until all threads are done -> synchronize
+      idle_begin = wall_time_();
+      update_time_[t] += idle_begin - update_begin;
+#pragma omp barrier
+      idle_time_[t] += wall_time_() - idle_begin;
+
+      // each thread collects the spikes of its nodes updated by others
+      if ( work_stealing_ )
+        collect_chunk_spikes_(t);
+
+      // all threads collocate their spikes in the send buffer, after
+      // the exchange started before has finished sending it
+      if ( exchange_due_() ) // gather only at end of slice or interval
+      {
+#pragma omp single
+        begin_exchange_();
+
+        count_spikes_(t);
+#pragma omp barrier
+#pragma omp single
+        size_send_buffer_();
+
+        collocate_buffers_(t);
 #pragma omp barrier
+      }
 
       // the following block is executed by a single thread
       // the other threads wait at the end of the block
 #pragma omp single
       {
-	if ( static_cast<ulong_t>(to_step_) == min_delay_ ) // gather only at end of slice
-	  gather_events_();
+	if ( work_stealing_ )
+	  reset_update_chunks_();
+
+	if ( exchange_due_() ) // gather only at end of slice or interval
+	  exchange_events_();
 
 	advance_time_();
 
@@ -729,10 +856,12 @@ void nest::Scheduler::threaded_update(thread t)
       }
 #endif
     }
+    else if ( from_step_ == static_cast<long_t>(pipeline_split_) ) // pipelined exchange
+      deliver_events_(t);
 
-    vector<Node*>::iterator i;
-    for(i = nodes_vec_[t].begin(); i != nodes_vec_[t].end(); ++i)
-      update_(*i);
+    const double_t update_begin = wall_time_();
+    update_nodes_(t, nodes_vec_[t], 0, nodes_vec_[t].size());
+    update_time_[t] += wall_time_() - update_begin;
 
     ready_mutex_.lock();
 
@@ -759,7 +888,7 @@ void nest::Scheduler::threaded_update(thread t)
 
     if (exit_counter_ == n_threads_)
     {
-      if ( static_cast<ulong_t>(to_step_) == min_delay_ ) // gather only at end of slice
+      if ( exchange_due_() ) // gather only at end of slice or interval
         gather_events_();
 
       advance_time_();
@@ -863,10 +992,239 @@ void nest::Scheduler::prepare_nodes()
     n_nodes_ += nodes_vec_[t].size();
   }
 
+  configure_update_chunks_();
+  reset_update_times_();
+
   std::string msg = String::compose("Simulating %1 nodes.", n_nodes_);
   net_.message(SLIInterpreter::M_INFO, "Scheduler::prepare_nodes", msg);
 }
 
+nest::Scheduler::UpdateChunk::UpdateChunk(index b, index e, index g, bool s)
+  : begin(b),
+    end(e),
+    first_gid(g),
+    stealable(s),
+    taken(false),
+    spikes(),
+    offgrid_spikes()
+{}
+
+void nest::Scheduler::configure_update_chunks_()
+{
+#ifdef _OPENMP
+  for ( index t = 0; t < chunk_locks_.size(); ++t )
+    omp_destroy_lock(&chunk_locks_[t]);
+  chunk_locks_.resize(n_threads_);
+  for ( index t = 0; t < n_threads_; ++t )
+    omp_init_lock(&chunk_locks_[t]);
+#endif
+
+  update_chunks_.clear();
+  update_chunks_.resize(n_threads_);
+  if ( !work_stealing_ )
+    return;
+
+  // a chunk ends after update_chunk_size_ nodes or where the nodes
+  // change from stealable to not stealable or vice versa
+  for ( index t = 0; t < n_threads_; ++t )
+  {
+    const std::vector<Node*>& nodes = nodes_vec_[t];
+    index begin = 0;
+    while ( begin < nodes.size() )
+    {
+      const bool stealable = is_stealable_(nodes[begin]);
+      const index max_end = std::min(begin + static_cast<index>(update_chunk_size_), nodes.size());
+      index end = begin + 1;
+      while ( end < max_end && is_stealable_(nodes[end]) == stealable )
+        ++end;
+
+      // find_chunk_() relies on the order of the nodes
+      assert(begin == 0 || nodes[begin - 1]->get_gid() <= nodes[begin]->get_gid());
+      update_chunks_[t].push_back(UpdateChunk(begin, end, nodes[begin]->get_gid(), stealable));
+      update_chunks_[t].back().spikes.resize(spike_register_[t].size());
+      update_chunks_[t].back().offgrid_spikes.resize(offgrid_spike_register_[t].size());
+      begin = end;
+    }
+  }
+
+  reset_update_chunks_();
+}
+
+void nest::Scheduler::reset_update_chunks_()
+{
+  chunk_front_.assign(n_threads_, 0);
+  chunk_back_.resize(n_threads_);
+  for ( index t = 0; t < n_threads_; ++t )
+  {
+    chunk_back_[t] = update_chunks_[t].size();
+    for ( index c = 0; c < update_chunks_[t].size(); ++c )
+      update_chunks_[t][c].taken = false;
+  }
+}
+
+nest::Scheduler::UpdateChunk* nest::Scheduler::take_chunk_(thread t, bool steal)
+{
+  std::vector<UpdateChunk>& chunks = update_chunks_[t];
+  UpdateChunk* chunk = 0;
+#ifdef _OPENMP
+  omp_set_lock(&chunk_locks_[t]);
+  if ( !steal )
+  {
+    while ( chunk_front_[t] < chunks.size() && chunks[chunk_front_[t]].taken )
+      ++chunk_front_[t];
+    if ( chunk_front_[t] < chunks.size() )
+      chunk = &chunks[chunk_front_[t]++];
+  }
+  else
+  {
+    // chunks that are not stealable are left to the owner
+    while ( chunk_back_[t] > chunk_front_[t]
+            && (chunks[chunk_back_[t] - 1].taken || !chunks[chunk_back_[t] - 1].stealable) )
+      --chunk_back_[t];
+    if ( chunk_back_[t] > chunk_front_[t] )
+      chunk = &chunks[--chunk_back_[t]];
+  }
+  if ( chunk != 0 )
+    chunk->taken = true;
+  omp_unset_lock(&chunk_locks_[t]);
+#endif
+  return chunk;
+}
+
+void nest::Scheduler::work_stealing_update_(thread t)
+{
+  for ( UpdateChunk* c = take_chunk_(t, false); c != 0; c = take_chunk_(t, false) )
+    update_nodes_(t, nodes_vec_[t], c->begin, c->end);
+
+  // visit the other threads round-robin until none has work left to steal
+  bool stole = true;
+  while ( stole )
+  {
+    stole = false;
+    for ( index i = 1; i < n_threads_; ++i )
+    {
+      const thread victim = (t + i) % n_threads_;
+      UpdateChunk* c = take_chunk_(victim, true);
+      if ( c == 0 )
+        continue;
+
+      update_nodes_(t, nodes_vec_[victim], c->begin, c->end);
+      stole = true;
+    }
+  }
+}
+
+void nest::Scheduler::collect_chunk_spikes_(thread t)
+{
+  // the chunks partition nodes_vec_[t] in order, so appending their
+  // spikes chunk by chunk restores the order of the static update
+  for ( index c = 0; c < update_chunks_[t].size(); ++c )
+  {
+    UpdateChunk& chunk = update_chunks_[t][c];
+    for ( index lag = 0; lag < chunk.spikes.size(); ++lag )
+    {
+      spike_register_[t][lag].insert(spike_register_[t][lag].end(),
+                                     chunk.spikes[lag].begin(), chunk.spikes[lag].end());
+      chunk.spikes[lag].clear();
+
+      offgrid_spike_register_[t][lag].insert(offgrid_spike_register_[t][lag].end(),
+                                             chunk.offgrid_spikes[lag].begin(),
+                                             chunk.offgrid_spikes[lag].end());
+      chunk.offgrid_spikes[lag].clear();
+    }
+  }
+}
+
+nest::thread nest::Scheduler::place_node(index gid, double_t cost)
+{
+  thread vp = suggest_vp(gid);
+  if ( cost_placement_ )
+  {
+    vp = vp_by_load_.begin()->second;
+    cost_placed_ = true;
+  }
+  add_vp_load(vp, cost);
+  return vp;
+}
+
+void nest::Scheduler::add_vp_load(thread vp, double_t cost)
+{
+  vp_by_load_.erase(std::make_pair(vp_load_[vp], vp));
+  vp_load_[vp] += cost;
+  vp_by_load_.insert(std::make_pair(vp_load_[vp], vp));
+}
+
+void nest::Scheduler::update_nodes_(thread t, const std::vector<Node*>& nodes, index begin, index end)
+{
+  if ( !profile_update_cost_ )
+  {
+    for ( index n = begin; n < end; ++n )
+      update_(nodes[n]);
+    return;
+  }
+
+  // nodes of a model are mostly created together, so the clock is
+  // read once per run of nodes of the same model
+  const long_t steps = to_step_ - from_step_;
+  index n = begin;
+  while ( n < end )
+  {
+    const index run_begin = n;
+    const int model_id = nodes[n]->get_model_id();
+    const double_t run_start = wall_time_();
+    for ( ; n < end && nodes[n]->get_model_id() == model_id; ++n )
+      update_(nodes[n]);
+
+    model_update_time_[t][model_id] += wall_time_() - run_start;
+    model_update_steps_[t][model_id] += (n - run_begin) * steps;
+  }
+}
+
+void nest::Scheduler::reset_update_times_()
+{
+  update_time_.assign(n_threads_, 0.0);
+  model_update_time_.assign(n_threads_, std::vector<double_t>(net_.models_.size(), 0.0));
+  model_update_steps_.assign(n_threads_, std::vector<double_t>(net_.models_.size(), 0.0));
+}
+
+void nest::Scheduler::collect_update_times_()
+{
+  std::vector<double_t> vp_times;
+  std::vector<int> displacements;
+  Communicator::communicate(update_time_, vp_times, displacements);
+
+  measured_imbalance_ = 0.0;
+  const double_t total = std::accumulate(vp_times.begin(), vp_times.end(), 0.0);
+  if ( total > 0 )
+    measured_imbalance_ = *std::max_element(vp_times.begin(), vp_times.end()) * vp_times.size() / total;
+
+  // times followed by steps for all models, summed over local threads
+  const index n_models = net_.models_.size();
+  std::vector<double_t> local(2 * n_models, 0.0);
+  for ( index t = 0; t < n_threads_; ++t )
+    for ( index m = 0; m < n_models; ++m )
+    {
+      local[m] += model_update_time_[t][m];
+      local[n_models + m] += model_update_steps_[t][m];
+    }
+
+  std::vector<double_t> global;
+  Communicator::communicate(local, global, displacements);
+
+  for ( index m = 0; m < n_models; ++m )
+  {
+    double_t time = 0.0;
+    double_t steps = 0.0;
+    for ( index p = 0; p < global.size(); p += 2 * n_models )
+    {
+      time += global[p + m];
+      steps += global[p + n_models + m];
+    }
+    if ( steps > 0 && time > 0 )
+      net_.models_[m]->set_update_cost(1e6 * time / steps, true);
+  }
+}
+
 void nest::Scheduler::finalize_nodes()
 {
   for (index t = 0; t < n_threads_; ++t)
@@ -923,6 +1281,27 @@ void nest::Scheduler::set_status(DictionaryDatum const &d)
   }
 
   updateValue<bool>(d, "print_time", print_time_);
+  updateValue<bool>(d, "work_stealing", work_stealing_);
+  updateValue<bool>(d, "profile_update_cost", profile_update_cost_);
+
+  std::string placement;
+  if ( updateValue<std::string>(d, "node_placement", placement) )
+  {
+    if ( placement == "round_robin" )
+      cost_placement_ = false;
+    else if ( placement == "cost" )
+      cost_placement_ = true;
+    else
+      throw BadProperty("node_placement must be /round_robin or /cost.");
+  }
+
+  long chunk_size;
+  if ( updateValue<long>(d, "update_chunk_size", chunk_size) )
+  {
+    if ( chunk_size < 1 )
+      throw BadProperty("update_chunk_size must be positive.");
+    update_chunk_size_ = chunk_size;
+  }
 
   long n_threads;
   bool n_threads_updated = updateValue<long>(d, "local_num_threads", n_threads);
@@ -1059,6 +1438,44 @@ void nest::Scheduler::set_status(DictionaryDatum const &d)
   if (commstyle_updated)
       Communicator::set_use_Allgather(comm_allgather);
 
+  bool adaptive_exchange;
+  if (updateValue<bool>(d, "adaptive_exchange", adaptive_exchange))
+    Communicator::set_adaptive_exchange(adaptive_exchange);
+
+  bool compressed_exchange;
+  if (updateValue<bool>(d, "compressed_exchange", compressed_exchange))
+    Communicator::set_compressed_exchange(compressed_exchange);
+
+  bool targeted_exchange;
+  if (updateValue<bool>(d, "targeted_exchange", targeted_exchange)
+      && targeted_exchange != targeted_exchange_)
+  {
+    // the connection manager only records new sources for the
+    // targeted exchange, so the routes are built anew when it is
+    // switched on again
+    targeted_exchange_ = targeted_exchange;
+    net_.connection_manager_.set_record_new_sources(targeted_exchange_);
+    spike_routes_.clear();
+    spike_routes_built_ = false;
+  }
+
+  bool pipelined_exchange;
+  if (updateValue<bool>(d, "pipelined_exchange", pipelined_exchange)
+      && pipelined_exchange != pipelined_exchange_)
+  {
+    // the spikes of the last slice are exchanged in the format of the
+    // current setting and not yet delivered
+    if (simulated_)
+      throw KernelException("The network has been simulated: The pipelined exchange cannot be switched.");
+    pipelined_exchange_ = pipelined_exchange;
+
+    if (pipelined_exchange_ && net_.connection_manager_.get_num_connections() > 0
+        && net_.connection_manager_.get_min_delay().get_steps() < 2)
+      net_.message(SLIInterpreter::M_WARNING, "Scheduler::set_status",
+                   "The pipelined exchange needs a minimal delay of at least two time steps. "
+                   "With the current connections, the spike exchange is not overlapped with the update.");
+  }
+
   // set RNGs --- MUST come after n_threads_ is updated
   if (d->known("rngs"))
   {
@@ -1199,6 +1616,21 @@ void nest::Scheduler::get_status(DictionaryDatum &d) const
   def<double_t>(d, "time", get_time().get_ms());
   def<long>(d, "to_do", to_do_);
   def<bool>(d, "print_time", print_time_);
+  def<bool>(d, "work_stealing", work_stealing_);
+  def<long>(d, "update_chunk_size", update_chunk_size_);
+  (*d)["thread_idle_time"] = Token(idle_time_);
+
+  (*d)["node_placement"] = LiteralDatum(cost_placement_ ? "cost" : "round_robin");
+  def<bool>(d, "profile_update_cost", profile_update_cost_);
+  (*d)["vp_load"] = Token(vp_load_);
+
+  // maximal over mean load of the VPs, 1 for a perfect balance
+  const double_t total_load = std::accumulate(vp_load_.begin(), vp_load_.end(), 0.0);
+  double_t predicted_imbalance = 0.0;
+  if ( total_load > 0 )
+    predicted_imbalance = *std::max_element(vp_load_.begin(), vp_load_.end()) * vp_load_.size() / total_load;
+  def<double>(d, "predicted_imbalance", predicted_imbalance);
+  def<double>(d, "measured_imbalance", measured_imbalance_);
 
   def<double>(d, "tics_per_ms", Time::get_tics_per_ms());
   def<double>(d, "resolution", Time::get_resolution().get_ms());
@@ -1228,6 +1660,18 @@ void nest::Scheduler::get_status(DictionaryDatum &d) const
   def<long>(d, "grng_seed", grng_seed_);
   def<bool>(d, "off_grid_spiking", off_grid_spiking_);
   def<bool>(d, "communicate_allgather", Communicator::get_use_Allgather());
+  def<bool>(d, "adaptive_exchange", Communicator::get_adaptive_exchange());
+  def<bool>(d, "compressed_exchange", Communicator::get_compressed_exchange());
+  def<bool>(d, "targeted_exchange", targeted_exchange_);
+  def<bool>(d, "pipelined_exchange", pipelined_exchange_);
+  const double_t exchange_total_time = exchange_overlap_time_ + exchange_wait_time_;
+  def<double>(d, "exchange_hidden_fraction",
+              exchange_total_time > 0.0 ? exchange_overlap_time_ / exchange_total_time : 0.0);
+  def<long>(d, "num_exchanges", num_exchanges_);
+  def<double>(d, "exchange_time", exchange_time_);
+  def<long>(d, "exchange_bytes", exchange_bytes_);
+  def<double>(d, "last_exchange_time", last_exchange_time_);
+  def<long>(d, "last_exchange_bytes", last_exchange_bytes_);
 }
 
 void nest::Scheduler::create_rngs_(const bool ctor_call)
@@ -1324,151 +1768,123 @@ void nest::Scheduler::create_grng_(const bool ctor_call)
 }
 
 
-void nest::Scheduler::collocate_buffers_()
+void nest::Scheduler::get_collocated_lags_(delay& first_lag, delay& end_lag) const
 {
-  //count number of spikes in registers
-  int num_spikes = 0;
-  int num_grid_spikes = 0;
-  int num_offgrid_spikes = 0;
-
-  std::vector<std::vector<std::vector<uint_t> > >::iterator i;
-  std::vector<std::vector<uint_t> >::iterator j;
-  for (i = spike_register_.begin(); i != spike_register_.end(); ++i)
-    for (j = i->begin(); j != i->end(); ++j)
-      num_grid_spikes += j->size();
-
-  std::vector<std::vector<std::vector<OffGridSpike> > >::iterator it;
-  std::vector<std::vector<OffGridSpike> >::iterator jt;
-  for (it = offgrid_spike_register_.begin(); it != offgrid_spike_register_.end(); ++it)
-    for (jt = it->begin(); jt != it->end(); ++jt)
-      num_offgrid_spikes += jt->size();
-
-  num_spikes = num_grid_spikes + num_offgrid_spikes;
-  if (!off_grid_spiking_)  //on grid spiking
-  {
-    // make sure buffers are correctly sized and empty
-    std::vector<uint_t> tmp(global_grid_spikes_.size(), 0);
-    global_grid_spikes_.swap(tmp);
-
-    if (global_grid_spikes_.size() != static_cast<uint_t>(Communicator::get_recv_buffer_size()))
-      global_grid_spikes_.resize(Communicator::get_recv_buffer_size(), 0);
-
-    std::vector<uint_t> tmp2(local_grid_spikes_.size(), 0);
-    local_grid_spikes_.swap(tmp2);
+  // the pipelined exchange sends the two intervals of a slice separately
+  first_lag = pipeline_split_ > 0 && to_step_ != static_cast<long_t>(pipeline_split_) ? pipeline_split_ : 0;
+  end_lag = pipeline_split_ > 0 && to_step_ == static_cast<long_t>(pipeline_split_) ? pipeline_split_ : min_delay_;
+}
 
-    if (num_spikes + (n_threads_ * min_delay_) > static_cast<uint_t>(Communicator::get_send_buffer_size()))
-      local_grid_spikes_.resize((num_spikes + (min_delay_ * n_threads_)),0);
-    else if (local_grid_spikes_.size() < static_cast<uint_t>(Communicator::get_send_buffer_size()))
-      local_grid_spikes_.resize(Communicator::get_send_buffer_size(), 0);
+void nest::Scheduler::count_spikes_(thread t)
+{
+  delay first_lag;
+  delay end_lag;
+  get_collocated_lags_(first_lag, end_lag);
+
+  // one marker per lag
+  size_t n_entries = end_lag - first_lag;
+  for (delay lag = first_lag; lag < end_lag; ++lag)
+    n_entries += spike_register_[t][lag].size() + offgrid_spike_register_[t][lag].size();
+  collocate_offsets_[t + 1] = n_entries;
+}
 
+void nest::Scheduler::size_send_buffer_()
+{
+  // turn the counts of the threads into the positions of their entries
+  collocate_offsets_[0] = 0;
+  for (index t = 0; t < n_threads_; ++t)
+    collocate_offsets_[t + 1] += collocate_offsets_[t];
+  const size_t n_entries = collocate_offsets_[n_threads_];
+
+  // the adaptive, the compressed, the targeted and the pipelined
+  // exchange send exactly the entries written by collocate_buffers_()
+  // and size the receive buffer themselves
+  const bool exact_send_buffer = Communicator::get_adaptive_exchange()
+                                 || Communicator::get_compressed_exchange()
+                                 || targeted_exchange_ || pipeline_split_ > 0;
+  const size_t send_buffer_size = Communicator::get_send_buffer_size();
+  const size_t recv_buffer_size = Communicator::get_recv_buffer_size();
 
-    // collocate the entries of spike_registers into local_grid_spikes__
-    std::vector<uint_t>::iterator pos = local_grid_spikes_.begin();
-    if (num_offgrid_spikes == 0)
-      for (i = spike_register_.begin(); i != spike_register_.end(); ++i)
-        for (j = i->begin(); j != i->end(); ++j)
-        {
-          pos = std::copy(j->begin(), j->end(), pos);
-          *pos = comm_marker_;
-          ++pos;
-        }
+  if (!off_grid_spiking_)  //on grid spiking
+  {
+    if (exact_send_buffer)
+      local_grid_spikes_.resize(n_entries);
     else
     {
-      std::vector<OffGridSpike>::iterator n;
-      it = offgrid_spike_register_.begin();
-      for (i = spike_register_.begin(); i != spike_register_.end(); ++i)
-      {
-        jt = it->begin();
-        for (j = i->begin(); j != i->end(); ++j)
-        {
-          pos = std::copy(j->begin(), j->end(), pos);
-          for (n = jt->begin() ; n != jt->end() ; ++n )
-          {
-            *pos = n->get_gid();
-            ++pos;
-          }
-          *pos = comm_marker_;
-          ++pos;
-          ++jt;
-        }
-        ++it;
-      }
-      for (it = offgrid_spike_register_.begin(); it != offgrid_spike_register_.end(); ++it)
-        for (jt = it->begin(); jt != it->end(); ++jt)
-	  jt->clear();
+      // make sure buffers are correctly sized and empty
+      global_grid_spikes_.assign(recv_buffer_size, 0);
+      local_grid_spikes_.assign(std::max(n_entries, send_buffer_size), 0);
     }
-
-    // remove old spikes from the spike_register_
-    for (i = spike_register_.begin(); i != spike_register_.end(); ++i)
-      for (j = i->begin(); j != i->end(); ++j)
-        j->clear();
   }
   else  //off_grid_spiking
   {
-    // make sure buffers are correctly sized and empty
-    std::vector<OffGridSpike> tmp(global_offgrid_spikes_.size(), OffGridSpike(0,0.0));
-    global_offgrid_spikes_.swap(tmp);
+    if (exact_send_buffer)
+      local_offgrid_spikes_.resize(n_entries);
+    else
+    {
+      global_offgrid_spikes_.assign(recv_buffer_size, OffGridSpike(0,0.0));
+      local_offgrid_spikes_.assign(std::max(n_entries, send_buffer_size), OffGridSpike(0,0.0));
+    }
+  }
+}
 
-    if (global_offgrid_spikes_.size() != static_cast<uint_t>(Communicator::get_recv_buffer_size()))
-      global_offgrid_spikes_.resize(Communicator::get_recv_buffer_size(), OffGridSpike(0,0.0));
+void nest::Scheduler::collocate_buffers_(thread t)
+{
+  delay first_lag;
+  delay end_lag;
+  get_collocated_lags_(first_lag, end_lag);
 
-    std::vector<OffGridSpike> tmp2(local_offgrid_spikes_.size(),  OffGridSpike(0,0.0));
-    local_offgrid_spikes_.swap(tmp2);
+  // each thread writes the spikes of its registers to its own part of
+  // the send buffer, lag by lag, and ends each lag with a marker. The
+  // spikes of the other kind follow those of the kind exchanged.
+  if (!off_grid_spiking_)  //on grid spiking
+  {
+    std::vector<uint_t>::iterator pos = local_grid_spikes_.begin() + collocate_offsets_[t];
+    for (delay lag = first_lag; lag < end_lag; ++lag)
+    {
+      std::vector<uint_t>& spikes = spike_register_[t][lag];
+      std::vector<OffGridSpike>& offgrid_spikes = offgrid_spike_register_[t][lag];
 
-    if (num_spikes + (n_threads_ * min_delay_) > static_cast<uint_t>(Communicator::get_send_buffer_size()))
-      local_offgrid_spikes_.resize((num_spikes + (min_delay_ * n_threads_)), OffGridSpike(0,0.0));
-    else if (local_offgrid_spikes_.size() < static_cast<uint_t>(Communicator::get_send_buffer_size()))
-      local_offgrid_spikes_.resize(Communicator::get_send_buffer_size(),  OffGridSpike(0,0.0));
+      pos = std::copy(spikes.begin(), spikes.end(), pos);
+      for (std::vector<OffGridSpike>::const_iterator n = offgrid_spikes.begin(); n != offgrid_spikes.end(); ++n)
+        *pos++ = n->get_gid();
+      *pos++ = comm_marker_;
 
-    // collocate the entries of spike_registers into local_offgrid_spikes__
-    std::vector<OffGridSpike>::iterator pos = local_offgrid_spikes_.begin();
-    if (num_grid_spikes == 0)
-      for (it = offgrid_spike_register_.begin(); it != offgrid_spike_register_.end(); ++it)
-        for (jt = it->begin(); jt != it->end(); ++jt)
-        {
-          pos = std::copy(jt->begin(), jt->end(), pos);
-          pos->set_gid(comm_marker_);
-          ++pos;
-        }
-    else
-    {
-      std::vector<uint_t>::iterator n;
-      i = spike_register_.begin();
-      for (it = offgrid_spike_register_.begin(); it != offgrid_spike_register_.end(); ++it)
-      {
-        j = i->begin();
-        for (jt = it->begin(); jt != it->end(); ++jt)
-        {
-          pos = std::copy(jt->begin(), jt->end(), pos);
-          for (n = j->begin() ; n != j->end() ; ++n )
-          {
-            *pos = OffGridSpike(*n,0);
-            ++pos;
-          }
-          pos->set_gid(comm_marker_);
-          ++pos;
-          ++j;
-        }
-        ++i;
-      }
-      for (i = spike_register_.begin(); i != spike_register_.end(); ++i)
-        for (j = i->begin(); j != i->end(); ++j)
-          j->clear();
+      spikes.clear();
+      offgrid_spikes.clear();
     }
+  }
+  else  //off_grid_spiking
+  {
+    std::vector<OffGridSpike>::iterator pos = local_offgrid_spikes_.begin() + collocate_offsets_[t];
+    for (delay lag = first_lag; lag < end_lag; ++lag)
+    {
+      std::vector<uint_t>& spikes = spike_register_[t][lag];
+      std::vector<OffGridSpike>& offgrid_spikes = offgrid_spike_register_[t][lag];
+
+      pos = std::copy(offgrid_spikes.begin(), offgrid_spikes.end(), pos);
+      for (std::vector<uint_t>::const_iterator n = spikes.begin(); n != spikes.end(); ++n)
+        *pos++ = OffGridSpike(*n, 0);
+      pos->set_gid(comm_marker_);
+      ++pos;
 
-    //empty offgrid_spike_register_
-    for (it = offgrid_spike_register_.begin(); it != offgrid_spike_register_.end(); ++it)
-      for (jt = it->begin(); jt != it->end(); ++jt)
-        jt->clear();
+      spikes.clear();
+      offgrid_spikes.clear();
+    }
   }
 }
 
 void nest::Scheduler::deliver_events_(thread t)
 {
-  // deliver only at beginning of time slice
-  if ( from_step_ > 0 )
+  // deliver only at beginning of time slice, or in its middle with
+  // the pipelined exchange
+  if ( from_step_ > 0 && from_step_ != static_cast<long_t>(pipeline_split_) )
     return;
 
+  delay first_lag;
+  delay end_lag;
+  get_delivered_lags_(first_lag, end_lag);
+
   size_t n_markers = 0;
   SpikeEvent se;
 
@@ -1479,8 +1895,11 @@ void nest::Scheduler::deliver_events_(thread t)
     for (size_t vp = 0; vp < (size_t)Communicator::get_num_virtual_processes(); ++vp)
     {
       size_t pid = get_process_id(vp);
-      int lag = min_delay_ - 1;
-      while(n_markers < min_delay_)
+      // processes without spikes for us sent nothing in the targeted exchange
+      if (spikes_routed_ && recv_counts_[pid] == 0)
+        continue;
+      int lag = min_delay_ - 1 - first_lag;
+      while(n_markers < end_lag - first_lag)
       {
         index nid = global_grid_spikes_[pos[pid]];
         if (nid != comm_marker_)
@@ -1505,8 +1924,10 @@ void nest::Scheduler::deliver_events_(thread t)
     for (size_t vp = 0; vp < (size_t)Communicator::get_num_virtual_processes(); ++vp)
     {
       size_t pid = get_process_id(vp);
-      int lag = min_delay_ - 1;
-      while(n_markers < min_delay_)
+      if (spikes_routed_ && recv_counts_[pid] == 0)
+        continue;
+      int lag = min_delay_ - 1 - first_lag;
+      while(n_markers < end_lag - first_lag)
       {
         index nid = global_offgrid_spikes_[pos[pid]].get_gid();
         if (nid != comm_marker_)
@@ -1529,13 +1950,229 @@ void nest::Scheduler::deliver_events_(thread t)
   }
 }
 
+void nest::Scheduler::get_delivered_lags_(delay& first_lag, delay& end_lag) const
+{
+  // at the beginning of a slice, the pipelined exchange has delivered
+  // the spikes of the first interval of the previous slice, in the
+  // middle of the slice those of the second interval
+  first_lag = from_step_ == 0 ? 0 : pipeline_split_;
+  end_lag = from_step_ == 0 && pipeline_split_ > 0 ? pipeline_split_ : min_delay_;
+}
+
+void nest::Scheduler::build_spike_routes_()
+{
+  // the first time, route all sources, later only those that got
+  // their first connection since the last simulation
+  std::vector<index> new_sources;
+  if (spike_routes_built_)
+    net_.connection_manager_.take_new_sources(new_sources);
+  else
+  {
+    net_.connection_manager_.set_record_new_sources(true);
+    net_.connection_manager_.get_sources(new_sources);
+    spike_routes_built_ = true;
+  }
+
+  std::vector<long_t> local_sources(new_sources.begin(), new_sources.end());
+  std::vector<long_t> sources;
+  std::vector<int> displacements;
+  Communicator::communicate(local_sources, sources, displacements);
+
+  if (spike_routes_.size() < net_.size())
+    spike_routes_.resize(net_.size());
+
+  const int n_procs = Communicator::get_num_processes();
+  for (int pid = 0; pid < n_procs; ++pid)
+  {
+    const size_t end = pid + 1 < n_procs ? displacements[pid + 1] : sources.size();
+    for (size_t k = displacements[pid]; k < end; ++k)
+    {
+      // only nodes with proxies send their spikes through the exchange
+      const index gid = sources[k];
+      if (!net_.is_local_gid(gid) || !net_.get_node(gid)->has_proxies())
+        continue;
+
+      std::vector<int>& route = spike_routes_.mutating_get(gid);
+      if (std::find(route.begin(), route.end(), pid) == route.end())
+        route.push_back(pid);
+    }
+  }
+}
+
+template <typename SpikeT>
+void nest::Scheduler::route_spikes_(const std::vector<SpikeT>& local_spikes,
+                                    std::vector<SpikeT>& routed_spikes)
+{
+  const int n_procs = Communicator::get_num_processes();
+
+  // count the spikes for each process, spikes of sources without
+  // targets are dropped
+  send_counts_.assign(n_procs, 0);
+  int n_markers = 0;
+  for (size_t k = 0; k < local_spikes.size(); ++k)
+  {
+    const index gid = spike_gid_(local_spikes[k]);
+    if (gid == comm_marker_)
+      ++n_markers;
+    else if (gid < spike_routes_.size() && spike_routes_.test(gid))
+    {
+      const std::vector<int>& route = spike_routes_.get(gid);
+      for (size_t r = 0; r < route.size(); ++r)
+        ++send_counts_[route[r]];
+    }
+  }
+
+  std::vector<int> pos(n_procs);
+  int n_entries = 0;
+  for (int pid = 0; pid < n_procs; ++pid)
+  {
+    if (send_counts_[pid] > 0)
+      send_counts_[pid] += n_markers;
+    pos[pid] = n_entries;
+    n_entries += send_counts_[pid];
+  }
+
+  routed_spikes.resize(n_entries);
+  for (size_t k = 0; k < local_spikes.size(); ++k)
+  {
+    const index gid = spike_gid_(local_spikes[k]);
+    if (gid == comm_marker_)
+    {
+      for (int pid = 0; pid < n_procs; ++pid)
+        if (send_counts_[pid] > 0)
+          routed_spikes[pos[pid]++] = local_spikes[k];
+    }
+    else if (gid < spike_routes_.size() && spike_routes_.test(gid))
+    {
+      const std::vector<int>& route = spike_routes_.get(gid);
+      for (size_t r = 0; r < route.size(); ++r)
+        routed_spikes[pos[route[r]]++] = local_spikes[k];
+    }
+  }
+}
+
 void nest::Scheduler::gather_events_()
 {
-  collocate_buffers_();
-  if (off_grid_spiking_)
-    Communicator::communicate(local_offgrid_spikes_, global_offgrid_spikes_, displacements_);
+  begin_exchange_();
+
+  for (index t = 0; t < n_threads_; ++t)
+    count_spikes_(t);
+  size_send_buffer_();
+  for (index t = 0; t < n_threads_; ++t)
+    collocate_buffers_(t);
+
+  exchange_events_();
+}
+
+void nest::Scheduler::begin_exchange_()
+{
+  exchange_begin_ = wall_time_();
+
+  if (pipeline_split_ > 0)
+  {
+    // the spikes of the previous interval are delivered next, while
+    // the spikes of the interval just updated are exchanged
+    finish_exchange_();
+    if (exchange_received_)
+    {
+      global_grid_spikes_.swap(pending_grid_spikes_);
+      global_offgrid_spikes_.swap(pending_offgrid_spikes_);
+      displacements_.swap(pending_displacements_);
+      recv_counts_.swap(pending_recv_counts_);
+      spikes_routed_ = pending_routed_;
+      exchange_received_ = false;
+    }
+  }
+}
+
+void nest::Scheduler::exchange_events_()
+{
+  if (pipeline_split_ > 0)
+    start_exchange_();
   else
-    Communicator::communicate(local_grid_spikes_, global_grid_spikes_, displacements_);
+  {
+    if (targeted_exchange_)
+    {
+      if (off_grid_spiking_)
+      {
+        route_spikes_(local_offgrid_spikes_, routed_offgrid_spikes_);
+        Communicator::communicate(routed_offgrid_spikes_, send_counts_, global_offgrid_spikes_,
+                                  displacements_, recv_counts_);
+      }
+      else
+      {
+        route_spikes_(local_grid_spikes_, routed_grid_spikes_);
+        Communicator::communicate(routed_grid_spikes_, send_counts_, global_grid_spikes_,
+                                  displacements_, recv_counts_);
+      }
+    }
+    else if (off_grid_spiking_)
+      Communicator::communicate(local_offgrid_spikes_, global_offgrid_spikes_, displacements_);
+    else
+      Communicator::communicate(local_grid_spikes_, global_grid_spikes_, displacements_);
+    spikes_routed_ = targeted_exchange_;
+    record_exchange_();
+  }
+
+  last_exchange_time_ = wall_time_() - exchange_begin_;
+  exchange_time_ += last_exchange_time_;
+}
+
+void nest::Scheduler::record_exchange_()
+{
+  last_exchange_bytes_ = Communicator::get_exchange_bytes();
+  ++num_exchanges_;
+  exchange_bytes_ += last_exchange_bytes_;
+}
+
+void nest::Scheduler::start_exchange_()
+{
+  pending_offgrid_ = off_grid_spiking_;
+  pending_routed_ = targeted_exchange_;
+
+  if (targeted_exchange_)
+  {
+    if (off_grid_spiking_)
+    {
+      route_spikes_(local_offgrid_spikes_, routed_offgrid_spikes_);
+      Communicator::start_communicate(routed_offgrid_spikes_, send_counts_, pending_offgrid_spikes_,
+                                      pending_displacements_, pending_recv_counts_);
+    }
+    else
+    {
+      route_spikes_(local_grid_spikes_, routed_grid_spikes_);
+      Communicator::start_communicate(routed_grid_spikes_, send_counts_, pending_grid_spikes_,
+                                      pending_displacements_, pending_recv_counts_);
+    }
+  }
+  else if (off_grid_spiking_)
+    Communicator::start_communicate(local_offgrid_spikes_, pending_offgrid_spikes_, pending_displacements_);
+  else
+    Communicator::start_communicate(local_grid_spikes_, pending_grid_spikes_, pending_displacements_);
+
+  exchange_pending_ = true;
+  exchange_start_time_ = wall_time_();
+}
+
+void nest::Scheduler::finish_exchange_()
+{
+  if (!exchange_pending_)
+    return;
+
+  const double_t wait_begin = wall_time_();
+  exchange_overlap_time_ += wait_begin - exchange_start_time_;
+
+  if (pending_offgrid_)
+    Communicator::finish_communicate(pending_routed_ ? routed_offgrid_spikes_ : local_offgrid_spikes_,
+                                     pending_offgrid_spikes_, pending_displacements_);
+  else
+    Communicator::finish_communicate(pending_routed_ ? routed_grid_spikes_ : local_grid_spikes_,
+                                     pending_grid_spikes_, pending_displacements_);
+
+  exchange_wait_time_ += wall_time_() - wait_begin;
+  exchange_pending_ = false;
+  exchange_received_ = true;
+  record_exchange_();
 }
 
 void nest::Scheduler::advance_time_()
@@ -1565,14 +2202,21 @@ void nest::Scheduler::advance_time_()
   else
     from_step_ = to_step_;
 
-  long_t end_sim = from_step_ + to_do_;
+  set_to_step_();
+
+  assert(to_step_ - from_step_ <= (long_t)min_delay_);
+}
+
+void nest::Scheduler::set_to_step_()
+{
+  // the pipelined exchange ends an update interval in the middle of the slice
+  const long_t end_interval = from_step_ < static_cast<long_t>(pipeline_split_) ? pipeline_split_ : min_delay_;
+  const long_t end_sim = from_step_ + to_do_;
 
-  if ( min_delay_ < (delay)end_sim )
-    to_step_ = min_delay_;    // update to end of time slice
+  if ( end_interval < end_sim )
+    to_step_ = end_interval;  // update to end of interval
   else
     to_step_ = end_sim;       // update to end of simulation time
-
-  assert(to_step_ - from_step_ <= (long_t)min_delay_);
 }
 
 void nest::Scheduler::print_progress_()
@@ -23,6 +23,7 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
 #include <queue>
+#include <set>
 #include <vector>
 #include <iostream>
 #include <iomanip>
@@ -30,6 +31,10 @@
 #include <fstream>
 #include <sys/time.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "nest.h"
 #include "nest_time.h"
 #include "net_thread.h"
@@ -40,6 +45,7 @@
 #include "randomgen.h"
 #include "lockptr.h"
 #include "communicator.h"
+#include "sparsetable.h"
 
 namespace nest
 {
@@ -175,6 +181,29 @@ namespace nest
      */
     thread suggest_vp(index gid) const;
 
+    /**
+     * Return the VP for a new node with the given global id and
+     * update cost, and add the cost to the predicted load of the VP.
+     * With the kernel property /node_placement /cost, this is the VP
+     * with the least load, otherwise the VP given by suggest_vp().
+     * All processes must place all nodes, in the same order, so that
+     * they agree on the placement.
+     */
+    thread place_node(index gid, double_t cost);
+
+    /**
+     * Add the update cost of a node placed on vp by other means than
+     * place_node() to the predicted load of vp.
+     */
+    void add_vp_load(thread vp, double_t cost);
+
+    /**
+     * Return true if no node has been placed by cost, i.e. the VP of
+     * each node follows from suggest_vp(), unless the node is part of
+     * a subnet with /children_on_same_vp.
+     */
+    bool round_robin_placement() const;
+
     thread vp_to_thread(thread vp) const;
     
     thread thread_to_vp(thread t) const;
@@ -226,6 +255,11 @@ namespace nest
      */
     Time const get_time() const;
 
+    /**
+     * Number of steps left to simulate in the current call to Simulate.
+     */
+    long_t get_to_do() const;
+
     bool is_busy() const;
     bool is_updated() const;
     bool update_reference() const;
@@ -362,6 +396,49 @@ namespace nest
 
     vector<Thread>   threads_;
     vector<vector<Node*> > nodes_vec_;   //!< Nodelists for unfrozen nodes
+
+    /**
+     * A run of consecutive nodes in nodes_vec_[t], the unit of work of
+     * the work-stealing update. A thread takes the chunks of its own
+     * nodes from the front, idle threads steal stealable chunks from
+     * the back. Spikes sent by the nodes of a chunk are kept in the
+     * chunk and appended to the spike register of thread t after the
+     * update, so that the register holds them in the same order as
+     * with the static update.
+     */
+    struct UpdateChunk
+    {
+      UpdateChunk(index, index, index, bool);
+
+      index begin;      //!< first node in nodes_vec_[t]
+      index end;        //!< one past the last node in nodes_vec_[t]
+      index first_gid;  //!< GID of the first node
+      bool stealable;   //!< all nodes may be updated by any thread
+      bool taken;       //!< taken by a thread in the current update
+      std::vector<std::vector<uint_t> > spikes;
+      std::vector<std::vector<OffGridSpike> > offgrid_spikes;
+    };
+
+    bool work_stealing_;          //!< Update nodes in chunks idle threads may steal
+    long_t update_chunk_size_;    //!< Maximal number of nodes per chunk in the work-stealing update
+    vector<vector<UpdateChunk> > update_chunks_;  //!< Chunks of nodes_vec_ for each thread
+    vector<index> chunk_front_;   //!< Chunks of each thread before this one have been taken
+    vector<index> chunk_back_;    //!< Stealable chunks of each thread from this one on have been taken
+    vector<double_t> idle_time_;  //!< Wall-clock time (in s) each thread waited for the others to finish updating
+    vector<double_t> update_time_; //!< Wall-clock time (in s) each thread spent updating nodes in the last simulation
+
+    bool cost_placement_;         //!< Place new nodes on the VP with the least predicted load
+    bool cost_placed_;            //!< Some nodes have been placed by cost
+    vector<double_t> vp_load_;    //!< Predicted load of each VP, the sum of the update costs of its nodes
+    std::set<std::pair<double_t, thread> > vp_by_load_; //!< All VPs, ordered by load
+    double_t measured_imbalance_; //!< Maximal over mean update time of the VPs in the last profiled simulation
+
+    bool profile_update_cost_;    //!< Measure the update cost of the models
+    vector<vector<double_t> > model_update_time_;  //!< Wall-clock time (in s) spent per thread and model
+    vector<vector<double_t> > model_update_steps_; //!< Number of node updates by one step per thread and model
+#ifdef _OPENMP
+    vector<omp_lock_t> chunk_locks_; //!< Protect chunk_front_ and chunk_back_ of each thread
+#endif
     
     Network  &net_;         //!< Reference to network object.
     Time     clock_;        //!< Network clock, updated once per slice
@@ -477,6 +554,68 @@ namespace nest
      * each process within the global_(off)grid_spikes_ buffer.
      */
      std::vector<int> displacements_;
+
+    long_t num_exchanges_;        //!< Number of spike exchanges since the last reset
+    double_t exchange_time_;      //!< Wall-clock time (in s) spent collocating and exchanging spikes since the last reset
+    size_t exchange_bytes_;       //!< Bytes gathered by the spike exchanges since the last reset
+    double_t last_exchange_time_; //!< Wall-clock time (in s) of the spike exchange in the last slice
+    size_t last_exchange_bytes_;  //!< Bytes gathered by the spike exchange in the last slice
+
+    bool targeted_exchange_;      //!< Send spikes only to the processes that need them
+    bool spikes_routed_;          //!< Whether the spikes in the global buffers were exchanged targeted
+
+    /**
+     * The processes on which each local source has targets, indexed by
+     * the GID of the source. Filled by build_spike_routes_().
+     */
+    google::sparsetable<std::vector<int> > spike_routes_;
+    bool spike_routes_built_;     //!< Whether spike_routes_ covers all sources up to the last simulation
+
+    /**
+     * Buffers of the targeted exchange, holding the entries of
+     * local_(off)grid_spikes_ grouped by destination process.
+     */
+    std::vector<uint_t> routed_grid_spikes_;
+    std::vector<OffGridSpike> routed_offgrid_spikes_;
+
+    std::vector<int> send_counts_; //!< Number of entries sent to each process by the targeted exchange
+    std::vector<int> recv_counts_; //!< Number of entries received from each process by the targeted exchange
+
+    /**
+     * With the pipelined exchange, each slice is split into two
+     * intervals at step pipeline_split_. The spikes of one interval are
+     * exchanged while the nodes are updated in the next interval and
+     * delivered at its end. Since all delays are at least min_delay_,
+     * the spikes of the first interval of a slice are delivered in time
+     * at the beginning of the next slice, and the spikes of the second
+     * interval in the middle of it. pipeline_split_ is 0 if the exchange
+     * is not pipelined, or if min_delay_ is a single step.
+     */
+    bool pipelined_exchange_;
+    delay pipeline_split_;
+
+    bool exchange_pending_;        //!< Whether an exchange has been started and not finished
+    bool exchange_received_;       //!< Whether the pending buffers hold spikes not yet delivered
+    bool pending_offgrid_;         //!< Whether the pending exchange carries off-grid spikes
+    bool pending_routed_;          //!< Whether the pending exchange is targeted
+    double_t exchange_start_time_; //!< Wall-clock time at which the pending exchange was started
+
+    /**
+     * Receive buffers of the pipelined exchange. They are swapped with
+     * global_(off)grid_spikes_ etc. when the next exchange is due, so
+     * that the spikes of the previous interval can be delivered while
+     * the next exchange is in progress.
+     */
+    std::vector<uint_t> pending_grid_spikes_;
+    std::vector<OffGridSpike> pending_offgrid_spikes_;
+    std::vector<int> pending_displacements_;
+    std::vector<int> pending_recv_counts_;
+
+    std::vector<size_t> collocate_offsets_; //!< Position of the entries of each thread in the send buffer, and their total
+    double_t exchange_begin_;       //!< Wall-clock time at which the current exchange began
+
+    double_t exchange_overlap_time_; //!< Wall-clock time (in s) during which exchanges were in progress while nodes were updated
+    double_t exchange_wait_time_;    //!< Wall-clock time (in s) spent waiting for exchanges to finish
           
 
     /**
@@ -503,17 +642,174 @@ namespace nest
     void clear_nodes_vec_();
 
     /**
-     * Rearrange the spike_register into a 2-dim structure. This is
-     * done by collecting the spikes from all threads in each slice of
-     * the min_delay_ interval.
+     * Split nodes_vec_ into chunks for the work-stealing update.
+     * Only nodes that support stealing may be updated by other
+     * threads; all other nodes, among them devices and local receivers,
+     * are updated by their own thread, so that the random number
+     * streams of the virtual processes and the interaction with
+     * devices do not depend on the schedule.
+     */
+    void configure_update_chunks_();
+
+    /**
+     * Make all chunks available again for the next update.
+     */
+    void reset_update_chunks_();
+
+    /**
+     * Update the chunks of thread t, then help the other threads
+     * by stealing their remaining chunks.
+     */
+    void work_stealing_update_(thread t);
+
+    /**
+     * Take the next chunk of thread t from the front, or, if steal is
+     * true, its last stealable chunk from the back. Returns 0 if no
+     * such chunk is left.
      */
-    void collocate_buffers_();
+    UpdateChunk* take_chunk_(thread t, bool steal);
+
+    /**
+     * Returns true if n may be updated by any thread.
+     */
+    static bool is_stealable_(const Node*);
+
+    /**
+     * Return the chunk of thread t that holds the node with the given
+     * GID, or 0 if there is none. The nodes in nodes_vec_[t] are sorted
+     * by GID, so the chunk is found by its first GID.
+     */
+    UpdateChunk* find_chunk_(thread t, index gid);
+
+    /**
+     * Update nodes[begin] to nodes[end-1] on thread t. With
+     * /profile_update_cost, the time spent on each model is recorded
+     * for thread t.
+     */
+    void update_nodes_(thread t, const std::vector<Node*>& nodes, index begin, index end);
+
+    /**
+     * Set up the update time measurements before a simulation.
+     */
+    void reset_update_times_();
+
+    /**
+     * Combine the update times of all threads and processes after a
+     * simulation with /profile_update_cost into the measured imbalance
+     * and the update costs of the models.
+     */
+    void collect_update_times_();
+
+    /**
+     * Append the spikes kept in the chunks of thread t to its spike
+     * registers.
+     */
+    void collect_chunk_spikes_(thread t);
+
+    /**
+     * The lags of the spikes collocated for the exchange due at
+     * to_step_, from first_lag up to, but excluding, end_lag.
+     */
+    void get_collocated_lags_(delay& first_lag, delay& end_lag) const;
+
+    /**
+     * Count the entries thread t writes to the send buffer, its spikes
+     * and one marker per lag.
+     */
+    void count_spikes_(thread t);
+
+    /**
+     * Compute the position of the entries of each thread in the send
+     * buffer from the counts and size the buffer. Must be called after
+     * count_spikes_() for all threads.
+     */
+    void size_send_buffer_();
+
+    /**
+     * Move the spikes in the spike registers of thread t to its part of
+     * the send buffer, lag by lag, separated by markers. The threads
+     * write to separate parts of the buffer and can collocate in
+     * parallel once size_send_buffer_() has been called.
+     */
+    void collocate_buffers_(thread t);
+
+    /**
+     * Add the processes that have received connections from local
+     * sources since the last call to the routes of these sources.
+     * Must be called on all processes, as it gathers the new sources of
+     * all processes.
+     */
+    void build_spike_routes_();
+
+    /**
+     * Copy the entries of local_spikes, as written by
+     * collocate_buffers_(), to routed_spikes, grouped by the processes
+     * in the routes of their sources, and set send_counts_. A process
+     * that receives spikes also receives all markers, so that the
+     * order of the entries within each lag remains. Processes that
+     * receive no spikes get no entries at all.
+     */
+    template <typename SpikeT>
+    void route_spikes_(const std::vector<SpikeT>& local_spikes, std::vector<SpikeT>& routed_spikes);
+
+    static index spike_gid_(uint_t);
+    static index spike_gid_(const OffGridSpike&);
 
     /**
      * Collocate buffers and exchange events with other MPI processes.
+     * The OpenMP update runs the steps of this function itself, so
+     * that the threads collocate their spikes in parallel.
      */
     void gather_events_();
 
+    /**
+     * Start the timing of the exchange and, with the pipelined
+     * exchange, finish the exchange in progress, so that its send
+     * buffer can be filled again.
+     */
+    void begin_exchange_();
+
+    /**
+     * Exchange the spikes collocated in local_(off)grid_spikes_.
+     */
+    void exchange_events_();
+
+    /**
+     * Start the pipelined exchange of the spikes in local_(off)grid_spikes_.
+     */
+    void start_exchange_();
+
+    /**
+     * Wait for the pipelined exchange to finish, if one is in progress.
+     * The received spikes remain in the pending buffers until the next
+     * exchange is due, since global_(off)grid_spikes_ may still hold
+     * spikes that are to be delivered before.
+     */
+    void finish_exchange_();
+
+    /**
+     * Add the last exchange to the exchange statistics.
+     */
+    void record_exchange_();
+
+    /**
+     * Return true if spikes are exchanged at the end of the current
+     * update, that is at the end of a slice or, with the pipelined
+     * exchange, in the middle of it.
+     */
+    bool exchange_due_() const;
+
+    /**
+     * Set to_step_ to the end of the next update interval.
+     */
+    void set_to_step_();
+
+    /**
+     * The lags of the spikes in global_(off)grid_spikes_ that are
+     * delivered at from_step_.
+     */
+    void get_delivered_lags_(delay& first_lag, delay& end_lag) const;
+
     /**
      * Read all event buffers for thread t and send the corresponding
      * Events to the Nodes that are targeted.
@@ -522,6 +818,14 @@ namespace nest
      * are delivered ordered by non-decreasing time stamps. BUT: this 
      * ordering applies to time stamps only, it does NOT take into 
      * account the offsets of precise spikes.
+     *
+     * Spikes are sent one at a time, in the order received. Collecting
+     * the events of a slice and handing them to the receivers ordered
+     * by receiver address was slower for the Brunel network of order
+     * 2500 (8.6-9.6 s against 5.4-6.4 s for 200 ms), whose targets fit
+     * into the cache. Grouping the spikes by source would also change
+     * the order in which the ring buffers accumulate, so results would
+     * no longer be identical.
      */
     void deliver_events_(thread t);
   };
@@ -567,6 +871,12 @@ namespace nest
     return clock_ + Time::step(from_step_);
   }
 
+  inline
+  long_t Scheduler::get_to_do() const
+  {
+    return to_do_;
+  }
+
   inline 
   thread Scheduler::get_num_threads() const
   {
@@ -603,6 +913,12 @@ namespace nest
     return gid % Communicator::get_num_virtual_processes(); 
   }
 
+  inline
+  bool Scheduler::round_robin_placement() const
+  {
+    return !cost_placed_;
+  }
+
   inline
   thread Scheduler::vp_to_thread(thread vp) const
   {
@@ -680,21 +996,85 @@ namespace nest
     nodes_vec_[n->get_thread()].push_back(n);
   }
 
+  inline
+  bool Scheduler::is_stealable_(const Node* n)
+  {
+    return n->has_proxies() && !n->local_receiver() && n->supports_stealing();
+  }
+
+  inline
+  Scheduler::UpdateChunk* Scheduler::find_chunk_(thread t, index gid)
+  {
+    std::vector<UpdateChunk>& chunks = update_chunks_[t];
+    index lo = 0;
+    index hi = chunks.size();
+    while ( lo < hi )
+    {
+      const index mid = ( lo + hi ) / 2;
+      if ( chunks[mid].first_gid <= gid )
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo > 0 ? &chunks[lo - 1] : 0;
+  }
+
+  inline
+  bool Scheduler::exchange_due_() const
+  {
+    return static_cast<ulong_t>(to_step_) == min_delay_
+      || ( pipeline_split_ > 0 && to_step_ == static_cast<long_t>(pipeline_split_) );
+  }
+
+  inline
+  index Scheduler::spike_gid_(uint_t spike)
+  {
+    return spike;
+  }
+
+  inline
+  index Scheduler::spike_gid_(const OffGridSpike& spike)
+  {
+    return spike.get_gid();
+  }
+
   inline
   void Scheduler::send_remote(thread t, SpikeEvent& e, const long_t lag)
   {
+    std::vector<uint_t>* reg = &spike_register_[t][lag];
+#ifdef _OPENMP
+    // in the work-stealing update, spikes are kept in the chunk of the
+    // sender on its thread t, see UpdateChunk
+    if ( work_stealing_ )
+    {
+      UpdateChunk* c = find_chunk_(t, e.get_sender().get_gid());
+      if ( c != 0 )
+        reg = &c->spikes[lag];
+    }
+#endif
+
     // Put the spike in a buffer for the remote machines
     for (int_t i = 0; i < e.get_multiplicity(); ++i)
-      spike_register_[t][lag].push_back(e.get_sender().get_gid());
+      reg->push_back(e.get_sender().get_gid());
   }
 
   inline
   void Scheduler::send_offgrid_remote(thread t, SpikeEvent& e, const long_t lag)
   {
+    std::vector<OffGridSpike>* reg = &offgrid_spike_register_[t][lag];
+#ifdef _OPENMP
+    if ( work_stealing_ )
+    {
+      UpdateChunk* c = find_chunk_(t, e.get_sender().get_gid());
+      if ( c != 0 )
+        reg = &c->offgrid_spikes[lag];
+    }
+#endif
+
     // Put the spike in a buffer for the remote machines
     OffGridSpike ogs(e.get_sender().get_gid(), e.get_offset());
     for (int_t i = 0; i < e.get_multiplicity(); ++i)
-      offgrid_spike_register_[t][lag].push_back(ogs);
+      reg->push_back(ogs);
   }
 
   inline
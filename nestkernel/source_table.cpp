@@ -0,0 +1,135 @@
+/*
+ *  source_table.cpp
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "source_table.h"
+#include <cassert>
+
+namespace nest
+{
+
+bool SourceTable::insert(index gid, index syn_id, Connector* c)
+{
+  if ( syn_id >= slots_.size() || slots_[syn_id] < 0 )
+    add_slot_(syn_id);
+
+  long_t r = find(gid);
+  const bool is_new = r < 0;
+  if ( is_new )
+  {
+    r = gids_.size();
+    gids_.push_back(gid);
+    connectors_.resize(connectors_.size() + n_slots_, 0);
+
+    // sources that come in ascending order, as during most
+    // constructions, extend the sorted rows directly
+    if ( staged_.empty() && ( n_sorted_ == 0 || gids_[n_sorted_ - 1] < gid ) )
+      ++n_sorted_;
+    else
+      staged_.insert(std::make_pair(gid, r));
+  }
+
+  Connector*& slot = connectors_[r * n_slots_ + slots_[syn_id]];
+  assert(slot == 0);
+  slot = c;
+
+  // merging whenever the staged sources have doubled the table keeps
+  // the cost of all merges proportional to n log n
+  if ( staged_.size() > std::max<size_t>(n_sorted_, 64) )
+    compress();
+
+  return is_new;
+}
+
+void SourceTable::compress()
+{
+  if ( !staged_.empty() )
+  {
+    std::vector<long_t> rows;
+    rows.reserve(gids_.size());
+    get_rows_ordered(rows);
+
+    std::vector<index> gids(rows.size());
+    std::vector<Connector*> connectors(rows.size() * n_slots_);
+    for ( size_t i = 0; i < rows.size(); ++i )
+    {
+      gids[i] = gids_[rows[i]];
+      std::copy(connectors_.begin() + rows[i] * n_slots_,
+                connectors_.begin() + (rows[i] + 1) * n_slots_,
+                connectors.begin() + i * n_slots_);
+    }
+
+    gids_.swap(gids);
+    connectors_.swap(connectors);
+    staged_.clear();
+    n_sorted_ = gids_.size();
+  }
+  else
+  {
+    if ( gids_.capacity() > gids_.size() )
+      std::vector<index>(gids_).swap(gids_);
+    if ( connectors_.capacity() > connectors_.size() )
+      std::vector<Connector*>(connectors_).swap(connectors_);
+  }
+}
+
+void SourceTable::get_rows_ordered(std::vector<long_t>& rows) const
+{
+  size_t r = 0;
+  for ( std::map<index, long_t>::const_iterator s = staged_.begin(); s != staged_.end(); ++s )
+  {
+    for ( ; r < n_sorted_ && gids_[r] < s->first; ++r )
+      rows.push_back(r);
+    rows.push_back(s->second);
+  }
+  for ( ; r < n_sorted_; ++r )
+    rows.push_back(r);
+}
+
+size_t SourceTable::get_memory() const
+{
+  // a node of the map holds its value, three pointers and the colour
+  const size_t staged_node = sizeof(std::map<index, long_t>::value_type) + 4 * sizeof(void*);
+
+  return sizeof(SourceTable)
+    + gids_.capacity() * sizeof(index)
+    + connectors_.capacity() * sizeof(Connector*)
+    + slots_.capacity() * sizeof(long_t)
+    + staged_.size() * staged_node;
+}
+
+void SourceTable::add_slot_(index syn_id)
+{
+  if ( syn_id >= slots_.size() )
+    slots_.resize(syn_id + 1, -1);
+  slots_[syn_id] = n_slots_;
+
+  std::vector<Connector*> connectors(gids_.size() * (n_slots_ + 1), 0);
+  for ( size_t r = 0; r < gids_.size(); ++r )
+    std::copy(connectors_.begin() + r * n_slots_,
+              connectors_.begin() + (r + 1) * n_slots_,
+              connectors.begin() + r * (n_slots_ + 1));
+
+  connectors_.swap(connectors);
+  ++n_slots_;
+}
+
+} // namespace
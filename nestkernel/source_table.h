@@ -0,0 +1,190 @@
+/*
+ *  source_table.h
+ *
+ *  This file is part of NEST.
+ *
+ *  Copyright (C) 2004 The NEST Initiative
+ *
+ *  NEST is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NEST is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NEST.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SOURCE_TABLE_H
+#define SOURCE_TABLE_H
+
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "nest.h"
+
+namespace nest
+{
+
+class Connector;
+
+/**
+ * The Connector objects of one thread, indexed by the GID of their
+ * source and their synapse type.
+ *
+ * The table holds only the sources that have connections on its
+ * thread, so that its size does not depend on the number of nodes in
+ * the network. Each source has a row with one slot for each synapse
+ * type used on the thread. The GIDs of the rows are sorted, and a
+ * lookup is a binary search for the row followed by a direct access
+ * to the slot of the synapse type.
+ *
+ * Sources added after the last call to compress() are kept in a map
+ * until they are merged into the sorted rows. This happens when the
+ * map has grown as large as the sorted part and before each
+ * simulation (see ConnectionManager::compress_sources()). Merging
+ * renumbers the rows, so row numbers are only valid until the next
+ * call to insert() or compress().
+ *
+ * The table does not own the Connector objects.
+ */
+class SourceTable
+{
+public:
+  SourceTable();
+
+  /**
+   * Return the row of source gid or -1 if gid has no connector.
+   */
+  long_t find(index gid) const;
+
+  /**
+   * Return the connector of synapse type syn_id in row r or 0.
+   */
+  Connector* get(long_t r, index syn_id) const;
+
+  /**
+   * Return the connector in slot s of row r or 0.
+   */
+  Connector* get_slot(long_t r, size_t s) const;
+
+  /**
+   * Return the GID of the source of row r.
+   */
+  index get_gid(long_t r) const;
+
+  size_t get_num_rows() const;
+  size_t get_num_slots() const;
+
+  /**
+   * Store connector c for source gid and synapse type syn_id. The
+   * source must not have a connector of this type yet.
+   * @returns true if gid had no connector before.
+   */
+  bool insert(index gid, index syn_id, Connector* c);
+
+  /**
+   * Merge the sources added since the last call into the sorted rows
+   * and release the spare capacity of the table.
+   */
+  void compress();
+
+  /**
+   * Append the rows to rows in the order of the GIDs of their sources.
+   */
+  void get_rows_ordered(std::vector<long_t>& rows) const;
+
+  /**
+   * Return all connectors of the table.
+   */
+  const std::vector<Connector*>& get_connectors() const;
+
+  /**
+   * Return the number of bytes allocated by the table, not counting
+   * the Connector objects.
+   */
+  size_t get_memory() const;
+
+private:
+  void add_slot_(index syn_id);
+
+  std::vector<index> gids_;            //!< Source of each row, the first n_sorted_ are sorted
+  std::vector<Connector*> connectors_; //!< n_slots_ connectors per row, 0 for empty slots
+  std::vector<long_t> slots_;          //!< Slot of each synapse type, -1 if not used
+  size_t n_sorted_;                    //!< Number of rows sorted by GID
+  size_t n_slots_;                     //!< Number of synapse types used on the thread
+  std::map<index, long_t> staged_;     //!< Rows added after the last compress()
+};
+
+inline
+SourceTable::SourceTable()
+  : gids_(),
+    connectors_(),
+    slots_(),
+    n_sorted_(0),
+    n_slots_(0),
+    staged_()
+{}
+
+inline
+long_t SourceTable::find(index gid) const
+{
+  const std::vector<index>::const_iterator end = gids_.begin() + n_sorted_;
+  const std::vector<index>::const_iterator it = std::lower_bound(gids_.begin(), end, gid);
+  if ( it != end && *it == gid )
+    return it - gids_.begin();
+
+  if ( staged_.empty() )
+    return -1;
+
+  const std::map<index, long_t>::const_iterator s = staged_.find(gid);
+  return s == staged_.end() ? -1 : s->second;
+}
+
+inline
+Connector* SourceTable::get(long_t r, index syn_id) const
+{
+  if ( syn_id >= slots_.size() || slots_[syn_id] < 0 )
+    return 0;
+  return connectors_[r * n_slots_ + slots_[syn_id]];
+}
+
+inline
+Connector* SourceTable::get_slot(long_t r, size_t s) const
+{
+  return connectors_[r * n_slots_ + s];
+}
+
+inline
+index SourceTable::get_gid(long_t r) const
+{
+  return gids_[r];
+}
+
+inline
+size_t SourceTable::get_num_rows() const
+{
+  return gids_.size();
+}
+
+inline
+size_t SourceTable::get_num_slots() const
+{
+  return n_slots_;
+}
+
+inline
+const std::vector<Connector*>& SourceTable::get_connectors() const
+{
+  return connectors_;
+}
+
+} // namespace
+
+#endif /* #ifndef SOURCE_TABLE_H */
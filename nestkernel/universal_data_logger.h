@@ -47,6 +47,10 @@ namespace nest {
    * DataLoggingRequests should then be forwarded to the logger using
    * handle().
    *
+   * If the multimeter records to a DataBlock, the logger writes the data
+   * directly into the column of its node in the block and does not
+   * answer requests.
+   *
    * @note A reference to the host node is stored in the logger, for
    *       access to the state and sending events. This requires a constructor
    *       and a copy constructor for the HostNode::Buffers_, creating new
@@ -169,6 +173,14 @@ namespace nest {
        /** Vector of pointers to member functions for data access. */
        std::vector<typename RecordablesMap<HostNode>::DataAccessFct> node_access_;
 
+       /**
+        * Block of the multimeter, if it records to a block. The data are
+        * then written directly to the given column of the block, and
+        * data_ is not used.
+        */
+       DataBlock* block_;
+       size_t     column_;             //!< column of the host node in block_
+
        /**
         * Buffer for data.
         * The first dimension has size two, to provide for alternate
@@ -235,6 +247,8 @@ namespace nest {
       rec_int_steps_(0),
       next_rec_step_(-1),  // flag as uninitialized
       node_access_(),
+      block_(req.get_block()),
+      column_(req.get_block_column()),
       data_(),
       next_rec_(2,0)
    {
@@ -21,6 +21,7 @@
  */
 
 #include "universal_data_logger.h"
+#include "data_block.h"
 #include "nest_time.h"
 #include "network.h"
 #include "node.h"
@@ -95,6 +96,10 @@ void nest::UniversalDataLogger<HostNode>::DataLogger_::init()
   next_rec_step_ = 
     ( Node::network()->get_time().get_steps() / rec_int_steps_ + 1 ) * rec_int_steps_ - 1;
 
+  // data go directly to the block of the multimeter
+  if ( block_ != 0 )
+    return;
+
   // number of data points per slice
   const long_t recs_per_slice = 
     static_cast<long_t>(std::ceil(Node::network()->get_min_delay() 
@@ -116,6 +121,19 @@ void nest::UniversalDataLogger<HostNode>::DataLogger_::record_data(const HostNod
   if ( num_vars_ < 1 || step < next_rec_step_ )  
     return; 
 
+  if ( block_ != 0 )
+  {
+    // the multimeter has added rows for all times it records,
+    // times outside its window are not written
+    double_t* const dest = block_->get_entry(step + 1, column_);
+    if ( dest != 0 )
+      for ( size_t j = 0 ; j < num_vars_ ; ++j )
+        dest[j] = ((host).*(node_access_[j]))();
+
+    next_rec_step_ += rec_int_steps_;
+    return;
+  }
+
   const size_t wt = Node::network()->write_toggle();
 
   assert(wt < next_rec_.size());
@@ -153,7 +171,7 @@ template <typename HostNode>
 void nest::UniversalDataLogger<HostNode>::DataLogger_::handle(HostNode& host,
                                                               const DataLoggingRequest& request)
 {
-  if ( num_vars_ < 1 )
+  if ( num_vars_ < 1 || block_ != 0 )
     return;  // nothing to do
 
   // The following assertions will fire if the user forgot to call init()
@@ -26,6 +26,7 @@
 #include <cmath>
 
 nest::SliceRingBuffer::SliceRingBuffer() :
+  deliver_(0),
   refract_(std::numeric_limits<long_t>::max(), 0, 0)
 {
 //  resize();  // sets up queue_
@@ -152,7 +152,18 @@ namespace nest
     assert(idx < queue_.size());
     assert(ps_offset >= 0);  
     
-    queue_[idx].push_back(SpikeInfo(stamp, ps_offset, weight)); 
+    // With the pipelined spike exchange, spikes may arrive in the
+    // middle of the slice they are due in. The slot has already been
+    // sorted then, and the spike is inserted in order.
+    if ( rel_delivery < Scheduler::get_min_delay() && &queue_[idx] == deliver_ )
+      {
+	const SpikeInfo spike(stamp, ps_offset, weight);
+	queue_[idx].insert(std::lower_bound(queue_[idx].begin(), queue_[idx].end(),
+					    spike, std::greater<SpikeInfo>()),
+			   spike);
+      }
+    else
+      queue_[idx].push_back(SpikeInfo(stamp, ps_offset, weight)); 
   }
 
   inline
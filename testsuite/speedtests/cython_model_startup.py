@@ -0,0 +1,70 @@
+# -*- coding: utf-8 -*-
+#
+# cython_model_startup.py
+#
+# This file is part of cynest.
+#
+# Copyright (C) 2004 The cynest Initiative
+#
+# cynest is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# cynest is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with cynest.  If not, see <http://www.gnu.org/licenses/>.
+
+"""
+Cold versus warm startup of a session that registers a Cython model.
+
+Every run starts a fresh interpreter that imports cynest and registers
+the model. The first run uses an empty model cache and has to compile
+the model; the following runs load it from the cache.
+
+usage: python cython_model_startup.py [model] [runs]
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+model = "cython_iaf_psc_delta_c_members"
+runs = 3
+
+if len(sys.argv) > 1:
+    model = sys.argv[1]
+if len(sys.argv) > 2:
+    runs = int(sys.argv[2])
+
+session = "import cynest; cynest.RegisterNeuron('%s')" % model
+
+cache = tempfile.mkdtemp()
+env = dict(os.environ)
+env["CYNEST_MODEL_CACHE"] = cache
+
+here = os.path.dirname(os.path.abspath(__file__))
+
+def startup():
+    t = time.time()
+    subprocess.check_call([sys.executable, "-c", session], env=env, cwd=here,
+                          stdout=open(os.devnull, "w"))
+    return time.time() - t
+
+try:
+    cold = startup()
+    warm = [startup() for i in range(runs)]
+finally:
+    shutil.rmtree(cache, ignore_errors=True)
+
+print("model:  %s" % model)
+print("cold:   %.2f s" % cold)
+print("warm:   %.2f s (best of %d)" % (min(warm), runs))
+print("speedup %.1fx" % (cold / min(warm)))
@@ -0,0 +1,99 @@
+# -*- coding: utf-8 -*-
+#
+# hl_api_calls.py
+#
+# This file is part of cynest.
+#
+# Copyright (C) 2004 The cynest Initiative
+#
+# cynest is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# cynest is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with cynest.  If not, see <http://www.gnu.org/licenses/>.
+
+"""
+Calls per second of the hot functions of the high-level API.
+
+Each function is called in a tight loop on a small network, once
+through the high-level API, which calls the network directly, and
+once through the equivalent SLI code, as the high-level API did
+before.
+
+usage: python hl_api_calls.py [seconds per measurement]
+"""
+
+import sys
+import time
+
+import cynest as nest
+
+duration = 1.0
+if len(sys.argv) > 1:
+    duration = float(sys.argv[1])
+
+
+def rate(f):
+    """
+    Return the number of calls of f per second.
+    """
+
+    n = 0
+    t0 = time.time()
+    t = t0
+    while t - t0 < duration:
+        for i in range(100):
+            f()
+        n += 100
+        t = time.time()
+    return n / (t - t0)
+
+
+def setup():
+    """
+    Start every measurement from a fresh kernel with two neurons.
+    """
+
+    nest.ResetKernel()
+    nest.SetKernelStatus({"print_time" : False})
+    return nest.Create("iaf_neuron", 2)
+
+
+nest.set_verbosity("M_WARNING")
+
+n = setup()
+p = {"I_e" : 100.0}
+
+benchmarks = [
+    ("Simulate(0.1)",
+     lambda: nest.Simulate(0.1),
+     lambda: (nest.sps(0.1), nest.sr("ms Simulate"))),
+    ("SetStatus",
+     lambda: nest.SetStatus(n[:1], p),
+     lambda: (nest.sps(n[:1]), nest.sps([p]), nest.sr("2 arraystore"),
+              nest.sr("Transpose { arrayload ; SetStatus } forall"))),
+    ("GetStatus",
+     lambda: nest.GetStatus(n[:1], "V_m"),
+     lambda: (nest.sps(n[:1]), nest.sr("{ GetStatus /V_m get} Map"), nest.spp())),
+    ("Connect",
+     lambda: nest.Connect(n[:1], n[1:]),
+     lambda: (nest.sps(n[0]), nest.sps(n[1]), nest.sr("/static_synapse Connect"))),
+    ("Create",
+     lambda: nest.Create("iaf_neuron"),
+     lambda: (nest.sps(1), nest.sr("/iaf_neuron exch Create"), nest.spp())),
+]
+
+print("%-15s %12s %12s %8s" % ("function", "direct/s", "SLI/s", "speedup"))
+for name, direct, sli in benchmarks:
+    setup()
+    d = rate(direct)
+    setup()
+    s = rate(sli)
+    print("%-15s %12.0f %12.0f %7.1fx" % (name, d, s, d / s))
@@ -26,6 +26,12 @@
 #include <vector>
 #include "connection_creator.h"
 #include "binomial_randomdev.h"
+#include "exceptions.h"
+#include "doubledatum.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace nest
 {
@@ -63,7 +69,13 @@ namespace nest
   void ConnectionCreator::get_parameters_(const Position<D> & pos, librandom::RngPtr rng, DictionaryDatum d)
   {
     for(ParameterMap::iterator iter=parameters_.begin(); iter != parameters_.end(); ++iter) {
-      def<double_t>(d, iter->first, iter->second->value(pos, rng));
+      // Overwrite existing entries in place. Allocating new datums is not
+      // thread-safe, see target_driven_connect_().
+      DoubleDatum* value = dynamic_cast<DoubleDatum*>((*d)[iter->first].datum());
+      if (value)
+        value->get() = iter->second->value(pos, rng);
+      else
+        def<double_t>(d, iter->first, iter->second->value(pos, rng));
     }
   }
 
@@ -76,8 +88,6 @@ namespace nest
     //  2. For each source node: Compute probability, draw random number, make
     //     connection conditionally
 
-    DictionaryDatum d = new Dictionary();
-
     // Nodes in the subnet are grouped by depth, so to select by depth, we
     // just adjust the begin and end pointers:
     std::vector<Node*>::const_iterator target_begin;
@@ -90,97 +100,132 @@ namespace nest
       target_end = target.local_end();
     }
 
-    if (mask_.valid()) {
+    // Every thread connects the targets it owns, drawing from the random
+    // number generator of its virtual process, which is the generator the
+    // serial loop uses for these targets. The connections are thus the
+    // same whether they are created in parallel or not.
+    const std::vector<Node*> targets(target_begin, target_end);
+    const bool parallel = net_.parallel_construction_possible(targets);
+    const thread n_threads = parallel ? net_.get_num_threads() : 1;
+    std::vector< lockPTR<WrappedThreadException> > exceptions_raised(n_threads);
+
+    // The datums of the parameter dictionaries come from a memory pool
+    // that is not thread-safe, so we create all entries here and only
+    // overwrite them in get_parameters_().
+    std::vector<DictionaryDatum> dicts;
+    for (thread tid = 0; tid < n_threads; ++tid) {
+      dicts.push_back(DictionaryDatum(new Dictionary()));
+      for(ParameterMap::iterator iter=parameters_.begin(); iter != parameters_.end(); ++iter)
+        def<double_t>(dicts[tid], iter->first, 0.0);
+    }
 
-      // Retrieve global positions:
-      MaskedLayer<D> masked_layer(source,source_filter_,mask_,true,allow_oversized_);
+    // Retrieve global positions:
+    lockPTR<MaskedLayer<D> > masked_layer;
+    std::vector<std::pair<Position<D>,index> >* positions = 0;
+    if (mask_.valid())
+      masked_layer = lockPTR<MaskedLayer<D> >(new MaskedLayer<D>(source,source_filter_,mask_,true,allow_oversized_));
+    else
+      positions = source.get_global_positions_vector(source_filter_);
+
+#pragma omp parallel if (parallel)
+    {
+      thread first = 0;
+      thread stride = 1;
+#ifdef _OPENMP
+      first = omp_get_thread_num();
+      stride = omp_get_num_threads();
+#endif
 
-      for (std::vector<Node*>::const_iterator tgt_it = target_begin;tgt_it != target_end;++tgt_it) {
+      for (thread tid = first; tid < n_threads; tid += stride) {
+        DictionaryDatum& d = dicts[tid];
+        try {
 
-        if (target_filter_.select_model() && ((*tgt_it)->get_model_id() != target_filter_.model))
-          continue;
+          for (std::vector<Node*>::const_iterator tgt_it = targets.begin();tgt_it != targets.end();++tgt_it) {
 
-        index target_id = (*tgt_it)->get_gid();
-        librandom::RngPtr rng = net_.get_rng((*tgt_it)->get_thread());
-        Position<D> target_pos = target.get_position((*tgt_it)->get_subnet_index());
+            if (parallel && ((*tgt_it)->get_thread() != tid))
+              continue;
 
-        // If there is a kernel, we create connections conditionally,
-        // otherwise all sources within the mask are created. Test moved
-        // outside the loop for efficiency.
-        if (kernel_.valid()) {
+            if (target_filter_.select_model() && ((*tgt_it)->get_model_id() != target_filter_.model))
+              continue;
 
-          for(typename Ntree<D,index>::masked_iterator iter=masked_layer.begin(target_pos); iter!=masked_layer.end(); ++iter) {
+            index target_id = (*tgt_it)->get_gid();
+            librandom::RngPtr rng = net_.get_rng((*tgt_it)->get_thread());
+            Position<D> target_pos = target.get_position((*tgt_it)->get_subnet_index());
 
-            if ((not allow_autapses_) and (iter->second == target_id))
-              continue;
+            if (mask_.valid()) {
 
-            if (rng->drand() < kernel_->value(source.compute_displacement(target_pos,iter->first), rng)) {
-              get_parameters_(source.compute_displacement(target_pos,iter->first), rng, d);
-              net_.connect(iter->second,target_id,d,synapse_model_);
-            }
+              // If there is a kernel, we create connections conditionally,
+              // otherwise all sources within the mask are created. Test moved
+              // outside the loop for efficiency.
+              if (kernel_.valid()) {
 
-          }
+                for(typename Ntree<D,index>::masked_iterator iter=masked_layer->begin(target_pos); iter!=masked_layer->end(); ++iter) {
 
-        } else {
+                  if ((not allow_autapses_) and (iter->second == target_id))
+                    continue;
 
-          // no kernel
+                  if (rng->drand() < kernel_->value(source.compute_displacement(target_pos,iter->first), rng)) {
+                    get_parameters_(source.compute_displacement(target_pos,iter->first), rng, d);
+                    net_.connect(iter->second,target_id,d,synapse_model_);
+                  }
 
-          for(typename Ntree<D,index>::masked_iterator iter=masked_layer.begin(target_pos); iter!=masked_layer.end(); ++iter) {
+                }
 
-            if ((not allow_autapses_) and (iter->second == target_id))
-              continue;
+              } else {
 
-            get_parameters_(source.compute_displacement(target_pos,iter->first), rng, d);
-            net_.connect(iter->second,target_id,d,synapse_model_);
-          }
+                // no kernel
 
-        }
+                for(typename Ntree<D,index>::masked_iterator iter=masked_layer->begin(target_pos); iter!=masked_layer->end(); ++iter) {
 
-      }
+                  if ((not allow_autapses_) and (iter->second == target_id))
+                    continue;
 
-    } else {
-      // no mask
+                  get_parameters_(source.compute_displacement(target_pos,iter->first), rng, d);
+                  net_.connect(iter->second,target_id,d,synapse_model_);
+                }
 
-      std::vector<std::pair<Position<D>,index> >* positions = source.get_global_positions_vector(source_filter_);
-      for (std::vector<Node*>::const_iterator tgt_it = target_begin;tgt_it != target_end;++tgt_it) {
+              }
 
-        if (target_filter_.select_model() && ((*tgt_it)->get_model_id() != target_filter_.model))
-          continue;
+            } else {
+              // no mask
 
-        index target_id = (*tgt_it)->get_gid();
-        librandom::RngPtr rng = net_.get_rng((*tgt_it)->get_thread());
-        Position<D> target_pos = target.get_position((*tgt_it)->get_subnet_index());
+              if (kernel_.valid()) {
 
-        // If there is a kernel, we create connections conditionally,
-        // otherwise all sources within the mask are created. Test moved
-        // outside the loop for efficiency.
-        if (kernel_.valid()) {
+                for(typename std::vector<std::pair<Position<D>,index> >::iterator iter=positions->begin();iter!=positions->end();++iter) {
 
-          for(typename std::vector<std::pair<Position<D>,index> >::iterator iter=positions->begin();iter!=positions->end();++iter) {
+                  if ((not allow_autapses_) and (iter->second == target_id))
+                    continue;
 
-            if ((not allow_autapses_) and (iter->second == target_id))
-              continue;
+                  if (rng->drand() < kernel_->value(source.compute_displacement(target_pos,iter->first), rng)) {
+                    get_parameters_(source.compute_displacement(target_pos,iter->first), rng, d);
+                    net_.connect(iter->second,target_id,d,synapse_model_);
+                  }
+                }
 
-            if (rng->drand() < kernel_->value(source.compute_displacement(target_pos,iter->first), rng)) {
-              get_parameters_(source.compute_displacement(target_pos,iter->first), rng, d);
-              net_.connect(iter->second,target_id,d,synapse_model_);
-            }
-          }
+              } else {
 
-        } else {
+                for(typename std::vector<std::pair<Position<D>,index> >::iterator iter=positions->begin();iter!=positions->end();++iter) {
 
-          for(typename std::vector<std::pair<Position<D>,index> >::iterator iter=positions->begin();iter!=positions->end();++iter) {
+                  if ((not allow_autapses_) and (iter->second == target_id))
+                    continue;
 
-            if ((not allow_autapses_) and (iter->second == target_id))
-              continue;
+                  get_parameters_(source.compute_displacement(target_pos,iter->first), rng, d);
+                  net_.connect(iter->second,target_id,d,synapse_model_);
+                }
 
-            get_parameters_(source.compute_displacement(target_pos,iter->first), rng, d);
-            net_.connect(iter->second,target_id,d,synapse_model_);
+              }
+            }
           }
 
+        } catch (std::exception& e) {
+          exceptions_raised[tid] = lockPTR<WrappedThreadException>(new WrappedThreadException(e));
         }
       }
-    }
+    } // of omp parallel
+
+    for (thread tid = 0; tid < n_threads; ++tid)
+      if (exceptions_raised[tid].valid())
+        throw WrappedThreadException(*(exceptions_raised[tid]));
 
   }
 